@@ -0,0 +1,105 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file 	AnswerCache.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Memory-bounded cache of the answers of DL-atoms.
+ */
+
+#ifndef ANSWERCACHE__HPP_INCLUDED_
+#define ANSWERCACHE__HPP_INCLUDED_
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/PluginInterface.h"
+
+#include <list>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// stores the answers of a DL-atom by its input tuple (ontology, input predicates and query) and the projected input atoms;
+// least recently used answers are evicted if the estimated memory consumption exceeds the bound
+class AnswerCache{
+public:
+	struct Key{
+		Tuple input;
+		std::vector<IDAddress> inputAtoms;	// sorted
+		std::vector<IDAddress> assignedAtoms;	// sorted, only for DL-atoms with partial answers (empty otherwise)
+		Tuple boundOutput;	// the output pattern if it consists of constants only (empty otherwise)
+		std::size_t hash;
+
+		// computes the key of a query (assigned atoms are only considered if partial is true)
+		Key(const PluginAtom::Query& query, bool partial);
+		bool operator==(const Key& other) const;
+	};
+
+private:
+	struct KeyHash{
+		inline std::size_t operator()(const Key& key) const { return key.hash; }
+	};
+	struct Entry{
+		Key key;
+		std::vector<Tuple> tuples, unknown;
+		std::size_t size;	// estimated memory consumption in bytes
+		Entry(const Key& key) : key(key), size(0) {}
+	};
+	typedef std::list<Entry> Entries;	// most recently used first
+
+	Entries entries;
+	boost::unordered_map<Key, Entries::iterator, KeyHash> index;
+	std::size_t capacity, size;
+	unsigned long hits, misses, evictions;
+
+	static std::size_t estimateSize(const std::vector<Tuple>& tuples);
+	void evict();
+
+public:
+	// creates a cache which uses at most capacity bytes (estimated)
+	AnswerCache(std::size_t capacity);
+
+	// adds the cached answer of the query to answer and returns true, or returns false if there is no entry
+	bool lookup(const Key& key, PluginAtom::Answer& answer);
+
+	void store(const Key& key, const PluginAtom::Answer& answer);
+
+	inline unsigned long getHits() const { return hits; }
+	inline unsigned long getMisses() const { return misses; }
+	inline unsigned long getEvictions() const { return evictions; }
+};
+typedef boost::shared_ptr<AnswerCache> AnswerCachePtr;
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
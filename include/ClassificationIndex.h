@@ -0,0 +1,120 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file 	ClassificationIndex.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Native computation and indexed storage of the classification of an ontology.
+ */
+
+#ifndef CLASSIFICATIONINDEX__HPP_INCLUDED_
+#define CLASSIFICATIONINDEX__HPP_INCLUDED_
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Interpretation.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// stores the relations sub, op, conf, confref, inv and funct of the classification
+// as bit rows over dense indices of the concept and role terms
+class ClassificationIndex{
+public:
+	typedef bm::bvector<> Row;
+
+private:
+	RegistryPtr reg;
+
+	// dense indices of the terms which occur in the classification
+	std::vector<ID> terms;
+	boost::unordered_map<IDAddress, unsigned> indices;
+
+	// sub[i] contains j iff sub(i,j) holds (same for op, inv and conf)
+	std::vector<Row> sub, op, inv, conf;
+	Row confref, funct;
+
+	// subsumees[i] contains j iff sub(j,i) holds
+	std::vector<Row> subsumees;
+
+	unsigned getOrCreateIndex(ID term);
+
+	// computes the transitive closure of sub (strongly connected components are processed in reverse topological order)
+	void closeSub();
+
+	// adds the consequences of the contraposition rule to sub, returns true if something changed
+	bool contrapose();
+
+	// computes the subsumees from the subsumers
+	void computeSubsumees();
+
+	void addFact(InterpretationPtr intr, ID pred, unsigned x, unsigned y) const;
+
+public:
+	static const unsigned npos = (unsigned)-1;
+
+	ClassificationIndex(RegistryPtr reg);
+
+	// computes the unique model of the classification program for the given facts over sub, op, inv and funct
+	void saturate(InterpretationConstPtr edb);
+
+	// reads an already computed classification (e.g. the answer set of the classification program)
+	void load(InterpretationConstPtr classification);
+
+	// returns the classification as interpretation (equal to the answer set of the classification program)
+	InterpretationPtr getInterpretation() const;
+
+	// dense indices
+	inline unsigned size() const { return terms.size(); }
+	inline ID getTerm(unsigned index) const { return terms[index]; }
+	unsigned getIndex(ID term) const;	// returns npos if the term does not occur in the classification
+
+	// lookups
+	bool isSub(ID x, ID y) const;
+	bool isConf(ID x, ID y) const;
+	bool isInv(ID x, ID y) const;
+	bool isConfref(ID x) const;
+	bool isFunct(ID x) const;
+
+	// rows of the relations by dense index
+	inline const Row& getSubsumers(unsigned index) const { return sub[index]; }	// all y with sub(x,y)
+	inline const Row& getSubsumees(unsigned index) const { return subsumees[index]; }	// all y with sub(y,x)
+	inline const Row& getConflicts(unsigned index) const { return conf[index]; }	// all y with conf(x,y)
+	inline const Row& getInverses(unsigned index) const { return inv[index]; }	// all y with inv(x,y)
+};
+typedef boost::shared_ptr<ClassificationIndex> ClassificationIndexPtr;
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
@@ -41,6 +41,13 @@
 #include "dlvhex2/HexParserModule.h"
 #include "dlvhex2/Printer.h"
 #include <set>
+#include <map>
+#include <list>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#include <cstring>
 
 #include "owlcpp/rdf/triple_store.hpp"
 #include "owlcpp/io/input.hpp"
@@ -48,11 +55,23 @@
 #include "owlcpp/terms/node_tags_owl.hpp"
 #include "factpp/Kernel.hpp"
 
+#include "ClassificationIndex.h"
+#include "RoleAssertionIndex.h"
+#include "RequiemWorker.h"
+
 DLVHEX_NAMESPACE_BEGIN
 
 namespace dllite{
 
 class DLPluginAtom;
+class ELRewriter;
+typedef boost::shared_ptr<ELRewriter> ELRewriterPtr;
+class SupportSetCache;
+typedef boost::shared_ptr<SupportSetCache> SupportSetCachePtr;
+class NativeReasoner;
+typedef boost::shared_ptr<NativeReasoner> NativeReasonerPtr;
+struct UpdateBatch;
+typedef boost::shared_ptr<UpdateBatch> UpdateBatchPtr;
 class CDLAtom;
 class RDLAtom;
 class ConsDLAtom;
@@ -68,6 +87,8 @@ friend class RDLAtom;
 friend class ConsDLAtom;
 friend class InconsDLAtom;
 friend class RepairModelGenerator;
+friend class ClassificationIndex;
+friend class NativeReasoner;
 
 // this class caches an ontology
 // add member variables here if additional information about the ontology must be stored
@@ -82,18 +103,88 @@ std::string ontologyPath, ontologyNamespace, ontologyVersion;
 ID ontologyName;	// ID of constant with filename (as given in the program or on command-line)
 bool includeAbox;	// true if the ontology was loaded including the Abox, false if it was loaded with empty Abox
 bool loaded;	// true if the ontology is ready to use
+bool reasonerLoaded;	// true if the triple store and the reasoning kernel are filled (delayed if the ontology was restored from a snapshot)
+bool functionalRoles;	// true if some role is functional (then the kernels are told that all individuals are different)
+bool triplesRead;	// true if the owl-file was read into the triple store (not on a warm start from a snapshot)
+
+// persistent snapshots of the derived information (see OntologySnapshot.cpp)
+std::string snapshotDir;	// directory for snapshots (empty if snapshots are disabled)
+std::string fileHash;	// hash of the content of the owl-file, used as key of the snapshot
 
 // interface to internal reasoner
 owlcpp::Triple_store store;
 ReasoningKernelPtr kernel;
 
+// answers of the kernel over the unmodified Abox; for DL-Lite ontologies the input of a DL-atom is handled as overlay
+// by the native reasoner, otherwise it is added to a leased kernel only for the query (see DLPluginAtom::getInstances)
+int kernelConsistent;	// -1 if not yet checked
+boost::unordered_map<IDAddress, bm::bvector<> > kernelInstances;	// by (possibly negated) query concept
+
+// overlays of recently evaluated DL-atom inputs (most recently used first), shared by all DL-atoms with the same input
+std::list<UpdateBatchPtr> updateBatches;
+
+// pool of kernels over the same ontology, such that DL-atoms can query FaCT++ concurrently;
+// it starts with kernel and further kernels are filled on demand (at most maxKernels)
+unsigned maxKernels;
+unsigned kernelCount;
+
+// a kernel of the pool together with the FaCT++ expressions of the terms which were queried so far
+// (expressions belong to the expression manager of a kernel, thus they are stored per kernel)
+struct PooledKernel{
+	ReasoningKernelPtr kernel;
+	boost::unordered_map<IDAddress, TDLConceptExpression*> concepts;	// by (possibly negated) concept term
+	boost::unordered_map<IDAddress, TDLIndividualExpression*> individuals;	// by individual term
+	boost::unordered_map<IDAddress, TDLObjectRoleExpression*> roles;	// by role term
+	PooledKernel(ReasoningKernelPtr kernel) : kernel(kernel) {}
+};
+typedef boost::shared_ptr<PooledKernel> PooledKernelPtr;
+std::vector<PooledKernelPtr> idleKernels;
+boost::mutex kernelPoolMutex;
+boost::condition_variable kernelReleased;
+
+// guards the members which are computed on demand while DL-atoms are evaluated
+// (classification, native reasoner and answers of the kernel)
+boost::mutex mutex;
+
+// takes an idle kernel from the pool (waits if all kernels are in use) and returns it on destruction;
+// kernels must only be leased after loadReasoner was called
+class KernelLease{
+private:
+	CachedOntology& ontology;
+	PooledKernelPtr kernel;
+	std::vector<TDLAxiom*> addedAxioms;	// retracted before the kernel is returned to the pool
+public:
+	KernelLease(CachedOntology& ontology);
+	~KernelLease();
+	inline ReasoningKernel* operator->() const { return kernel->kernel.get(); }
+
+	// expression of a (possibly negated) concept, of an individual resp. of a role (constructed only on the first lookup;
+	// the terms must occur in the ontology, otherwise the signature of the kernel would be extended)
+	TDLConceptExpression* getConcept(ID concept);
+	TDLIndividualExpression* getIndividual(ID individual);
+	TDLObjectRoleExpression* getRole(ID role);
+
+	// adds an assertion to the kernel while it is leased
+	void addAxiom(TDLAxiom* axiom);
+
+	// asserts (while the kernel is leased) that the individuals of the ontology and the given ones are different
+	void addUniqueNames(const bm::bvector<>& further);
+};
+
 InterpretationPtr classification;	// unique model of the classification program
+ClassificationIndexPtr classificationIndex;	// indexed version of the classification
+InterpretationPtr tboxFacts;	// input of the classification program (collected while scanning the triples, released after classification)
+InterpretationPtr tboxAxioms;	// the same input if it captures every Tbox triple (then kernels are filled from it on a warm start)
+ELRewriterPtr elRewriter;	// normalized Tbox for query rewriting in EL mode (created on first use)
+SupportSetCachePtr supportSetCache;	// persistent support families of DL-atoms over this ontology (only if snapshots are enabled)
+NativeReasonerPtr nativeReasoner;	// posting lists of the Abox for native query answering (created on first use)
 
 // vocabulary of Tbox and Abox
 InterpretationPtr concepts, roles, individuals;
 
 typedef std::pair<ID, std::pair<ID, ID> > RoleAssertion;	// stores a role assertion (i1,i2) in R as <R, <i1, i2> >
-std::vector<RoleAssertion> roleAssertions;
+std::vector<RoleAssertion> roleAssertions;	// in the order of the owl-file
+RoleAssertionIndex roleAssertionIndex;	// the same assertions by role and subject
 InterpretationPtr conceptAssertions;	// stores addresses of all true concept guard atoms
 //InterpretationPtr AboxPredicates;
 std::vector<ID> AboxPredicates;
@@ -104,11 +195,30 @@ bool checkConceptAssertion(RegistryPtr reg, ID guardAtomID) const;
 // checks if a role guard atom of form GuardPredID(R, I1, I2) holds
 bool checkRoleAssertion(RegistryPtr reg, ID guardAtomID) const;
 
+// checks a batch of ground (concept or role) guard atoms at once and adds those which hold to holding
+void checkGuardAtoms(RegistryPtr reg, InterpretationConstPtr guardAtoms, InterpretationPtr holding) const;
+
 // returns the set of all individuals which which occur either in the Abox or in the query (including the DL-namespace)
 InterpretationPtr getAllIndividuals(const PluginAtom::Query& query, bool addPotentialIndividuals);
 
 bool isOwlConstant(std::string str) const;
 
+// interned names of the kernel (with namespace) and their terms (quoted and without namespace, ID_FAIL for names
+// outside of the namespace), such that answers of the kernel are mapped to terms without building strings
+struct IriHash{
+	inline std::size_t operator()(const std::string& iri) const { return boost::hash_range(iri.begin(), iri.end()); }
+	inline std::size_t operator()(const char* iri) const { return boost::hash_range(iri, iri + std::strlen(iri)); }
+};
+struct IriEqual{
+	inline bool operator()(const char* iri1, const std::string& iri2) const { return iri2 == iri1; }
+	inline bool operator()(const std::string& iri1, const char* iri2) const { return iri1 == iri2; }
+};
+boost::unordered_map<std::string, ID, IriHash> termsByIri;	// filled on demand
+boost::mutex iriMutex;
+
+// returns the term of a name of the kernel (ID_FAIL if it is not in the namespace of the ontology)
+ID getTermByIri(const char* iri);
+
 inline bool containsNamespace(std::string str) const{
 return (str.substr(0, ontologyNamespace.length()) == ontologyNamespace || str[0] == '-' && str.substr(1, ontologyNamespace.length()) == ontologyNamespace);
 }
@@ -127,19 +237,58 @@ if (str[0] == '-') return '-' + str.substr(ontologyNamespace.length() + 1 + 1);
 return str.substr(ontologyNamespace.length() + 1); // +1 because of '#'
 }
 
+// stores a name of the ontology (without namespace) as quoted constant, same as DLLitePlugin::storeQuotedConstantTerm
+// (which is accessible for members of the plugin, but not for helpers of the ontology)
+ID storeQuotedConstantTerm(const std::string& str) const;
+
 
 CachedOntology(RegistryPtr reg);
 virtual ~CachedOntology();
 
-// loads the ontology
+// loads the ontology (from a snapshot if possible)
 void load(ID ontologyName, bool includeAbox);
 
+// reads the owl-file into the triple store and submits it to the reasoning kernel (does nothing if this was already done);
+// after a snapshot was restored, the kernel is filled from tboxAxioms without reading the file if they are available
+void loadReasoner();
+
 // computes the classification for a given ontology
 void computeClassification(ProgramCtx& ctx);
 
+// returns the native reasoner (computes the classification and creates the reasoner on the first call)
+NativeReasonerPtr getNativeReasoner(ProgramCtx& ctx);
+
 private:
-// reads the set of concepts, roles and individuals, adds concept and role assertions
-void analyzeTboxAndAbox();
+// reads the owl-file into the triple store and extracts the namespace
+void readOntologyFile();
+
+// submits the triples to the reasoning kernel and collects the input of the classification program in a single pass;
+// if analyze is true, it also reads the set of concepts, roles and individuals and adds concept and role assertions
+void scanTriples(bool analyze);
+
+// submits the triples to a further kernel of the pool
+void submitTriples(ReasoningKernel& k);
+
+// fills a kernel from tboxAxioms and the Abox without the owl-file (used on a warm start from a snapshot)
+void fillKernel(ReasoningKernel& k);
+TDLConceptExpression* getAxiomConcept(ReasoningKernel& k, ID concept) const;
+TDLObjectRoleExpression* getAxiomRole(ReasoningKernel& k, ID role) const;
+
+// asserts that the given individuals are pairwise different; DL-Lite (and thus the native reasoner and the support sets)
+// adopts the unique name assumption, whereas FaCT++ would merge two fillers of a functional role instead
+TDLAxiom* assertUniqueNames(ReasoningKernel& k, const bm::bvector<>& names) const;
+
+// computes a hash of the content of a file (empty string if the file cannot be read)
+static std::string computeFileHash(const std::string& filename);
+
+// returns the path of the snapshot file for this ontology
+std::string getSnapshotFile() const;
+
+// restores vocabulary, assertions and (if available) the classification from a snapshot; returns false if there is no valid snapshot
+bool restoreSnapshot();
+
+// writes vocabulary, assertions and (if already computed) the classification to the snapshot file
+void saveSnapshot() const;
 };
 typedef boost::shared_ptr<CachedOntology> CachedOntologyPtr;
 
@@ -154,6 +303,8 @@ ID pred;
 class CtxData : public PluginData
 {
 public:
+enum ClassificationMode{ native, asp, check };	// how the classification is computed (check computes both and compares them)
+enum QueryEngine{ factppEngine, nativeEngine };	// how DL-atoms are evaluated
 
 std::vector<DLLitePlugin::CachedOntologyPtr> ontologies;
 bool repair;	// enable RepairModelGenerator?
@@ -178,20 +329,37 @@ bool optimize;	// automatically optimize rules with DL-atoms?
 std::string repairOntology;	// name of the ontology to repair (if repair=true)
 std::string ontology;	// name of the ontology for rewriting
 std::vector<DLExpression> dlexpressions;	// cache for DL-expressions
-CtxData() : repair(false), el(false), incomplete(false), supsize(-1), supnumber(-1), replimfact(-1), replimpred(-1), replimconst(-1), rewrite(false),repdelpredflag(false), repleavepredflag(false), repdelconstflag(false), repleaveconstflag(false), optimize(false) {};
+std::string cachedir;	// directory for persistent caches (empty if disabled)
+ClassificationMode classificationMode;
+unsigned requiemworkers;	// maximal number of Requiem processes per ontology
+std::map<std::string, RequiemWorkerPoolPtr> requiemWorkerPools;	// Requiem processes by ontology path
+bool requiem;	// use Requiem instead of the native rewriter in EL mode?
+unsigned supthreads;	// number of threads for learning the support families of the DL-atoms in repair mode
+boost::mutex learningMutex;	// serializes the parts of support set learning which access the registry or this object
+boost::mutex ontologyMutex;	// serializes the access to the ontology cache
+unsigned kernels;	// maximal number of FaCT++ kernels per ontology for evaluating DL-atoms concurrently
+QueryEngine queryEngine;
+unsigned answercache;	// memory bound of the answer cache of each DL-atom in megabytes (0 disables the cache)
+unsigned updatebatches;	// number of recent DL-atom inputs per ontology whose overlays are shared
+unsigned checkthreads;	// number of threads for post checking repair candidates (pipelined if greater than 1)
+bool checkunordered;	// return repair answer sets of pipelined post checks in any order?
+bool aboxconflicts;	// propagate conflicts between Abox assertions during the search for repairs?
+CtxData() : repair(false), el(false), incomplete(false), supsize(-1), supnumber(-1), replimfact(-1), replimpred(-1), replimconst(-1), rewrite(false),repdelpredflag(false), repleavepredflag(false), repdelconstflag(false), repleaveconstflag(false), optimize(false), classificationMode(asp), requiemworkers(1), requiem(false), supthreads(1), kernels(1), queryEngine(factppEngine), answercache(64), updatebatches(16), checkthreads(1), checkunordered(false), aboxconflicts(false) {};
 virtual ~CtxData() {};
 };
 
 private:
 RegistryPtr reg;
+boost::mutex termMutex;	// makes storing terms atomic if DL-atoms are evaluated concurrently
+
+// quoted forms (as in the ontology) and DL-negations of terms (by the address of the term)
+boost::unordered_map<IDAddress, ID> quotedTerms, negatedTerms;
 
 protected:
 
 // computed the DL-negation of a concept, i.e., "C" --> "-C" resp. checks if the concept is of such a form
-inline ID dlNeg(ID id){
-if (reg->terms.getByID(id).getUnquotedString()[0] == '-') return storeQuotedConstantTerm(reg->terms.getByID(id).getUnquotedString().substr(1));
-else return storeQuotedConstantTerm("-" + reg->terms.getByID(id).getUnquotedString());
-}
+// (the negations are cached since they are needed for every negated input atom)
+ID dlNeg(ID id);
 
 inline bool isDlNeg(ID id){
 return (reg->terms.getByID(id).getUnquotedString()[0] == '-');
@@ -221,6 +389,9 @@ return storeQuotedConstantTerm(reg->terms.getByID(id).getUnquotedString().substr
 }
 
 
+// returns a term of the program in the form used in the ontology (quoted), cached for constants
+ID getQuotedTerm(ID term);
+
 inline ID storeQuotedConstantTerm(std::string str){
 #ifndef NDEBUG
 if (str[0] == '\"'){
@@ -230,6 +401,7 @@ if (str.substr(0, 7).compare("http://") == 0 || str.substr(0, 8).compare("https:
 //DBGLOG(WARNING, "Stored string " + str + ", which seems to contain an absolute path including namespace; this should not happen");
 }
 #endif
+boost::mutex::scoped_lock lock(termMutex);
 return reg->storeConstantTerm("\"" + str + "\"");
 }
 
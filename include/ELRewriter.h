@@ -0,0 +1,135 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file 	ELRewriter.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Native rewriting of atomic concept queries over ELHIO ontologies.
+ */
+
+#ifndef ELREWRITER__HPP_INCLUDED_
+#define ELREWRITER__HPP_INCLUDED_
+
+#include "DLLitePlugin.h"
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/Nogood.h"
+
+#include <set>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// computes the rewritings of queries of form Q(X) <- C(X) wrt. the Tbox of an ontology
+// (which is normalized to axioms of form A <= B, A1 & ... & An <= B, exR.A <= B, A <= exR.B and R <= S, where R and S might be inverse roles)
+class ELRewriter{
+public:
+	// atom of a conjunctive query over concept resp. role indices and variable indices (variable 0 is the answer variable)
+	struct QueryAtom{
+		int pred;
+		int arg1, arg2;	// arg2 is -1 for concept atoms
+		inline bool isRole() const { return arg2 != -1; }
+		inline bool operator<(const QueryAtom& other) const { return pred < other.pred || (pred == other.pred && (arg1 < other.arg1 || (arg1 == other.arg1 && arg2 < other.arg2))); }
+		inline bool operator==(const QueryAtom& other) const { return pred == other.pred && arg1 == other.arg1 && arg2 == other.arg2; }
+	};
+	typedef std::vector<QueryAtom> ConjunctiveQuery;	// sorted and free of duplicates
+
+private:
+	// (possibly inverse) role
+	typedef std::pair<int, bool> RoleExpression;
+
+	// exR.C resp. exR^-.C (where C might be top)
+	struct Existential{
+		RoleExpression role;
+		int filler;
+	};
+
+	static const int top = 0;
+
+	RegistryPtr reg;
+
+	// concepts and roles by index; fresh concepts introduced by the normalization have no term
+	std::vector<ID> conceptTerms, roleTerms;
+	boost::unordered_map<IDAddress, int> conceptIndices, roleIndices;
+
+	// axioms indexed by their right-hand side
+	std::vector<std::vector<int> > subConcepts;	// A <= B for B
+	std::vector<std::vector<std::vector<int> > > conjunctions;	// A1 & ... & An <= B for B
+	std::vector<std::vector<Existential> > existentialsLeft;	// exR.A <= B for B
+	std::vector<std::pair<int, Existential> > existentialsRight;	// A <= exR.B
+	std::vector<std::vector<RoleExpression> > subRoles;	// S <= R resp. S^- <= R for R
+
+	// transitive closure of subConcepts (without the concept itself) and reflexive and transitive closure of subRoles
+	std::vector<std::vector<int> > subConceptClosure;
+	std::vector<std::set<RoleExpression> > subRoleClosure;
+
+	// true if the Tbox contains axioms outside of ELHIO, which were ignored (the rewriting might be incomplete)
+	bool approximated;
+
+	int getConcept(ID term);
+	int getRole(ID term);
+	int newConcept();
+	void computeClosures();
+
+	// checks if the role P^pinv is subsumed by R^rinv
+	bool subsumes(RoleExpression r, RoleExpression p) const;
+
+	// rewriting steps
+	void canonicalize(ConjunctiveQuery& q) const;
+	void expand(const ConjunctiveQuery& q, std::vector<ConjunctiveQuery>& successors) const;
+
+	// checks if the query contains the answer variable and only relevant predicates
+	bool isRelevant(const ConjunctiveQuery& q, const std::set<ID>& relevant) const;
+
+	friend class ELTboxNormalizer;
+
+public:
+	// normalizes the Tbox of an ontology (the triple store must be filled);
+	// the concepts which may be queried are indexed upfront, such that rewriting does not modify the rewriter
+	ELRewriter(DLLitePlugin::CachedOntology& ontology, const std::vector<ID>& queryConcepts);
+
+	// computes the rewritings of Q(O0) <- C(O0) which use only relevant predicates (does not access the registry,
+	// thus it may run concurrently to other threads);
+	// queries with more than maxSize atoms are not explored and the search stops if more than maxNumber rewritings exist
+	// (-1 for no limit, where the size is still bounded by a default because the set of rewritings might be infinite);
+	// returns true if all rewritings were computed
+	bool rewrite(ID concept, const std::set<ID>& relevant, int maxSize, int maxNumber, std::vector<ConjunctiveQuery>& rewritings) const;
+
+	// translates a rewriting to a nogood over ordinary nonground atoms with variables O0, O1, ...
+	void toNogood(const ConjunctiveQuery& q, Nogood& ng) const;
+};
+typedef boost::shared_ptr<ELRewriter> ELRewriterPtr;
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
@@ -35,12 +35,16 @@
 #define EXTERNALATOMS__HPP_INCLUDED_
 
 #include "DLLitePlugin.h"
+#include "NativeReasoner.h"
+#include "AnswerCache.h"
+#include "RequiemWorker.h"
 #include "dlvhex2/PlatformDefinitions.h"
 #include "dlvhex2/PluginInterface.h"
 #include "dlvhex2/ComponentGraph.h"
 #include "dlvhex2/HexGrammar.h"
 #include "dlvhex2/HexParserModule.h"
 #include <set>
+#include <boost/thread/mutex.hpp>
 
 #include "owlcpp/rdf/triple_store.hpp"
 #include "owlcpp/io/input.hpp"
@@ -52,6 +56,26 @@ DLVHEX_NAMESPACE_BEGIN
 
 namespace dllite{
 
+// the Abox update given by the input of a DL-atom; since typically many DL-atoms share the same input predicates,
+// it is built and checked for consistency only once for all DL-atoms with the same input (see DLPluginAtom::getUpdateBatch)
+struct UpdateBatch{
+	Tuple inputPredicates;	// c+, c-, r+ and r-
+	bool useAbox;
+	bm::bvector<> inputAtoms;	// the interpretation restricted to the input predicates
+	NativeReasoner::Update update;
+
+	// assertions which might still be added (only for partial answers, computed wrt. the input mask given there)
+	bool hasUnknown;
+	bm::bvector<> unknownMask;
+	NativeReasoner::Update unknown;
+
+	// consistency of update and of update plus unknown (-1 if not yet checked)
+	int consistent, possiblyConsistent;
+	boost::mutex mutex;	// guards the consistency (all other members are not modified after the batch was created)
+
+	UpdateBatch() : useAbox(true), hasUnknown(false), consistent(-1), possiblyConsistent(-1) {}
+};
+
 // base class for all DL atoms
 class DLPluginAtom : public PluginAtom{
 protected:
@@ -62,11 +86,47 @@ protected:
 	// checks the guard atoms wrt. the Abox, removes them from ng and sets keep to true in this case, and sets keep to false otherwise
 	virtual void guardSupportSet(bool& keep, Nogood& ng, const ID eaReplacement);
 
-	// expands the Abox with the facts given in the interpretation
-	std::vector<TDLAxiom*> expandAbox(const Query& query, bool useExistingAbox, bool addAll);
+	// true unless the ontology is in EL; the input of a DL-atom is handled as overlay of the Abox only for DL-Lite,
+	// where each consequence follows from a single assertion
+	bool isDLLite();
+
+	// true if DL-atoms are evaluated by the native reasoner instead of FaCT++ (DL-Lite only)
+	bool useNativeReasoner();
+
+	// returns the native reasoner for an ontology (computes the classification if necessary)
+	NativeReasonerPtr getNativeReasoner(DLLitePlugin::CachedOntologyPtr ontology);
+
+	// collects the assertions given in the interpretation, which extend the Abox of the ontology as an overlay;
+	// if unknown is given, the assertions from all other atoms of the input predicates are collected there
+	void addInputAtom(const Query& query, DLLitePlugin::CachedOntologyPtr ontology, bool useExistingAbox, IDAddress atom, NativeReasoner::Update& update);
+	void getAboxUpdate(const Query& query, DLLitePlugin::CachedOntologyPtr ontology, bool useExistingAbox, NativeReasoner::Update& update, NativeReasoner::Update* unknown = NULL);
 
-	// recorvers the original Abox
-	void restoreAbox(const Query& query, std::vector<TDLAxiom*> addedAxioms);
+	// returns the update of the query shared with other DL-atoms over the same ontology and input (including the unknown
+	// assertions if withUnknown is true), and checks its consistency (resp. possible consistency) once per batch
+	UpdateBatchPtr getUpdateBatch(const Query& query, DLLitePlugin::CachedOntologyPtr ontology, bool useExistingAbox, bool withUnknown);
+	bool isConsistent(DLLitePlugin::CachedOntologyPtr ontology, UpdateBatch& batch, bool possibly);
+
+	// answers of FaCT++ over the unmodified Abox (computed once per ontology and query)
+	const NativeReasoner::Individuals& getKernelInstances(DLLitePlugin::CachedOntologyPtr ontology, ID concept);
+
+	// adds the assertions of an update to a leased kernel (they are retracted when the lease ends)
+	void expandKernel(DLLitePlugin::CachedOntologyPtr ontology, DLLitePlugin::CachedOntology::KernelLease& kernel, const NativeReasoner::Update& update);
+
+	// reasoning over the Abox of the ontology extended by an update: the native reasoner (DL-Lite only) handles the update
+	// as overlay, FaCT++ answers the query over the Abox expanded by the update (answers over the unmodified Abox are cached)
+	bool isConsistent(DLLitePlugin::CachedOntologyPtr ontology, const NativeReasoner::Update& update);
+	void getInstances(DLLitePlugin::CachedOntologyPtr ontology, ID concept, const NativeReasoner::Update& update, NativeReasoner::Individuals& instances);
+	void getExpandedInstances(DLLitePlugin::CachedOntologyPtr ontology, ID concept, const NativeReasoner::Update& update, NativeReasoner::Individuals& instances);
+	void getRoleExtension(DLLitePlugin::CachedOntologyPtr ontology, ID role, const NativeReasoner::Update& update, NativeReasoner::Pairs& extension);
+
+	// adds the pairs (individual, filler) of a role according to a leased kernel
+	void getRoleFillers(DLLitePlugin::CachedOntologyPtr ontology, DLLitePlugin::CachedOntology::KernelLease& kernel, ID role, IDAddress individual, NativeReasoner::Pairs& pairs);
+
+	// true if all output terms of the query are constants, such that the answer is a single tuple or empty
+	// (and can be decided by isInstance resp. isRoleMember without computing the whole extension)
+	bool isOutputBound(const Query& query);
+	bool isInstance(DLLitePlugin::CachedOntologyPtr ontology, ID concept, IDAddress individual, const NativeReasoner::Update& update);
+	bool isRoleMember(DLLitePlugin::CachedOntologyPtr ontology, ID role, IDAddress first, IDAddress second, const NativeReasoner::Update& update);
 
 	// used for query answering using FaCT++
 	class Actor_collector{
@@ -86,39 +146,67 @@ protected:
 		void processTuple(Tuple tup);
 	};
 	bool changeABox(const Query& query);
+
+	// returns the Requiem workers for an ontology; on first use, the concept queries of all DL-atoms are rewritten in a batch
+	RequiemWorkerPoolPtr getRequiemWorkerPool(const std::string& ontologyPath);
+
+	// returns the persistent cache of support families for the ontology used by the DL-atom, or a null pointer if caching is disabled
+	SupportSetCachePtr getSupportSetCache(const Query& query);
+
+	// stores an atom of a support set under the learning lock (support sets of several DL-atoms may be learned concurrently)
+	ID storeLearnedAtom(const OrdinaryAtom& atom);
+
+	// answers of this DL-atom (created on first use, unless disabled)
+	AnswerCachePtr answerCache;
+	boost::mutex answerCacheMutex;
+
+	// computes the answer of the DL-atom (called by retrieve if the answer is not cached)
+	virtual void evaluate(const Query& query, Answer& answer) = 0;
 public:
 	DLPluginAtom(std::string predName, ProgramCtx& ctx, bool monotonic = true);
 	virtual void retrieve(const Query& query, Answer& answer);
+	virtual void retrieve(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
 	virtual void learnSupportSets(const Query& query, NogoodContainerPtr nogoods);
 	void optimizeSupportSets(SimpleNogoodContainerPtr initial, NogoodContainerPtr final);
+
+	// generalizes a nogood learned from a failed post check in repair mode by replacing the individuals of the replacement,
+	// guard and input atoms with variables (only nogoods whose premises entail the answer are generalized, see ExternalAtoms.cpp)
+	virtual void generalizeNogood(Nogood ng, ProgramCtx* ctx, NogoodContainerPtr nogoods);
 };
 
 // concept queries
 class CDLAtom : public DLPluginAtom{
+protected:
+	virtual void evaluate(const Query& query, Answer& answer);
 public:
 	CDLAtom(ProgramCtx& ctx, std::string predName);
-	virtual void retrieve(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
 };
 
 // role queries
 class RDLAtom : public DLPluginAtom{
+protected:
+	virtual void evaluate(const Query& query, Answer& answer);
+
+	// all pairs over a set of individuals (in sorted order), or only the bound pair if it is given
+	void getAllPairs(InterpretationConstPtr individuals, const NativeReasoner::Pair* bound, NativeReasoner::Pairs& pairs);
 public:
 	RDLAtom(ProgramCtx& ctx, std::string predName);
-	virtual void retrieve(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
 };
 
 // consistency check
 class ConsDLAtom : public DLPluginAtom{
+protected:
+	virtual void evaluate(const Query& query, Answer& answer);
 public:
 	ConsDLAtom(ProgramCtx& ctx);
-	virtual void retrieve(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
 };
 
 // inconsistency check
 class InconsDLAtom : public DLPluginAtom{
+protected:
+	virtual void evaluate(const Query& query, Answer& answer);
 public:
 	InconsDLAtom(ProgramCtx& ctx);
-	virtual void retrieve(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
 };
 
 }
@@ -0,0 +1,177 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file 	NativeReasoner.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Native instance retrieval and consistency checking for DL-Lite ontologies.
+ */
+
+#ifndef NATIVEREASONER__HPP_INCLUDED_
+#define NATIVEREASONER__HPP_INCLUDED_
+
+#include "DLLitePlugin.h"
+#include "ClassificationIndex.h"
+#include "dlvhex2/PlatformDefinitions.h"
+
+#include <vector>
+#include <utility>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/thread/mutex.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// answers instance queries over a DL-Lite ontology using its classification:
+// the instances of a basic concept are the union of the posting lists (asserted members) of its subsumees,
+// where the members of exR are the subjects of the extension of R (including its subroles and inverses)
+class NativeReasoner{
+public:
+	typedef bm::bvector<> Individuals;	// addresses of individual terms
+	typedef std::pair<IDAddress, IDAddress> Pair;
+	typedef std::vector<Pair> Pairs;
+
+	// assertions added to the Abox by the input of a DL-atom (all terms must be quoted constants as in the ontology)
+	struct Update{
+		boost::unordered_map<IDAddress, Individuals> concepts;	// C(a) resp. -C(a) by the term C resp. -C
+		boost::unordered_map<IDAddress, Pairs> roles;	// R(a,b) resp. -R(a,b) by the term R resp. -R
+
+		void addConceptAssertion(ID concept, ID individual);
+		void addRoleAssertion(ID role, ID individual1, ID individual2);
+		void add(const Update& other);
+		inline bool empty() const { return concepts.empty() && roles.empty(); }
+	};
+
+private:
+	// membership of an individual in a basic concept (second is unused) resp. of a pair in a role, by dense index of the term
+	struct Membership{
+		unsigned term;
+		IDAddress first, second;
+		Membership(unsigned term, IDAddress first, IDAddress second) : term(term), first(first), second(second) {}
+		inline bool operator==(const Membership& other) const { return term == other.term && first == other.first && second == other.second; }
+	};
+	struct MembershipHash{
+		std::size_t operator()(const Membership& m) const;
+	};
+	typedef boost::unordered_set<Membership, MembershipHash> Memberships;
+
+	RegistryPtr reg;
+	ClassificationIndexPtr classification;
+
+	// posting lists of the concept assertions and the role assertion index of the Abox of the ontology
+	// (empty resp. null if the ontology was loaded without Abox)
+	boost::unordered_map<IDAddress, Individuals> baseConcepts;
+	const RoleAssertionIndex* baseRoles;
+
+	// for the dense indices of the classification: the role R of exR (ID_FAIL for other terms) and whether the term is a (negated) role
+	std::vector<ID> existentialRoles;
+	std::vector<bool> roleTerms;
+	std::vector<bool> functTerms;	// functional roles (funct in the classification)
+	boost::unordered_map<unsigned, unsigned> existentials;	// index of exR by the index of R
+
+	// state of the incremental consistency check: consistency of the Abox of the ontology (-1 if not yet checked),
+	// the members of the concept terms in this Abox (computed on demand) and whether a membership
+	// clashes with it (memorized since the input of a DL-atom changes only slightly between calls)
+	mutable int baseConsistent;
+	mutable std::vector<Individuals> baseMembers;
+	mutable std::vector<bool> baseMembersComputed;
+	mutable boost::unordered_map<Membership, bool, MembershipHash> baseClashes;
+	mutable boost::unordered_map<unsigned, Pairs> baseFunctPairs;	// sorted extension of functional roles in this Abox
+	mutable boost::mutex mutex;	// guards this state if DL-atoms are evaluated concurrently
+
+	// adds the asserted members of a concept term (including the subjects of R if the term is exR)
+	void addConceptMembers(unsigned index, const Update& update, bool includeBase, Individuals& members) const;
+
+	// adds the asserted pairs of a role term (swapped if the term is used as inverse)
+	void addRoleMembers(ID role, bool swapped, const Update& update, bool includeBase, Pairs* pairs, Individuals* subjects) const;
+
+	// computes the role terms reachable from a role term over subroles (resp. superroles if upward is true) and inverses
+	// as states 2*i+s, where s=1 if term i is used as inverse (i.e., S(b,a) contributes to R(a,b) resp. follows from it)
+	void getRoleStates(unsigned index, bool upward, std::vector<unsigned>& states) const;
+
+	// checks if S(a,b) is asserted (in the Abox or the update) for a single role term S
+	bool hasRoleMember(ID role, IDAddress first, IDAddress second, const Update& update, bool includeBase) const;
+
+	// checks if some S(a,b) resp. S(b,a) (if swapped) is asserted for a given a and a single role term S
+	bool hasRoleFiller(ID role, IDAddress individual, bool swapped, const Update& update, bool includeBase) const;
+
+	// collects the extension of a role including its subroles and inverses as pairs and/or as set of subjects
+	void collectRole(ID role, const Update& update, bool includeBase, Pairs* pairs, Individuals* subjects) const;
+
+	// checks all conflicts over the Abox of the ontology (and the update)
+	bool checkAll(const Update& update) const;
+
+	// computes the memberships in basic concepts and roles which follow from the update
+	// (for role assertions R(a,b) also for all superroles and inverses of R and their existentials)
+	void getMemberships(const Update& update, Memberships& memberships) const;
+
+	// checks if a membership is in conflict with a membership in the Abox of the ontology
+	// (including a different filler of a functional role)
+	bool clashesWithBase(const Membership& m) const;
+
+	// checks if a sorted list of pairs without duplicates contains two pairs (a,b), (a,c), i.e., b != c
+	static bool hasTwoFillers(const Pairs& pairs);
+
+public:
+	// builds the posting lists of the Abox (the classification of the ontology must be computed)
+	NativeReasoner(RegistryPtr reg, const DLLitePlugin::CachedOntology& ontology);
+
+	// checks if the ontology extended by the update is consistent; the Abox of the ontology is checked only once,
+	// afterwards only conflicts which involve the update are checked (in time proportional to the update);
+	// as in DL-Lite (and for the support sets), the unique name assumption holds, thus two different fillers of a
+	// functional role are inconsistent (FaCT++ kernels are told that all individuals are different, cf. DLLitePlugin)
+	bool isConsistent(const Update& update) const;
+
+	// computes the pairs (i,j) with i <= j of assertions which are in conflict over the Tbox alone, where each update holds
+	// a single assertion and (i,i) means that assertion i is inconsistent by itself; in DL-Lite these pairs are all
+	// minimal inconsistent subsets of the assertions
+	void getConflicts(const std::vector<Update>& assertions, std::vector<std::pair<unsigned, unsigned> >& conflicts) const;
+
+	// computes the instances of a (possibly negated) concept; if includeBase is false, only those which follow from the update
+	// are computed (in DL-Lite, each instance follows from a single assertion, thus the base answers can be computed separately)
+	void getInstances(ID concept, const Update& update, bool includeBase, Individuals& instances) const;
+
+	// computes the pairs in the extension of a role (same for includeBase) in one pass over the role assertions of the
+	// role, its subroles and its inverses (instead of querying the fillers of each individual separately)
+	void getRoleExtension(ID role, const Update& update, bool includeBase, Pairs& extension) const;
+
+	// targeted checks for bound outputs (same for includeBase), which look up only the subsumees resp. subroles of the query
+	// instead of computing the whole extension
+	bool isInstance(ID concept, IDAddress individual, const Update& update, bool includeBase) const;
+	bool isRoleMember(ID role, IDAddress first, IDAddress second, const Update& update, bool includeBase) const;
+};
+typedef boost::shared_ptr<NativeReasoner> NativeReasonerPtr;
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
@@ -46,7 +46,14 @@
 #include "dlvhex2/NogoodGrounder.h"
 
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <deque>
+#include <map>
 
 DLVHEX_NAMESPACE_BEGIN
 
@@ -76,6 +83,17 @@ protected:
   SimpleNogoodContainerPtr globalLearnedEANogoods;
   SimpleNogoodContainerPtr supportSets;
 
+  // ABox facts (aux_o) and facts marked for removal (bar_aux_o) of repair candidates
+  PredicateMask guardMask;
+  PredicateMask guardbarMask;
+  // address of the aux_o twin of each bar_aux_o atom (ALL_ONES for other atoms), aligned with guardbarMask
+  std::vector<IDAddress> guardOfBar;
+  // bar_aux_o atoms whose aux_o twin did not exist yet when they were mapped
+  std::vector<IDAddress> unmappedBars;
+
+  // extends guardOfBar by the bar_aux_o atoms added to the registry since the last call and retries unmappedBars
+  void updateGuardOfBar();
+
 
 public:
   RepairModelGeneratorFactory(
@@ -145,6 +163,87 @@ protected:
   UnfoundedSetCheckerManagerPtr ufscm;
   InterpretationPtr programMask;		// all atoms in the program
 
+  // outcomes of external atom evaluations in post checks, keyed by the assertions removed from the ABox (bar_aux_o),
+  // the external atom and the projection of the candidate to its input predicates
+  struct PostCheckKey{
+    unsigned eaIndex;
+    bm::bvector<> removal;
+    bm::bvector<> input;
+    std::size_t hash;
+    inline bool operator==(const PostCheckKey& other) const { return eaIndex == other.eaIndex && hash == other.hash && removal.compare(other.removal) == 0 && input.compare(other.input) == 0; }
+  };
+  struct PostCheckKeyHash{
+    inline std::size_t operator()(const PostCheckKey& key) const { return key.hash; }
+  };
+  typedef boost::unordered_map<PostCheckKey, InterpretationConstPtr, PostCheckKeyHash> PostCheckCache;
+  PostCheckCache postCheckCache;
+  static const unsigned MaxPostCheckCacheSize = 1024;
+
+  // fingerprint of the key over the set bits of both bitsets
+  static std::size_t getPostCheckKeyHash(const PostCheckKey& key);
+
+  // serializes the parts of post checks which access state shared by all candidates (masks, caches, UFS checker)
+  boost::mutex postCheckMutex;
+
+  // shared state of the solver thread and the post check workers in pipelined mode (--checkthreads)
+  struct Pipeline{
+    std::deque<std::pair<unsigned, InterpretationPtr> > candidates;	// enumerated candidates which are not yet checked
+    std::map<unsigned, InterpretationPtr> results;	// checked candidates by number (null if the post check failed)
+    std::vector<Nogood> nogoods;	// learned by the workers, added to the solver by the solver thread
+    std::vector<Nogood> learnedNogoods;	// nogoods of failed post checks, transferred by the solver thread via learnedEANogoods
+    unsigned enumerated;		// number of candidates enumerated so far
+    unsigned returned;		// number of results taken by generateNextModel
+    unsigned next;		// number of the next result in enumeration order
+    unsigned capacity;		// maximal number of candidates which are enumerated but not yet taken
+    bool exhausted;		// the solver has no further candidates
+    bool stop;
+    std::string error;		// message of the first failure
+    boost::mutex mutex;
+    boost::condition_variable changed;
+    boost::thread_group threads;
+  };
+  boost::scoped_ptr<Pipeline> pipeline;	// started by the first call of generateNextModel in pipelined mode
+
+  // enumerates candidates of the solver into the pipeline
+  void runCandidateProducer();
+
+  // post checks candidates of the pipeline until none is left
+  void runPostCheckWorker();
+
+  // returns the next repair answer set in pipelined mode
+  InterpretationPtr generateNextModelPipelined();
+
+  // removes auxiliary atoms from a candidate which passed the post check
+  InterpretationPtr filterModel(InterpretationPtr modelCandidate);
+
+  // ground nogood which excludes the value of a replacement atom in a candidate whose evaluation failed the post check
+  // (minimal by monotonicity of the external atom: only the removal and input atoms which cannot repair the evaluation,
+  // and only those over the connected component of the output individuals in the Abox)
+  Nogood getEvaluationNogood(InterpretationConstPtr modelCandidate, const ExternalAtom& eatom, ID replacement);
+
+  // adds a nogood learned from a failed post check to learnedEANogoods (generalized by updateEANogoods if enabled)
+  void learnPostCheckNogood(const Nogood& ng);
+
+  // store the atoms and terms of a post check in the registry under the plugin-wide lock of DLPluginAtom::storeLearnedAtom,
+  // since post checks run concurrently in pipelined mode (and with support set learning)
+  ID storePostCheckAtom(const OrdinaryAtom& atom);
+  ID storePostCheckTerm(const std::string& symbol);
+
+  // the conflicting pairs of Abox assertions (aux_o atoms, DL-Lite only), which the post check rejects, and the
+  // removal atoms (bar_aux_o) of the assertions in the ground program
+  typedef std::pair<IDAddress, IDAddress> GuardPair;
+  std::vector<GuardPair> aboxConflicts;
+  boost::unordered_map<IDAddress, IDAddress> barOfGuard;
+
+  // Abox conflict propagation (--aboxconflicts): the bar_aux_o atoms of the assertions which are in conflict with the assertion
+  // of a bar_aux_o atom; as soon as two conflicting assertions are kept under the partial assignment, the clash is added as nogood
+  boost::unordered_map<IDAddress, std::vector<IDAddress> > conflictingBars;
+  boost::unordered_set<std::pair<IDAddress, IDAddress> > propagatedConflicts;
+  bool conflictPropagator;	// is this object registered as propagator of the solver?
+
+  // computes aboxConflicts according to the native reasoner, and conflictingBars if --aboxconflicts is given
+  void computeAboxConflicts();
+
   // members
 
   /**
@@ -157,6 +256,24 @@ protected:
    */
   void learnSupportSets();
 
+  // shared state of the threads which learn the support families of the inner external atoms
+  struct SupportFamilyJobs{
+    std::vector<unsigned> eaIndices;	// external atoms which provide support sets
+    unsigned next;			// position of the next job in eaIndices
+    std::vector<SimpleNogoodContainerPtr>* supportSetsOfExternalAtom;
+    std::string error;			// message of the first failed job
+    boost::mutex mutex;
+  };
+
+  /**
+   * Learns the support family of each inner external atom into supportSetsOfExternalAtom (with the same index)
+   * using the number of threads given by --supthreads; the result does not depend on the scheduling
+   */
+  void learnSupportFamilies(std::vector<SimpleNogoodContainerPtr>& supportSetsOfExternalAtom);
+
+  // processes jobs until none is left
+  void runSupportFamilyJobs(SupportFamilyJobs* jobs);
+
   /**
    * Triggern nonground nogood learning and instantiation
    * Transferes new nogoods from learnedEANogoods to the solver and updates learnedEANogoodsTransferredIndex accordingly
@@ -0,0 +1,92 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file 	RequiemWorker.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Persistent Requiem processes for query rewriting in EL mode.
+ */
+
+#ifndef REQUIEMWORKER__HPP_INCLUDED_
+#define REQUIEMWORKER__HPP_INCLUDED_
+
+#include "dlvhex2/PlatformDefinitions.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// a Requiem process which loads the ontology once and rewrites queries received over a pipe
+class RequiemWorker{
+private:
+	int pid;
+	FILE* toWorker;
+	FILE* fromWorker;
+
+public:
+	RequiemWorker(const std::string& jarPath, const std::string& ontologyPath);
+	virtual ~RequiemWorker();
+
+	// sends a query of form Q(?0) <- C(?0) to the worker
+	void send(const std::string& query);
+
+	// reads the rewritings of the query which was sent last (one line per rewriting)
+	void receive(std::vector<std::string>& rewritings);
+};
+typedef boost::shared_ptr<RequiemWorker> RequiemWorkerPtr;
+
+// a pool of Requiem workers for one ontology, which caches the rewritings of all queries
+class RequiemWorkerPool{
+private:
+	std::string jarPath, ontologyPath;
+	unsigned maxWorkers;
+	std::vector<RequiemWorkerPtr> workers;
+	std::map<std::string, std::vector<std::string> > rewritings;
+
+public:
+	RequiemWorkerPool(const std::string& jarPath, const std::string& ontologyPath, unsigned maxWorkers);
+
+	// rewrites all queries which are not cached yet, distributing them over the workers
+	void prefetch(const std::vector<std::string>& queries);
+
+	// returns the rewritings of a query (computes them if they were not prefetched)
+	const std::vector<std::string>& getRewritings(const std::string& query);
+};
+typedef boost::shared_ptr<RequiemWorkerPool> RequiemWorkerPoolPtr;
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
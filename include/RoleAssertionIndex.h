@@ -0,0 +1,94 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file 	RoleAssertionIndex.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Hashed index of the role assertions of an Abox.
+ */
+
+#ifndef ROLEASSERTIONINDEX__HPP_INCLUDED_
+#define ROLEASSERTIONINDEX__HPP_INCLUDED_
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Interpretation.h"
+
+#include <vector>
+#include <utility>
+#include <boost/unordered_map.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// stores role assertions R(a,b) partitioned by the role R, where each partition maps a subject a to its objects b
+class RoleAssertionIndex{
+private:
+	typedef std::vector<IDAddress> Objects;
+	typedef boost::unordered_map<IDAddress, Objects> Adjacency;
+	boost::unordered_map<IDAddress, Adjacency> roles;
+	boost::unordered_map<IDAddress, bm::bvector<> > roleObjects;	// all b with R(a,b) by the role R
+
+	std::size_t assertionCount;
+	bool sorted;	// true if all object lists are sorted and free of duplicates
+
+public:
+	RoleAssertionIndex();
+
+	// adds a role assertion (all terms must be constants)
+	void add(ID role, ID subject, ID object);
+
+	// sorts the object lists, such that lookups use binary search (must be called after the last assertion was added)
+	void finalize();
+
+	void clear();
+
+	// checks if R(a,b) is in the Abox
+	bool contains(ID role, ID subject, ID object) const;
+
+	// returns the objects b with R(a,b) in the Abox (null pointer if there are none)
+	const std::vector<IDAddress>* getObjects(ID role, ID subject) const;
+
+	// checks if there is some R(a,b) in the Abox for a given a, or for a given b if swapped is true
+	bool hasFiller(ID role, IDAddress individual, bool swapped) const;
+
+	// bulk access to the extension of a role: adds all pairs (a,b) with R(a,b) in the Abox, or (b,a) if swapped is true
+	void getPairs(ID role, bool swapped, std::vector<std::pair<IDAddress, IDAddress> >& pairs) const;
+
+	// adds all a with R(a,b) in the Abox, or all b if swapped is true
+	void getSubjects(ID role, bool swapped, bm::bvector<>& subjects) const;
+
+	inline std::size_t size() const { return assertionCount; }
+};
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
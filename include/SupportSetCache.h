@@ -0,0 +1,100 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file 	SupportSetCache.h
+ * @author 	Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author 	Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Persistent cache of the support families learned for DL-atoms.
+ */
+
+#ifndef SUPPORTSETCACHE__HPP_INCLUDED_
+#define SUPPORTSETCACHE__HPP_INCLUDED_
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/PluginInterface.h"
+#include "dlvhex2/Nogood.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite{
+
+// stores the nonground support sets of DL-atoms in a file (one file per version of the ontology);
+// a support family is keyed by the DL-query, the predicates in the maximal input and the options which influence learning
+class SupportSetCache{
+private:
+	// literal of a support set, independent of the registry
+	struct Literal{
+		enum Type{ guard, output, ordinary };
+		Type type;
+		bool naf;
+		bool sign;	// sign of the output atom
+		IDKind kind;
+		std::vector<std::string> terms;	// tagged with c (constant), v (variable) or i (integer)
+	};
+	typedef std::vector<Literal> SupportSet;
+	struct Family{
+		bool incomplete;
+		std::vector<SupportSet> supportSets;
+	};
+
+	RegistryPtr reg;
+	std::string filename;
+	ID guardPredicateID;
+	std::map<std::string, Family> families;
+
+	// reads all complete records from the file (a truncated record at the end is ignored)
+	void read();
+	void append(const std::string& key, const Family& family) const;
+
+	std::string encodeTerm(ID term) const;
+	ID decodeTerm(const std::string& term) const;
+
+public:
+	SupportSetCache(RegistryPtr reg, const std::string& filename, ID guardPredicateID);
+
+	// computes the key of the support family of a DL-atom
+	static std::string getKey(RegistryPtr reg, const PluginAtom::Query& query, const std::string& options);
+
+	// adds the cached support sets of the DL-atom to supportSets and returns true, or returns false if there is no entry
+	bool lookup(const std::string& key, const PluginAtom::Query& query, SimpleNogoodContainerPtr supportSets, bool& incomplete) const;
+
+	// stores the support sets of the DL-atom (families with atoms which cannot be restored in a later run are skipped)
+	void store(const std::string& key, const PluginAtom::Query& query, SimpleNogoodContainerPtr supportSets, bool incomplete);
+};
+typedef boost::shared_ptr<SupportSetCache> SupportSetCachePtr;
+
+}
+
+DLVHEX_NAMESPACE_END
+
+#endif
@@ -1,5 +1,8 @@
+import java.io.BufferedReader;
 import java.io.File;
 import java.io.FileWriter;
+import java.io.InputStreamReader;
+import java.io.PrintStream;
 import java.util.ArrayList;
 import java.util.Collections;
 import java.util.Comparator;
@@ -22,10 +25,16 @@ public class MyRequiemCLI {
 	 * 0 - query file
 	 * 1 - ontology file
 	 * 2 - mode (N|F|G)
+	 * or
+	 * 0 - --server
+	 * 1 - ontology file
 	 */
 	public static void main(String[] args) throws Exception{
 		
-		if(args.length == 3 && (args[2].equals("N") || args[2].equals("F") || args[2].equals("G"))){
+		if(args.length == 2 && args[0].equals("--server")){
+			serve(args[1]);
+		}
+		else if(args.length == 3 && (args[2].equals("N") || args[2].equals("F") || args[2].equals("G"))){
 			//String queryFile = args[0];
 			String queryString = args[0];
 			String ontologyFile = args[1];
@@ -60,7 +69,45 @@ public class MyRequiemCLI {
 			
 		}
 		else{
-			throw new Exception("Use: java Requiem query.cq ontology.owl mode(N|F|G)");
+			throw new Exception("Use: java Requiem query.cq ontology.owl mode(N|F|G) or java Requiem --server ontology.owl");
+		}
+	}
+
+	/**
+	 * Loads the ontology once and answers queries read line by line from stdin.
+	 * The rewritings of each query are printed in the same format as in the
+	 * one-shot mode and terminated by an empty line; an invalid query yields
+	 * only the empty line.
+	 */
+	private static void serve(String ontologyFile) throws Exception{
+
+		String ontologyURI = new File(ontologyFile).toURI().toString();
+		ArrayList<Clause> ontology = m_parser.getClauses(ontologyURI);
+
+		BufferedReader in = new BufferedReader(new InputStreamReader(System.in));
+		PrintStream out = System.out;
+		String queryString;
+		while((queryString = in.readLine()) != null){
+			if(queryString.trim().equals("")){
+				continue;
+			}
+			try{
+				Clause query = m_parser.getQuery(queryString);
+				if(query != null){
+					// the rewriter changes the selection state of the clauses, thus it gets fresh copies
+					ArrayList<Clause> original = new ArrayList<Clause>();
+					for(Clause c: ontology){
+						original.add(new Clause(c.getBody().clone(), c.getHead()));
+					}
+					original.add(query);
+					printRewriting(out, m_rewriter.rewrite(original, "G"));
+				}
+			}
+			catch(Exception e){
+				System.err.println("Invalid query " + queryString + ": " + e.getMessage());
+			}
+			out.print("\n");
+			out.flush();
 		}
 	}
 	
@@ -78,21 +125,24 @@ public class MyRequiemCLI {
 		
 		//System.out.println("Size of the rewriting (symbols): " + size + "\n");
 		//System.err.print("==================SUMMARY==================\n");
+		printRewriting(System.out, rewriting);
+		
+        System.out.close();
+	}
+
+	private static void printRewriting(PrintStream out, ArrayList<Clause> rewriting){
 		Collections.sort(rewriting, new Comparator<Clause>(){
 			public int compare(Clause c1, Clause c2){
 			    return c1.m_canonicalRepresentation.compareTo(c2.m_canonicalRepresentation);
 			}
 		});
-		int i = 0;
 		String s; 
 		for(Clause c: rewriting){
 			s = c.m_canonicalRepresentation.replace("Q(?0)  <-  ", "");
 			s = s.replace("?", "O");
 			s = s.replace(", ", " ");
-			System.out.print(s + "\n");
+			out.print(s + "\n");
 		}
-		
-        System.out.close();
 	}
 
 }
@@ -0,0 +1,163 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file AnswerCache.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Memory-bounded cache of the answers of DL-atoms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "AnswerCache.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Logger.h"
+
+#include "boost/foreach.hpp"
+#include <boost/functional/hash.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+
+	namespace {
+		void addAtoms(const bm::bvector<>& atoms, std::vector<IDAddress>& addresses, std::size_t& hash) {
+			bm::bvector<>::enumerator en = atoms.first();
+			bm::bvector<>::enumerator en_end = atoms.end();
+			while (en < en_end) {
+				addresses.push_back(*en);
+				boost::hash_combine(hash, *en);
+				en++;
+			}
+		}
+	}
+
+	// ============================== Class AnswerCache::Key ==============================
+
+	AnswerCache::Key::Key(const PluginAtom::Query& query, bool partial) : input(query.input), hash(0) {
+
+		// the answer depends only on the input atoms of the DL-atom
+		// (whether the Abox of the ontology is used is determined by them as well)
+		BOOST_FOREACH (ID id, input) {
+			boost::hash_combine(hash, id.kind);
+			boost::hash_combine(hash, id.address);
+		}
+		const ExternalAtom& eatom = query.ctx->registry()->eatoms.getByID(query.eatomID);
+		const bm::bvector<>& mask = eatom.getPredicateInputMask()->getStorage();
+		addAtoms(query.interpretation->getStorage() & mask, inputAtoms, hash);
+
+		// for bound outputs only their membership is computed (see DLPluginAtom::isOutputBound)
+		bool bound = !query.pattern.empty();
+		BOOST_FOREACH (ID id, query.pattern) bound &= id.isConstantTerm();
+		if (bound) {
+			boundOutput = query.pattern;
+			BOOST_FOREACH (ID id, boundOutput) boost::hash_combine(hash, id.address);
+		}
+
+		// partial answers depend also on the atoms which are already assigned
+		if (partial) {
+			boost::hash_combine(hash, query.eatomID.address);
+			input.push_back(query.eatomID);
+			if (!!query.assigned) {
+				boost::hash_combine(hash, inputAtoms.size());
+				addAtoms(query.assigned->getStorage() & mask, assignedAtoms, hash);
+			}
+		}
+	}
+
+	bool AnswerCache::Key::operator==(const Key& other) const {
+		return hash == other.hash && input == other.input && inputAtoms == other.inputAtoms && assignedAtoms == other.assignedAtoms && boundOutput == other.boundOutput;
+	}
+
+	// ============================== Class AnswerCache ==============================
+
+	AnswerCache::AnswerCache(std::size_t capacity) : capacity(capacity), size(0), hits(0), misses(0), evictions(0) {
+	}
+
+	std::size_t AnswerCache::estimateSize(const std::vector<Tuple>& tuples) {
+		std::size_t s = tuples.capacity() * sizeof(Tuple);
+		BOOST_FOREACH (const Tuple& t, tuples) s += t.capacity() * sizeof(ID);
+		return s;
+	}
+
+	void AnswerCache::evict() {
+		while (size > capacity && !entries.empty()) {
+			Entry& lru = entries.back();
+			index.erase(lru.key);
+			size -= lru.size;
+			entries.pop_back();
+			evictions++;
+		}
+	}
+
+	bool AnswerCache::lookup(const Key& key, PluginAtom::Answer& answer) {
+
+		boost::unordered_map<Key, Entries::iterator, KeyHash>::iterator it = index.find(key);
+		if (it == index.end()) {
+			misses++;
+			return false;
+		}
+		hits++;
+
+		// mark as most recently used
+		entries.splice(entries.begin(), entries, it->second);
+		const Entry& entry = entries.front();
+		answer.get().insert(answer.get().end(), entry.tuples.begin(), entry.tuples.end());
+		answer.getUnknown().insert(answer.getUnknown().end(), entry.unknown.begin(), entry.unknown.end());
+		return true;
+	}
+
+	void AnswerCache::store(const Key& key, const PluginAtom::Answer& answer) {
+
+		if (index.find(key) != index.end()) return;
+
+		entries.push_front(Entry(key));
+		Entry& entry = entries.front();
+		entry.tuples = answer.get();
+		entry.unknown = answer.getUnknown();
+		// the key is stored twice (in the entry and in the index)
+		entry.size = sizeof(Entry) + sizeof(Key)
+			+ 2 * ((key.input.capacity() + key.boundOutput.capacity()) * sizeof(ID) + (key.inputAtoms.capacity() + key.assignedAtoms.capacity()) * sizeof(IDAddress))
+			+ estimateSize(entry.tuples) + estimateSize(entry.unknown);
+		index[key] = entries.begin();
+		size += entry.size;
+		DBGLOG(DBG, "Answer cache: stored answer with " << entry.tuples.size() << " tuples (" << entry.size << " bytes, " << entries.size() << " entries in total)");
+
+		evict();
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
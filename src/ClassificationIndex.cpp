@@ -0,0 +1,368 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file ClassificationIndex.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Native computation and indexed storage of the classification of an ontology.
+ *
+ * The closure computes the same relations as the classification program
+ * (see DLLitePlugin::constructClassificationProgram):
+ *   sub(X,Z) :- sub(X,Y), sub(Y,Z).
+ *   sub(Y2,X2) :- op(X,X2), op(Y,Y2), sub(X,Y).
+ *   conf(X,Y1) :- sub(X,Y), op(Y,Y1).
+ *   conf(X,Y2) :- conf(X,Y1), sub(Y2,Y1).
+ *   confref(X) :- conf(X,Y), inv(X,Y).
+ *   op(Y,X) :- op(X,Y).
+ *   inv(Y,X) :- inv(X,Y).
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "ClassificationIndex.h"
+#include "DLLitePlugin.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Printer.h"
+
+#include <bm/bmalgo.h>
+#include "boost/foreach.hpp"
+#include <vector>
+#include <utility>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+	extern DLLitePlugin theDLLitePlugin;
+
+	ClassificationIndex::ClassificationIndex(RegistryPtr reg) : reg(reg) {
+	}
+
+	unsigned ClassificationIndex::getOrCreateIndex(ID term) {
+		boost::unordered_map<IDAddress, unsigned>::const_iterator it = indices.find(term.address);
+		if (it != indices.end()) return it->second;
+
+		unsigned index = terms.size();
+		indices[term.address] = index;
+		terms.push_back(term);
+		sub.push_back(Row());
+		op.push_back(Row());
+		inv.push_back(Row());
+		conf.push_back(Row());
+		return index;
+	}
+
+	unsigned ClassificationIndex::getIndex(ID term) const {
+		boost::unordered_map<IDAddress, unsigned>::const_iterator it = indices.find(term.address);
+		return it == indices.end() ? npos : it->second;
+	}
+
+	void ClassificationIndex::closeSub() {
+
+		// iterative version of Tarjan's algorithm; components are completed in reverse topological order,
+		// i.e., when a component is completed, the closure of all components reachable from it is already known
+		const unsigned n = terms.size();
+		std::vector<unsigned> dfsIndex(n, npos), lowLink(n, 0), component(n, npos);
+		std::vector<bool> onStack(n, false);
+		std::vector<unsigned> stack;
+		std::vector<Row> closure;	// closure by component
+		unsigned nextIndex = 0;
+
+		// work list of (node, iterator position over its successors)
+		std::vector<std::pair<unsigned, Row::enumerator> > work;
+
+		for (unsigned root = 0; root < n; ++root) {
+			if (dfsIndex[root] != npos) continue;
+
+			dfsIndex[root] = lowLink[root] = nextIndex++;
+			stack.push_back(root);
+			onStack[root] = true;
+			work.push_back(std::pair<unsigned, Row::enumerator>(root, sub[root].first()));
+
+			while (!work.empty()) {
+				unsigned v = work.back().first;
+				Row::enumerator& en = work.back().second;
+				Row::enumerator en_end = sub[v].end();
+
+				// descend into the next unvisited successor
+				bool descended = false;
+				while (en < en_end) {
+					unsigned w = *en;
+					en++;
+					if (dfsIndex[w] == npos) {
+						dfsIndex[w] = lowLink[w] = nextIndex++;
+						stack.push_back(w);
+						onStack[w] = true;
+						work.push_back(std::pair<unsigned, Row::enumerator>(w, sub[w].first()));
+						descended = true;
+						break;
+					} else if (onStack[w] && dfsIndex[w] < lowLink[v]) {
+						lowLink[v] = dfsIndex[w];
+					}
+				}
+				if (descended) continue;
+
+				// all successors of v are done
+				work.pop_back();
+				if (!work.empty()) {
+					unsigned parent = work.back().first;
+					if (lowLink[v] < lowLink[parent]) lowLink[parent] = lowLink[v];
+				}
+
+				if (lowLink[v] == dfsIndex[v]) {
+					// v is the root of a component: pop it and compute its closure
+					unsigned c = closure.size();
+					closure.push_back(Row());
+					std::vector<unsigned> members;
+					unsigned w;
+					do {
+						w = stack.back();
+						stack.pop_back();
+						onStack[w] = false;
+						component[w] = c;
+						members.push_back(w);
+					} while (w != v);
+
+					Row& cl = closure[c];
+					BOOST_FOREACH (unsigned m, members) cl |= sub[m];
+					Row direct = cl;
+					Row::enumerator en2 = direct.first();
+					Row::enumerator en2_end = direct.end();
+					while (en2 < en2_end) {
+						if (component[*en2] != c) cl |= closure[component[*en2]];
+						en2++;
+					}
+				}
+			}
+		}
+
+		for (unsigned i = 0; i < n; ++i) {
+			sub[i] = closure[component[i]];
+		}
+	}
+
+	bool ClassificationIndex::contrapose() {
+
+		// sub(Y2,X2) :- op(X,X2), op(Y,Y2), sub(X,Y).
+		bool changed = false;
+		const unsigned n = terms.size();
+		for (unsigned x = 0; x < n; ++x) {
+			if (!op[x].any()) continue;
+			Row::enumerator eny = sub[x].first();
+			Row::enumerator eny_end = sub[x].end();
+			while (eny < eny_end) {
+				unsigned y = *eny;
+				eny++;
+				Row::enumerator eny2 = op[y].first();
+				Row::enumerator eny2_end = op[y].end();
+				while (eny2 < eny2_end) {
+					unsigned y2 = *eny2;
+					eny2++;
+					Row::enumerator enx2 = op[x].first();
+					Row::enumerator enx2_end = op[x].end();
+					while (enx2 < enx2_end) {
+						if (!sub[y2].get_bit(*enx2)) {
+							sub[y2].set_bit(*enx2);
+							changed = true;
+						}
+						enx2++;
+					}
+				}
+			}
+		}
+		return changed;
+	}
+
+	void ClassificationIndex::computeSubsumees() {
+
+		const unsigned n = terms.size();
+		subsumees.assign(n, Row());
+		for (unsigned x = 0; x < n; ++x) {
+			Row::enumerator eny = sub[x].first();
+			Row::enumerator eny_end = sub[x].end();
+			while (eny < eny_end) {
+				subsumees[*eny].set_bit(x);
+				eny++;
+			}
+		}
+	}
+
+	void ClassificationIndex::saturate(InterpretationConstPtr edb) {
+
+		assert(terms.size() == 0 && "classification was already computed");
+		DBGLOG(DBG, "Computing classification natively");
+
+		// read the facts; op and inv are symmetric
+		bm::bvector<>::enumerator en = edb->getStorage().first();
+		bm::bvector<>::enumerator en_end = edb->getStorage().end();
+		while (en < en_end) {
+			const OrdinaryAtom& fact = reg->ogatoms.getByAddress(*en);
+			if (fact.tuple[0] == theDLLitePlugin.subID) {
+				unsigned x = getOrCreateIndex(fact.tuple[1]);
+				sub[x].set_bit(getOrCreateIndex(fact.tuple[2]));
+			} else if (fact.tuple[0] == theDLLitePlugin.opID) {
+				unsigned x = getOrCreateIndex(fact.tuple[1]);
+				unsigned y = getOrCreateIndex(fact.tuple[2]);
+				op[x].set_bit(y);
+				op[y].set_bit(x);
+			} else if (fact.tuple[0] == theDLLitePlugin.invID) {
+				unsigned x = getOrCreateIndex(fact.tuple[1]);
+				unsigned y = getOrCreateIndex(fact.tuple[2]);
+				inv[x].set_bit(y);
+				inv[y].set_bit(x);
+			} else if (fact.tuple[0] == theDLLitePlugin.functID) {
+				funct.set_bit(getOrCreateIndex(fact.tuple[1]));
+			} else {
+				assert(false && "unexpected fact in the input of the classification");
+			}
+			en++;
+		}
+
+		// transitivity and contraposition until fixpoint
+		do {
+			closeSub();
+		} while (contrapose());
+
+		// subsumees are needed for the second conflict rule
+		computeSubsumees();
+
+		const unsigned n = terms.size();
+		for (unsigned x = 0; x < n; ++x) {
+			// conf(X,Y1) :- sub(X,Y), op(Y,Y1).
+			Row direct;
+			Row::enumerator eny = sub[x].first();
+			Row::enumerator eny_end = sub[x].end();
+			while (eny < eny_end) {
+				direct |= op[*eny];
+				eny++;
+			}
+
+			// conf(X,Y2) :- conf(X,Y1), sub(Y2,Y1).
+			conf[x] = direct;
+			Row::enumerator eny1 = direct.first();
+			Row::enumerator eny1_end = direct.end();
+			while (eny1 < eny1_end) {
+				conf[x] |= subsumees[*eny1];
+				eny1++;
+			}
+
+			// confref(X) :- conf(X,Y), inv(X,Y).
+			if (bm::count_and(conf[x], inv[x]) > 0) confref.set_bit(x);
+		}
+
+		DBGLOG(DBG, "Native classification: " << n << " terms");
+	}
+
+	void ClassificationIndex::load(InterpretationConstPtr classification) {
+
+		assert(terms.size() == 0 && "classification was already computed");
+
+		bm::bvector<>::enumerator en = classification->getStorage().first();
+		bm::bvector<>::enumerator en_end = classification->getStorage().end();
+		while (en < en_end) {
+			const OrdinaryAtom& fact = reg->ogatoms.getByAddress(*en);
+			if (fact.tuple.size() == 3) {
+				unsigned x = getOrCreateIndex(fact.tuple[1]);
+				unsigned y = getOrCreateIndex(fact.tuple[2]);
+				if (fact.tuple[0] == theDLLitePlugin.subID) sub[x].set_bit(y);
+				else if (fact.tuple[0] == theDLLitePlugin.opID) op[x].set_bit(y);
+				else if (fact.tuple[0] == theDLLitePlugin.invID) inv[x].set_bit(y);
+				else if (fact.tuple[0] == theDLLitePlugin.confID) conf[x].set_bit(y);
+			} else if (fact.tuple.size() == 2) {
+				unsigned x = getOrCreateIndex(fact.tuple[1]);
+				if (fact.tuple[0] == theDLLitePlugin.confrefID) confref.set_bit(x);
+				else if (fact.tuple[0] == theDLLitePlugin.functID) funct.set_bit(x);
+			}
+			en++;
+		}
+
+		computeSubsumees();
+	}
+
+	void ClassificationIndex::addFact(InterpretationPtr intr, ID pred, unsigned x, unsigned y) const {
+		OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+		fact.tuple.push_back(pred);
+		fact.tuple.push_back(terms[x]);
+		if (y != npos) fact.tuple.push_back(terms[y]);
+		intr->setFact(reg->storeOrdinaryAtom(fact).address);
+	}
+
+	InterpretationPtr ClassificationIndex::getInterpretation() const {
+
+		InterpretationPtr intr(new Interpretation(reg));
+		const unsigned n = terms.size();
+		for (unsigned x = 0; x < n; ++x) {
+			const Row* rows[] = { &sub[x], &op[x], &inv[x], &conf[x] };
+			ID preds[] = { theDLLitePlugin.subID, theDLLitePlugin.opID, theDLLitePlugin.invID, theDLLitePlugin.confID };
+			for (int r = 0; r < 4; ++r) {
+				Row::enumerator eny = rows[r]->first();
+				Row::enumerator eny_end = rows[r]->end();
+				while (eny < eny_end) {
+					addFact(intr, preds[r], x, *eny);
+					eny++;
+				}
+			}
+			if (confref.get_bit(x)) addFact(intr, theDLLitePlugin.confrefID, x, npos);
+			if (funct.get_bit(x)) addFact(intr, theDLLitePlugin.functID, x, npos);
+		}
+		return intr;
+	}
+
+	bool ClassificationIndex::isSub(ID x, ID y) const {
+		unsigned ix = getIndex(x), iy = getIndex(y);
+		return ix != npos && iy != npos && sub[ix].get_bit(iy);
+	}
+
+	bool ClassificationIndex::isConf(ID x, ID y) const {
+		unsigned ix = getIndex(x), iy = getIndex(y);
+		return ix != npos && iy != npos && conf[ix].get_bit(iy);
+	}
+
+	bool ClassificationIndex::isInv(ID x, ID y) const {
+		unsigned ix = getIndex(x), iy = getIndex(y);
+		return ix != npos && iy != npos && inv[ix].get_bit(iy);
+	}
+
+	bool ClassificationIndex::isConfref(ID x) const {
+		unsigned ix = getIndex(x);
+		return ix != npos && confref.get_bit(ix);
+	}
+
+	bool ClassificationIndex::isFunct(ID x) const {
+		unsigned ix = getIndex(x);
+		return ix != npos && funct.get_bit(ix);
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
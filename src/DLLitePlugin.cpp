@@ -38,6 +38,7 @@
 #include "ExternalAtoms.h"
 #include "DLRewriter.h"
 #include "RepairModelGenerator.h"
+#include "NativeReasoner.h"
 #include "dlvhex2/PlatformDefinitions.h"
 #include "dlvhex2/ProgramCtx.h"
 #include "dlvhex2/Registry.h"
@@ -45,17 +46,21 @@
 #include "dlvhex2/Printhelpers.h"
 #include "dlvhex2/Logger.h"
 #include "dlvhex2/ExternalLearningHelper.h"
+#include "dlvhex2/Benchmarking.h"
 #include <sstream>
 #include <iostream>
 #include <string>
 #include <algorithm>
 #include <map>
+#include <set>
 
 #include <boost/lexical_cast.hpp>
 #include "boost/program_options.hpp"
 #include "boost/range.hpp"
 #include "boost/foreach.hpp"
 #include "boost/filesystem.hpp"
+#include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "owlcpp/rdf/triple_store.hpp"
 #include "owlcpp/rdf/query_triples.hpp"
@@ -88,7 +93,14 @@ namespace dllite {
 
 	DLLitePlugin::CachedOntology::CachedOntology(RegistryPtr reg) : reg(reg) {
 		loaded = false;
+		reasonerLoaded = false;
+		functionalRoles = false;
+		triplesRead = false;
+		kernelConsistent = -1;
 		kernel = ReasoningKernelPtr(new ReasoningKernel());
+		maxKernels = 1;
+		kernelCount = 1;
+		idleKernels.push_back(PooledKernelPtr(new PooledKernel(kernel)));
 	}
 
 	DLLitePlugin::CachedOntology::~CachedOntology() {
@@ -101,10 +113,48 @@ namespace dllite {
 		DBGLOG(DBG, "Assigning ontology name");
 		this->ontologyName = ontologyName;
 		this->includeAbox = includeAbox;
-		// load and prepare the ontology here
+
+		// try to restore the derived information from a previous run;
+		// the reasoning kernel is then only filled when it is actually needed
+		if (snapshotDir != "") {
+			fileHash = computeFileHash(reg->terms.getByID(ontologyName).getUnquotedString());
+			if (fileHash != "" && restoreSnapshot()) {
+				DBGLOG(DBG, "Restored ontology from snapshot " << getSnapshotFile());
+				loaded = true;
+				return;
+			}
+		}
+
+		// load the file, fill the reasoning kernel and compute some meta-information in a single pass
+		readOntologyFile();
+		scanTriples(true);
+
+		loaded = true;
+
+		if (snapshotDir != "" && fileHash != "") saveSnapshot();
+	}
+
+	void DLLitePlugin::CachedOntology::loadReasoner() {
+
+		if (reasonerLoaded) return;
+
+		// the meta-information was restored from a snapshot, thus we only need to fill the kernel;
+		// the owl-file is only read again if the snapshot does not capture the whole Tbox
+		if (!!tboxAxioms) {
+			fillKernel(*kernel);
+			reasonerLoaded = true;
+			return;
+		}
+		readOntologyFile();
+		scanTriples(false);
+	}
+
+	void DLLitePlugin::CachedOntology::readOntologyFile() {
+
 		try {
 			DBGLOG(DBG, "Reading file " << reg->terms.getByID(ontologyName).getUnquotedString());
 			load_file(reg->terms.getByID(ontologyName).getUnquotedString(), store);
+			triplesRead = true;
 
 			DBGLOG(DBG, "Extracting ontology namespace");
 			owlcpp::Catalog cat;
@@ -118,159 +168,586 @@ namespace dllite {
 			}
 			DBGLOG(DBG, "Namespace is: " << ontologyNamespace << " (path: " << ontologyPath << ", version: " << ontologyVersion << ")");
 			assert(oCount == 1 && "The file should contain exactly one ontology");
+		} catch(...) {
+			throw PluginError("DLLite reasoner failed while loading file \"" + reg->terms.getByID(ontologyName).getUnquotedString() + "\", ensure that it is a consistent valid ontology");
+		}
+	}
+
+	namespace {
+		// kinds of triple predicates resp. of objects of rdf:type triples which are relevant for the analysis of an ontology
+		enum PredicateKind { PredOther, PredType, PredSubClassOf, PredSubPropertyOf, PredDisjointWith, PredComplementOf, PredPropertyDisjointWith, PredDomain, PredOnProperty, PredInverseOf, PredSomeValuesFrom, PredAnnotation };
+		enum TypeKind { TypeOther, TypeClass, TypeObjectProperty, TypeAnnotationProperty, TypeThing, TypeNamedIndividual, TypeFunctionalProperty, TypeOntology, TypeRestriction };
+
+		// maps the owlcpp node IDs of the standard vocabulary to the kinds above
+		class DispatchTable {
+		private:
+			boost::unordered_map<owlcpp::Node_id, PredicateKind> predicates;
+			boost::unordered_map<owlcpp::Node_id, TypeKind> types;
 
+		public:
+			DispatchTable() {
+				predicates[owlcpp::terms::rdf_type::id()] = PredType;
+				predicates[owlcpp::terms::rdfs_subClassOf::id()] = PredSubClassOf;
+				predicates[owlcpp::terms::rdfs_subPropertyOf::id()] = PredSubPropertyOf;
+				predicates[owlcpp::terms::owl_disjointWith::id()] = PredDisjointWith;
+				predicates[owlcpp::terms::owl_complementOf::id()] = PredComplementOf;
+				predicates[owlcpp::terms::owl_propertyDisjointWith::id()] = PredPropertyDisjointWith;
+				predicates[owlcpp::terms::rdfs_domain::id()] = PredDomain;
+				predicates[owlcpp::terms::owl_onProperty::id()] = PredOnProperty;
+				predicates[owlcpp::terms::owl_inverseOf::id()] = PredInverseOf;
+				predicates[owlcpp::terms::owl_someValuesFrom::id()] = PredSomeValuesFrom;
+				predicates[owlcpp::terms::rdfs_label::id()] = PredAnnotation;
+				predicates[owlcpp::terms::rdfs_comment::id()] = PredAnnotation;
+				predicates[owlcpp::terms::owl_versionInfo::id()] = PredAnnotation;
+				predicates[owlcpp::terms::owl_versionIRI::id()] = PredAnnotation;
+
+				types[owlcpp::terms::owl_Class::id()] = TypeClass;
+				types[owlcpp::terms::owl_ObjectProperty::id()] = TypeObjectProperty;
+				types[owlcpp::terms::owl_AnnotationProperty::id()] = TypeAnnotationProperty;
+				types[owlcpp::terms::owl_Thing::id()] = TypeThing;
+				types[owlcpp::terms::owl_NamedIndividual::id()] = TypeNamedIndividual;
+				types[owlcpp::terms::owl_FunctionalProperty::id()] = TypeFunctionalProperty;
+				types[owlcpp::terms::owl_Ontology::id()] = TypeOntology;
+				types[owlcpp::terms::owl_Restriction::id()] = TypeRestriction;
+			}
+
+			PredicateKind getPredicateKind(owlcpp::Node_id id) const {
+				boost::unordered_map<owlcpp::Node_id, PredicateKind>::const_iterator it = predicates.find(id);
+				return it == predicates.end() ? PredOther : it->second;
+			}
+
+			TypeKind getTypeKind(owlcpp::Node_id id) const {
+				boost::unordered_map<owlcpp::Node_id, TypeKind>::const_iterator it = types.find(id);
+				return it == types.end() ? TypeOther : it->second;
+			}
+
+			static const DispatchTable& instance() {
+				static DispatchTable table;
+				return table;
+			}
+		};
+
+		// classifies the nodes of a triple store, such that each node is translated to a string at most twice
+		// (once for the classification and once for the registry term)
+		class NodeCache {
+		private:
+			struct Info {
+				bool constant;	// see CachedOntology::isOwlConstant
+				bool domainRestriction;	// anonymous node which describes a domain restriction
+				ID term;	// registry term (without namespace), created on demand
+			};
+			const owlcpp::Triple_store& store;
+			const DLLitePlugin::CachedOntology& ontology;
+			boost::unordered_map<owlcpp::Node_id, Info> infos;
+
+			Info& get(owlcpp::Node_id id) {
+				boost::unordered_map<owlcpp::Node_id, Info>::iterator it = infos.find(id);
+				if (it == infos.end()) {
+					std::string str = to_string(id, store);
+					Info info;
+					info.constant = ontology.isOwlConstant(str);
+					info.domainRestriction = (str.find("_:Doc") != std::string::npos);
+					info.term = ID_FAIL;
+					it = infos.insert(std::make_pair(id, info)).first;
+				}
+				return it->second;
+			}
+
+		public:
+			NodeCache(const owlcpp::Triple_store& store, const DLLitePlugin::CachedOntology& ontology) : store(store), ontology(ontology) {}
+
+			bool isConstant(owlcpp::Node_id id) { return get(id).constant; }
+			bool isDomainRestriction(owlcpp::Node_id id) { return get(id).domainRestriction; }
+
+			ID getTerm(owlcpp::Node_id id) {
+				Info& info = get(id);
+				if (info.term == ID_FAIL) {
+					info.term = ontology.storeQuotedConstantTerm(ontology.removeNamespaceFromString(to_string(id, store)));
+				}
+				return info.term;
+			}
+		};
+
+		void addClassificationFact(RegistryPtr reg, InterpretationPtr edb, ID pred, ID arg1, ID arg2 = ID_FAIL) {
+			OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+			fact.tuple.push_back(pred);
+			fact.tuple.push_back(arg1);
+			if (arg2 != ID_FAIL) fact.tuple.push_back(arg2);
+			edb->setFact(reg->storeOrdinaryAtom(fact).address);
+		}
+	}
+
+	void DLLitePlugin::CachedOntology::scanTriples(bool analyze) {
+
+		assert(!!reg && "registry must be set before scanTriples is called");
+		assert(CheckPredefinedIDs && "IDs are not initialized");
+		assert((!analyze || !concepts) && "ontology must be analyzed only once");
+
+		DBGLOG(DBG, "Scanning triples" << (analyze ? " and analyzing ontology (Tbox and Abox)" : ""));
+		if (analyze) {
+			concepts = InterpretationPtr(new Interpretation(reg));
+			roles = InterpretationPtr(new Interpretation(reg));
+			individuals = InterpretationPtr(new Interpretation(reg));
+			conceptAssertions = InterpretationPtr(new Interpretation(reg));
+			roleAssertions.clear();
+			roleAssertionIndex.clear();
+		}
+
+		// input of the classification program (only needed if it was not restored from a snapshot); if it captures
+		// every Tbox triple, it is kept as tboxAxioms, from which kernels can be filled without reading the file again
+		InterpretationPtr edb;
+		if (!classification) edb = InterpretationPtr(new Interpretation(reg));
+		bool tboxCaptured = true;
+
+		// structures for storing domain restrictions
+		std::map<owlcpp::Node_id, owlcpp::Node_id> domainRestr;
+		std::map<owlcpp::Node_id, owlcpp::Node_id> onProp;
+
+		std::set<ID> aboxPredicatesSet(AboxPredicates.begin(), AboxPredicates.end());
+		const DispatchTable& dispatch = DispatchTable::instance();
+		NodeCache nodes(store, *this);
+
+		try {
 			DBGLOG(DBG, "Submitting ontology " << (includeAbox ? "with" : "without") << " Abox to reasoning kernel");
+			boost::scoped_ptr<owlcpp::logic::factpp::Adaptor_triple> at;
 			if (includeAbox) {
 				submit(store, *kernel, true);
 			} else {
 				// submit all triples separately, but skip Abox assertions
-				owlcpp::logic::factpp::Adaptor_triple at(store, *kernel, true);
-				BOOST_FOREACH(owlcpp::Triple const& t, store.map_triple()) {
-					std::string subj = to_string(t.subj_, store);
-					std::string obj = to_string(t.obj_, store);
-					std::string pred = to_string(t.pred_, store);
-
-					DBGLOG(DBG, "Current triple: " << subj << " / " << pred << " / " << obj);
-					if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "type") && isOwlConstant(obj)) {
-						ID conceptID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj));
-						DBGLOG(DBG, "Skipping concept assertion");
-						continue;
-					} else if (isOwlConstant(subj) && isOwlConstant(pred) && isOwlConstant(obj)) {
-						ID roleID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(pred));
-						continue;
+				at.reset(new owlcpp::logic::factpp::Adaptor_triple(store, *kernel, true));
+			}
+
+			BOOST_FOREACH(owlcpp::Triple const& t, store.map_triple()) {
+				DBGLOG(DBG, "Current triple: " << to_string(t.subj_, store) << " / " << to_string(t.pred_, store) << " / " << to_string(t.obj_, store));
+
+				PredicateKind predKind = dispatch.getPredicateKind(t.pred_);
+				TypeKind typeKind = (predKind == PredType ? dispatch.getTypeKind(t.obj_) : TypeOther);
+				bool subjConstant = nodes.isConstant(t.subj_);
+				bool objConstant = nodes.isConstant(t.obj_);
+
+				// Abox assertions
+				bool conceptAssertion = (subjConstant && predKind == PredType && objConstant);
+				bool roleAssertion = (subjConstant && objConstant && nodes.isConstant(t.pred_));
+				if (!includeAbox) {
+					if (conceptAssertion || roleAssertion) {
+						DBGLOG(DBG, "Skipping Abox assertion");
 					} else {
 						DBGLOG(DBG, "Submitting triple");
 						try {
-							at.submit(t);
+							at->submit(t);
 						} catch(owlcpp::Logic_err const&) {
 							throw PluginError("Error while sending ontology without Abox to FaCT++");
 						}
 					}
 				}
+
+				if (typeKind == TypeFunctionalProperty) functionalRoles = true;
+
+				if (analyze) {
+					if (subjConstant && (typeKind == TypeClass)) {
+						// concept definition
+						ID conceptID = nodes.getTerm(t.subj_);
+						DBGLOG(DBG, "Found concept: " << RawPrinter::toString(reg, conceptID));
+						concepts->setFact(conceptID.address);
+					}
+					if (subjConstant && (typeKind == TypeObjectProperty || typeKind == TypeAnnotationProperty)) {
+						// role definition
+						ID roleID = nodes.getTerm(t.subj_);
+						DBGLOG(DBG, "Found role: " << RawPrinter::toString(reg, roleID));
+						roles->setFact(roleID.address);
+					}
+					if (subjConstant && (typeKind == TypeThing || typeKind == TypeNamedIndividual)) {
+						// individual definition
+						individuals->setFact(nodes.getTerm(t.subj_).address);
+					}
+					if (conceptAssertion) {
+						ID conceptID = nodes.getTerm(t.obj_);
+						ID individualID = nodes.getTerm(t.subj_);
+						OrdinaryAtom guard = theDLLitePlugin.getNewGuardAtom(true /* ground! */);
+						guard.tuple.push_back(conceptID);
+						guard.tuple.push_back(individualID);
+						ID guardAtomID = reg->storeOrdinaryAtom(guard);
+						conceptAssertions->setFact(guardAtomID.address);
+						if (aboxPredicatesSet.insert(conceptID).second) {
+							AboxPredicates.push_back(conceptID);
+						}
+						DBGLOG(DBG, "NS: Found concept assertion: " << theDLLitePlugin.printGuardAtom(guardAtomID));
+						individuals->setFact(individualID.address);
+					}
+					if (roleAssertion) {
+						ID roleID = nodes.getTerm(t.pred_);
+						ID individual1ID = nodes.getTerm(t.subj_);
+						ID individual2ID = nodes.getTerm(t.obj_);
+						if (aboxPredicatesSet.insert(roleID).second) {
+							AboxPredicates.push_back(roleID);
+						}
+						DBGLOG(DBG, "Found role assertion: " << RawPrinter::toString(reg, roleID) << "(" << RawPrinter::toString(reg, individual1ID) << "," << RawPrinter::toString(reg, individual2ID) << ")");
+						roleAssertions.push_back(
+								RoleAssertion(
+										roleID,
+										std::pair<ID, ID>(
+												individual1ID,
+												individual2ID )));
+						roleAssertionIndex.add(roleID, individual1ID, individual2ID);
+					}
+				}
+
+				if (!edb) continue;
+
+				// construct the input of the classification program
+				switch (predKind) {
+				case PredType:
+					if (conceptAssertion || typeKind == TypeOntology || typeKind == TypeRestriction) break;
+					if (!subjConstant || typeKind == TypeOther) {
+						tboxCaptured = false;
+						break;
+					}
+					if (typeKind == TypeClass) {
+						DBGLOG(DBG,"Construct facts of the form op(C,negC), sub(C,C) for this class.");
+						ID c = nodes.getTerm(t.subj_);
+						addClassificationFact(reg, edb, theDLLitePlugin.opID, c, theDLLitePlugin.dlNeg(c));
+						addClassificationFact(reg, edb, theDLLitePlugin.subID, c, c);
+					} else if (typeKind == TypeObjectProperty) {
+						DBGLOG(DBG,"Construct facts of the form op(Subj,negSubj), sub(Subj,Subj), op(exSubj,negexSubj), sub(exSubj,exSubj)");
+						ID r = nodes.getTerm(t.subj_);
+						ID exr = theDLLitePlugin.dlEx(r);
+						addClassificationFact(reg, edb, theDLLitePlugin.opID, r, theDLLitePlugin.dlNeg(r));
+						addClassificationFact(reg, edb, theDLLitePlugin.subID, r, r);
+						addClassificationFact(reg, edb, theDLLitePlugin.opID, exr, theDLLitePlugin.dlNeg(exr));
+						addClassificationFact(reg, edb, theDLLitePlugin.subID, exr, exr);
+					} else if (typeKind == TypeFunctionalProperty) {
+						DBGLOG(DBG,"Construct facts of the form funct(subj)");
+						addClassificationFact(reg, edb, theDLLitePlugin.functID, nodes.getTerm(t.subj_));
+					}
+					break;
+				case PredSubClassOf:
+					if (!subjConstant || !objConstant) {
+						tboxCaptured = false;
+						break;
+					}
+					if (nodes.isDomainRestriction(t.obj_)) {
+						// resolved after all triples have been seen
+						domainRestr[t.subj_] = t.obj_;
+					} else {
+						addClassificationFact(reg, edb, theDLLitePlugin.subID, nodes.getTerm(t.subj_), nodes.getTerm(t.obj_));
+					}
+					break;
+				case PredOnProperty:
+					onProp[t.subj_] = t.obj_;
+					break;
+				case PredSomeValuesFrom:
+					// only unqualified existential restrictions are part of the classification program
+					if (t.obj_ != owlcpp::terms::owl_Thing::id()) tboxCaptured = false;
+					break;
+				case PredAnnotation:
+					break;
+				case PredSubPropertyOf:
+					if (!subjConstant || !objConstant) {
+						tboxCaptured = false;
+						break;
+					}
+					DBGLOG(DBG,"Construct facts of the form sub(Subj,Obj)");
+					addClassificationFact(reg, edb, theDLLitePlugin.subID, nodes.getTerm(t.subj_), nodes.getTerm(t.obj_));
+					break;
+				case PredDisjointWith:
+				case PredPropertyDisjointWith:
+					if (!subjConstant || !objConstant) {
+						tboxCaptured = false;
+						break;
+					}
+					DBGLOG(DBG,"Construct facts of the form sub(Subj,negObj)");
+					addClassificationFact(reg, edb, theDLLitePlugin.subID, nodes.getTerm(t.subj_), theDLLitePlugin.dlNeg(nodes.getTerm(t.obj_)));
+					break;
+				case PredComplementOf:
+					if (!subjConstant || !objConstant) {
+						tboxCaptured = false;
+						break;
+					}
+					DBGLOG(DBG,"Construct facts of the form op(Subj,Obj)");
+					addClassificationFact(reg, edb, theDLLitePlugin.opID, nodes.getTerm(t.subj_), nodes.getTerm(t.obj_));
+					break;
+				case PredDomain:
+					if (!subjConstant || !objConstant) {
+						tboxCaptured = false;
+						break;
+					}
+					DBGLOG(DBG,"Construct facts of the form sub(exSubj,Obj)");
+					addClassificationFact(reg, edb, theDLLitePlugin.subID, theDLLitePlugin.dlEx(nodes.getTerm(t.subj_)), nodes.getTerm(t.obj_));
+					break;
+				case PredInverseOf:
+					if (!subjConstant || !objConstant) {
+						tboxCaptured = false;
+						break;
+					}
+					DBGLOG(DBG,"Construct facts of the form inv(Subj,Obj)");
+					addClassificationFact(reg, edb, theDLLitePlugin.invID, nodes.getTerm(t.subj_), nodes.getTerm(t.obj_));
+					break;
+				default:
+					if (!roleAssertion) tboxCaptured = false;
+					break;
+				}
 			}
 
+			if (functionalRoles && individuals->getStorage().count() > 1) assertUniqueNames(*kernel, individuals->getStorage());
+
 			DBGLOG(DBG, "Consistency of KB: " << kernel->isKBConsistent());
+		} catch(const PluginError&) {
+			throw;
 		} catch(...) {
 			throw PluginError("DLLite reasoner failed while loading file \"" + reg->terms.getByID(ontologyName).getUnquotedString() + "\", ensure that it is a consistent valid ontology");
 		}
+		reasonerLoaded = true;
+
+		if (!!edb) {
+			DBGLOG(DBG,"Checking if there are any domain restrictions on properties");
+			typedef std::pair<owlcpp::Node_id, owlcpp::Node_id> NodePair;
+			BOOST_FOREACH (NodePair restr, domainRestr) {
+				std::map<owlcpp::Node_id, owlcpp::Node_id>::const_iterator prop = onProp.find(restr.second);
+				if (prop != onProp.end()) {
+					DBGLOG(DBG,"Construct facts of the form sub(Subj,exObj)");
+					addClassificationFact(reg, edb, theDLLitePlugin.subID, nodes.getTerm(restr.first), theDLLitePlugin.dlEx(nodes.getTerm(prop->second)));
+				} else {
+					tboxCaptured = false;
+				}
+			}
+			DBGLOG(DBG, "CLP: EDB of classification program: " << *edb);
+			tboxFacts = edb;
+			if (analyze && tboxCaptured) tboxAxioms = edb;
+			DBGLOG(DBG, "Tbox is " << (tboxCaptured ? "" : "not ") << "fully captured by the classification program");
+		}
+
+		if (analyze) {
+			roleAssertionIndex.finalize();
+			DBGLOG(DBG, "Concept assertions: " << *conceptAssertions);
+			DBGLOG(DBG, roleAssertionIndex.size() << " distinct role assertions");
+		}
+	}
 
-		// now compute some meta-information
-		analyzeTboxAndAbox();
+	void DLLitePlugin::CachedOntology::submitTriples(ReasoningKernel& k) {
 
-		loaded = true;
+		// the triple store is only read, thus this can run while other kernels of the pool are queried
+		if (!triplesRead) {
+			fillKernel(k);
+			return;
+		}
+		try {
+			if (includeAbox) {
+				submit(store, k, true);
+			} else {
+				// skip Abox assertions as in scanTriples
+				owlcpp::logic::factpp::Adaptor_triple at(store, k, true);
+				const DispatchTable& dispatch = DispatchTable::instance();
+				NodeCache nodes(store, *this);
+				BOOST_FOREACH(owlcpp::Triple const& t, store.map_triple()) {
+					bool subjConstant = nodes.isConstant(t.subj_);
+					bool objConstant = nodes.isConstant(t.obj_);
+					bool conceptAssertion = (subjConstant && dispatch.getPredicateKind(t.pred_) == PredType && objConstant);
+					bool roleAssertion = (subjConstant && objConstant && nodes.isConstant(t.pred_));
+					if (!conceptAssertion && !roleAssertion) at.submit(t);
+				}
+			}
+			if (functionalRoles && individuals->getStorage().count() > 1) assertUniqueNames(k, individuals->getStorage());
+		} catch(...) {
+			throw PluginError("DLLite reasoner failed while filling a further kernel for \"" + reg->terms.getByID(ontologyName).getUnquotedString() + "\"");
+		}
 	}
 
-	void DLLitePlugin::CachedOntology::analyzeTboxAndAbox() {
+	TDLObjectRoleExpression* DLLitePlugin::CachedOntology::getAxiomRole(ReasoningKernel& k, ID role) const {
 
-		assert(!concepts && "analyzeTboxAndAbox must be called only once");
-		assert(!!reg && "registry must be set before analyzeTboxAndAbox is called");
-		assert(CheckPredefinedIDs && "IDs are not initialized");
+		// Inv:R is the inverse of R
+		if (theDLLitePlugin.isDlInv(role)) return k.getExpressionManager()->Inverse(getAxiomRole(k, theDLLitePlugin.dlRemoveInv(role)));
+		return k.getExpressionManager()->ObjectRole(addNamespaceToString(reg->terms.getByID(role).getUnquotedString()));
+	}
 
-		DBGLOG(DBG, "Analyzing ontology (Tbox and Abox)");
-		concepts = InterpretationPtr(new Interpretation(reg));
-		roles = InterpretationPtr(new Interpretation(reg));
-		individuals = InterpretationPtr(new Interpretation(reg));
-		conceptAssertions = InterpretationPtr(new Interpretation(reg));
+	TDLConceptExpression* DLLitePlugin::CachedOntology::getAxiomConcept(ReasoningKernel& k, ID concept) const {
 
-		BOOST_FOREACH(owlcpp::Triple const& t, store.map_triple()) {
-			std::string subj = to_string(t.subj_, store);
-			std::string obj = to_string(t.obj_, store);
-			std::string pred = to_string(t.pred_, store);
+		// -C is the complement of C and Ex:R the unqualified existential restriction of R
+		if (theDLLitePlugin.isDlNeg(concept)) return k.getExpressionManager()->Not(getAxiomConcept(k, theDLLitePlugin.dlNeg(concept)));
+		if (theDLLitePlugin.isDlEx(concept)) return k.getExpressionManager()->Exists(getAxiomRole(k, theDLLitePlugin.dlRemoveEx(concept)), k.getExpressionManager()->Top());
+		return k.getExpressionManager()->Concept(addNamespaceToString(reg->terms.getByID(concept).getUnquotedString()));
+	}
 
-			DBGLOG(DBG, "Current triple: " << subj << " / " << pred << " / " << obj);
+	void DLLitePlugin::CachedOntology::fillKernel(ReasoningKernel& k) {
 
-			// concept definition
-			//DBGLOG(DBG, "Checking if this is a concept definition");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "type") && theDLLitePlugin.cmpOwlType(obj, "Class")) {
-				//	DBGLOG(DBG, "Yes");
-				ID conceptID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj));
-#ifndef NDEBUG
-				std::string conceptStr = RawPrinter::toString(reg, conceptID);
-				DBGLOG(DBG, "Found concept: " << conceptStr);
-#endif
-				concepts->setFact(conceptID.address);
-			} else {
-				//	DBGLOG(DBG, "No");
-			}
+		assert(!!tboxAxioms && "kernels can only be filled without the owl-file if the Tbox was captured");
+		DBGLOG(DBG, "Filling reasoning kernel from the Tbox axioms and the Abox of the snapshot");
+		try {
+			TExpressionManager* em = k.getExpressionManager();
 
-			// role definition
-			//DBGLOG(DBG, "Checking if this is a role definition");
-			if (isOwlConstant(to_string(t.subj_, store)) && theDLLitePlugin.cmpOwlType(pred, "type") && (theDLLitePlugin.cmpOwlType(obj, "ObjectProperty")||theDLLitePlugin.cmpOwlType(obj, "AnnotationProperty"))) {
-				//DBGLOG(DBG, "Yes");
-				ID roleID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj));
-#ifndef NDEBUG
-				std::string roleStr = RawPrinter::toString(reg, roleID);
-				DBGLOG(DBG, "Found role: " << roleStr);
-#endif
-				roles->setFact(roleID.address);
-			} else {
-				//DBGLOG(DBG, "No");
+			// Tbox (the input of the classification program, where op(X,-X) and sub(X,X) only declare X)
+			bm::bvector<>::enumerator en = tboxAxioms->getStorage().first();
+			bm::bvector<>::enumerator en_end = tboxAxioms->getStorage().end();
+			while (en < en_end) {
+				const OrdinaryAtom& fact = reg->ogatoms.getByAddress(*en);
+				en++;
+				if (fact.tuple[0] == theDLLitePlugin.functID) {
+					k.setOFunctional(getAxiomRole(k, fact.tuple[1]));
+				} else if (fact.tuple[0] == theDLLitePlugin.invID) {
+					k.setInverseRoles(getAxiomRole(k, fact.tuple[1]), getAxiomRole(k, fact.tuple[2]));
+				} else if (fact.tuple[0] == theDLLitePlugin.opID) {
+					if (fact.tuple[2] == theDLLitePlugin.dlNeg(fact.tuple[1])) {
+						if (roles->getFact(fact.tuple[1].address)) k.declare(getAxiomRole(k, fact.tuple[1]));
+						else if (!theDLLitePlugin.isDlEx(fact.tuple[1])) k.declare(getAxiomConcept(k, fact.tuple[1]));
+					} else {
+						em->newArgList();
+						em->addArg(getAxiomConcept(k, fact.tuple[1]));
+						em->addArg(em->Not(getAxiomConcept(k, fact.tuple[2])));
+						k.equalConcepts();
+					}
+				} else if (fact.tuple[0] == theDLLitePlugin.subID && fact.tuple[1] != fact.tuple[2]) {
+					if (!roles->getFact(fact.tuple[1].address)) {
+						k.impliesConcepts(getAxiomConcept(k, fact.tuple[1]), getAxiomConcept(k, fact.tuple[2]));
+					} else if (theDLLitePlugin.isDlNeg(fact.tuple[2])) {
+						em->newArgList();
+						em->addArg(getAxiomRole(k, fact.tuple[1]));
+						em->addArg(getAxiomRole(k, theDLLitePlugin.dlNeg(fact.tuple[2])));
+						k.disjointORoles();
+					} else {
+						k.impliesORoles(getAxiomRole(k, fact.tuple[1]), getAxiomRole(k, fact.tuple[2]));
+					}
+				}
 			}
 
-			// concept assertion
-			//DBGLOG(DBG, "Checking if this is a concept assertion");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "type") && isOwlConstant(obj)) {
-				//DBGLOG(DBG, "Yes");
-				ID conceptID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj));
-				DBGLOG(DBG, "NS: Subject is: " << subj);
-				ID individualID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj));
-				DBGLOG(DBG, "NS: After storage: " << subj);
-				OrdinaryAtom guard = theDLLitePlugin.getNewGuardAtom(true /* ground! */);
-				guard.tuple.push_back(conceptID);
-				guard.tuple.push_back(individualID);
-				ID guardAtomID = reg->storeOrdinaryAtom(guard);
-				conceptAssertions->setFact(guardAtomID.address);
-				if (std::find(AboxPredicates.begin(), AboxPredicates.end(), conceptID) == AboxPredicates.end()) {
-					AboxPredicates.push_back(conceptID);
+			// individuals (declared also without Abox, as by the triples) and assertions
+			en = individuals->getStorage().first();
+			en_end = individuals->getStorage().end();
+			while (en < en_end) {
+				k.declare(em->Individual(addNamespaceToString(reg->terms.getByID(reg->terms.getIDByAddress(*en)).getUnquotedString())));
+				en++;
+			}
+			if (includeAbox) {
+				en = conceptAssertions->getStorage().first();
+				en_end = conceptAssertions->getStorage().end();
+				while (en < en_end) {
+					const OrdinaryAtom& guard = reg->ogatoms.getByAddress(*en);
+					k.instanceOf(em->Individual(addNamespaceToString(reg->terms.getByID(guard.tuple[2]).getUnquotedString())), getAxiomConcept(k, guard.tuple[1]));
+					en++;
+				}
+				BOOST_FOREACH (const RoleAssertion& ra, roleAssertions) {
+					k.relatedTo(em->Individual(addNamespaceToString(reg->terms.getByID(ra.second.first).getUnquotedString())), getAxiomRole(k, ra.first),
+							em->Individual(addNamespaceToString(reg->terms.getByID(ra.second.second).getUnquotedString())));
 				}
-
-#ifndef NDEBUG
-				std::string individualStr = RawPrinter::toString(reg, individualID);
-				std::string conceptAssertionStr = theDLLitePlugin.printGuardAtom(guardAtomID);
-				DBGLOG(DBG, "NS: Found individual: " << individualStr);
-				DBGLOG(DBG, "NS: Found concept assertion: " << conceptAssertionStr);
-#endif
-				individuals->setFact(individualID.address);
-			} else {
-				//DBGLOG(DBG, "No");
 			}
+			if (functionalRoles && individuals->getStorage().count() > 1) assertUniqueNames(k, individuals->getStorage());
+		} catch(...) {
+			throw PluginError("DLLite reasoner failed while filling a kernel for \"" + reg->terms.getByID(ontologyName).getUnquotedString() + "\" from its snapshot");
+		}
+	}
 
-			// role assertion
-			//DBGLOG(DBG, "Checking if this is a role assertion");
-			if (isOwlConstant(subj) && isOwlConstant(pred) && isOwlConstant(obj)) {
-				//DBGLOG(DBG, "Yes");
-				ID roleID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(pred));
-				ID individual1ID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj));
-				ID individual2ID = theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj));
-				if (std::find(AboxPredicates.begin(), AboxPredicates.end(), roleID) == AboxPredicates.end()) {
-					AboxPredicates.push_back(roleID);
-				}
+	TDLAxiom* DLLitePlugin::CachedOntology::assertUniqueNames(ReasoningKernel& k, const bm::bvector<>& names) const {
 
-#ifndef NDEBUG
-				std::string roleAssertionStr = RawPrinter::toString(reg, roleID) + "(" + RawPrinter::toString(reg, individual1ID) + "," + RawPrinter::toString(reg, individual2ID) + ")";
-				DBGLOG(DBG, "Found role assertion: " << roleAssertionStr);
-#endif
-				roleAssertions.push_back(
-						RoleAssertion(
-								roleID,
-								std::pair<ID, ID>(
-										individual1ID,
-										individual2ID )));
-			} else {
-				//	DBGLOG(DBG, "No");
-			}
+		DBGLOG(DBG, "Asserting that " << names.count() << " individuals are different");
+		k.getExpressionManager()->newArgList();
+		bm::bvector<>::enumerator en = names.first();
+		bm::bvector<>::enumerator en_end = names.end();
+		while (en < en_end) {
+			k.getExpressionManager()->addArg(k.getExpressionManager()->Individual(addNamespaceToString(reg->terms.getByID(reg->terms.getIDByAddress(*en)).getUnquotedString())));
+			en++;
+		}
+		return k.processDifferent();
+	}
 
-			// individual definition
-			//DBGLOG(DBG, "Checking if this is an individual definition");
-			if (isOwlConstant(subj) && (theDLLitePlugin.cmpOwlType(obj, "Thing")||theDLLitePlugin.cmpOwlType(obj, "NamedIndividual")) && theDLLitePlugin.cmpOwlType(pred, "type")) {
-				//	DBGLOG(DBG, "Yes");
-				individuals->setFact(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)).address);
-			} else {
-				//	DBGLOG(DBG, "No");
+	ID DLLitePlugin::CachedOntology::getTermByIri(const char* iri) {
+
+		boost::mutex::scoped_lock lock(iriMutex);
+		boost::unordered_map<std::string, ID, IriHash>::const_iterator it = termsByIri.find(iri, IriHash(), IriEqual());
+		if (it != termsByIri.end()) return it->second;
+
+		// first occurrence of the name: strip the namespace once and remember the term
+		std::string str(iri);
+		ID tid = (containsNamespace(str) ? theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(str)) : ID_FAIL);
+		termsByIri[str] = tid;
+		return tid;
+	}
+
+	// ============================== Class CachedOntology::KernelLease ==============================
+
+	DLLitePlugin::CachedOntology::KernelLease::KernelLease(CachedOntology& ontology) : ontology(ontology) {
+
+		assert(ontology.reasonerLoaded && "kernels must only be leased after the reasoner was loaded");
+		unsigned number;
+		{
+			boost::mutex::scoped_lock lock(ontology.kernelPoolMutex);
+			while (ontology.idleKernels.empty() && ontology.kernelCount >= ontology.maxKernels) ontology.kernelReleased.wait(lock);
+			if (!ontology.idleKernels.empty()) {
+				kernel = ontology.idleKernels.back();
+				ontology.idleKernels.pop_back();
+				return;
 			}
+			number = ++ontology.kernelCount;
+		}
+
+		// all kernels are in use but the pool may still grow
+		DBGLOG(DBG, "Filling reasoning kernel " << number << " of ontology " << ontology.reg->terms.getByID(ontology.ontologyName).getUnquotedString());
+		kernel = PooledKernelPtr(new PooledKernel(ReasoningKernelPtr(new ReasoningKernel())));
+		try {
+			ontology.submitTriples(*kernel->kernel);
+		} catch(...) {
+			boost::mutex::scoped_lock lock(ontology.kernelPoolMutex);
+			ontology.kernelCount--;
+			ontology.kernelReleased.notify_one();
+			throw;
+		}
+	}
+
+	DLLitePlugin::CachedOntology::KernelLease::~KernelLease() {
+
+		// the kernel is returned with the Abox of the ontology (or dropped from the pool if this fails)
+		try {
+			BOOST_FOREACH (TDLAxiom* ax, addedAxioms) kernel->kernel->retract(ax);
+		} catch(...) {
+			LOG(WARNING, "Dropping a kernel of ontology " << ontology.reg->terms.getByID(ontology.ontologyName).getUnquotedString() << " which could not be restored");
+			boost::mutex::scoped_lock lock(ontology.kernelPoolMutex);
+			ontology.kernelCount--;
+			ontology.kernelReleased.notify_one();
+			return;
 		}
+		boost::mutex::scoped_lock lock(ontology.kernelPoolMutex);
+		ontology.idleKernels.push_back(kernel);
+		ontology.kernelReleased.notify_one();
+	}
+
+	TDLConceptExpression* DLLitePlugin::CachedOntology::KernelLease::getConcept(ID concept) {
+
+		boost::unordered_map<IDAddress, TDLConceptExpression*>::const_iterator it = kernel->concepts.find(concept.address);
+		if (it != kernel->concepts.end()) return it->second;
+
+		// -C is stored as the complement of C
+		std::string name = ontology.reg->terms.getByID(concept).getUnquotedString();
+		bool negated = (name[0] == '-');
+		TDLConceptExpression* expr = kernel->kernel->getExpressionManager()->Concept(ontology.addNamespaceToString(negated ? name.substr(1) : name));
+		if (negated) expr = kernel->kernel->getExpressionManager()->Not(expr);
+		kernel->concepts[concept.address] = expr;
+		return expr;
+	}
+
+	TDLIndividualExpression* DLLitePlugin::CachedOntology::KernelLease::getIndividual(ID individual) {
 
-		DBGLOG(DBG, "Concept assertions: " << *conceptAssertions);
+		boost::unordered_map<IDAddress, TDLIndividualExpression*>::const_iterator it = kernel->individuals.find(individual.address);
+		if (it != kernel->individuals.end()) return it->second;
+
+		TDLIndividualExpression* expr = kernel->kernel->getExpressionManager()->Individual(ontology.addNamespaceToString(ontology.reg->terms.getByID(individual).getUnquotedString()));
+		kernel->individuals[individual.address] = expr;
+		return expr;
+	}
+
+	TDLObjectRoleExpression* DLLitePlugin::CachedOntology::KernelLease::getRole(ID role) {
+
+		boost::unordered_map<IDAddress, TDLObjectRoleExpression*>::const_iterator it = kernel->roles.find(role.address);
+		if (it != kernel->roles.end()) return it->second;
+
+		TDLObjectRoleExpression* expr = kernel->kernel->getExpressionManager()->ObjectRole(ontology.addNamespaceToString(ontology.reg->terms.getByID(role).getUnquotedString()));
+		kernel->roles[role.address] = expr;
+		return expr;
+	}
+
+	void DLLitePlugin::CachedOntology::KernelLease::addAxiom(TDLAxiom* axiom) {
+		addedAxioms.push_back(axiom);
+	}
+
+	void DLLitePlugin::CachedOntology::KernelLease::addUniqueNames(const bm::bvector<>& further) {
+		bm::bvector<> names = ontology.individuals->getStorage() | further;
+		if (names.count() > 1) addAxiom(ontology.assertUniqueNames(*kernel->kernel, names));
 	}
 
 #if 0
@@ -384,284 +861,74 @@ namespace dllite {
 		DBGLOG(DBG, "Computed classification " << *classification);
 #endif
 
-		// prepare data structures for the subprogram P
-		InterpretationPtr edb = InterpretationPtr(new Interpretation(reg));
-
-		// structures for storing domain restrictions
-		//	 std::vector<owlcpp::Triple> domainRestr;
-		std::map<std::string,std::string> domainRestr;
-		std::map<std::string,std::string> onProp;
-
-		// use the ontology to construct the EDB
-		BOOST_FOREACH(owlcpp::Triple const& t, store.map_triple()) {
-			std::string subj = to_string(t.subj_, store);
-			std::string obj = to_string(t.obj_, store);
-			std::string pred = to_string(t.pred_, store);
-
-			DBGLOG(DBG, "Current triple: " << subj << " / " << pred << " / " << obj);
-			//	DBGLOG(DBG, "Checking if this is a concept definition");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "type") && theDLLitePlugin.cmpOwlType(obj, "Class")) {
-				//	DBGLOG(DBG, "Yes");
-
-				// concepts should already be discovered in CachedOntology::analyzeTboxAndAbox
-				assert(concepts->getFact(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)).address) && "found a concept which was previously missed");
-
-				DBGLOG(DBG,"Construct facts of the form op(C,negC), sub(C,C) for this class.");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.opID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.dlNeg(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj))));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);;
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//		DBGLOG(DBG, "No");
-			}
-			//	DBGLOG(DBG, "Checking if this is a role definition");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "type") && theDLLitePlugin.cmpOwlType(obj, "ObjectProperty")) {
-				//		DBGLOG(DBG, "Yes");
-
-				// roles should already be discovered in CachedOntology::analyzeTboxAndAbox
-				assert(roles->getFact(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)).address) && "found a role which was previously missed");
-
-				DBGLOG(DBG,"Construct facts of the form op(Subj,negSubj), sub(Subj,Subj), op(exSubj,negexSubj), sub(exSubj,exSubj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.opID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.dlNeg(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj))));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.opID);
-					fact.tuple.push_back(theDLLitePlugin.dlEx(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj))));
-					fact.tuple.push_back(theDLLitePlugin.dlNeg(theDLLitePlugin.dlEx(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)))));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.dlEx(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj))));
-					fact.tuple.push_back(theDLLitePlugin.dlEx(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj))));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				DBGLOG(DBG, "No");
-			}
+		// the input of the classification program was collected while scanning the triples
+		if (!tboxFacts) loadReasoner();
+		assert(!!tboxFacts && "input of the classification program was not collected");
+		InterpretationPtr edb = tboxFacts;
 
-			//std::vector<owlcpp::Triple> domainRestricion;
-			//DBGLOG(DBG, "Checking if this is a concept inclusion");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "subclassOf") && isOwlConstant(obj))
-			{
-				//	DBGLOG(DBG, "Yes");
-				//	DBGLOG(DBG, "Checking if this is a domain restriction");
-				std::size_t foundobj = obj.find("_:Doc");
-				if (foundobj!=std::string::npos) {
-					//		DBGLOG(DBG, "Yes");
-					//		DBGLOG(DBG, "Store domainRestr["<<subj<<"] = "<<obj);
-					domainRestr[subj]=obj;
-				}
-				else {
-					//		DBGLOG(DBG,"No");
-					//		DBGLOG(DBG,"Construct facts of the form sub(Subj,Obj)");
-					{
-						OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-						fact.tuple.push_back(theDLLitePlugin.subID);
-						fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-						fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj)));
-						edb->setFact(reg->storeOrdinaryAtom(fact).address);
-					}
-				}
-			} else {
-				//	DBGLOG(DBG, "No");
-			}
-			//DBGLOG(DBG, "Checking if this is description of domain restriction");
-			if (theDLLitePlugin.cmpOwlType(pred, "onProperty")) {
-				//DBGLOG(DBG, "Yes");
-				onProp[subj]=obj;
-				//DBGLOG(DBG, "Addition to map onProp: "<<"onProp["<<subj<<"] = "<<obj);
-			}
-			else //DBGLOG(DBG, "No");
-
-
-			//DBGLOG(DBG, "Checking if this is role inclusion");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "subpropertyOf") && isOwlConstant(obj))
-			{
-				//DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form sub(Subj,Obj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//	DBGLOG(DBG, "No");
-			}
-
-			//DBGLOG(DBG, "Checking if this is a concept disjointness axiom");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "disjointWith") && isOwlConstant(obj))
-			{
-				//DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form sub(Subj,negObj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.dlNeg(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj))));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				DBGLOG(DBG, "No");
-			}
-
-			//DBGLOG(DBG, "Checking if this is a complement concept");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "complementOf") && isOwlConstant(obj))
-			{
-				DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form op(Subj,Obj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.opID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//DBGLOG(DBG, "No");
-			}
-
-			//DBGLOG(DBG, "Checking if this is a role disjointness axiom");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "propertyDisjointWith") && isOwlConstant(obj))
-			{
-				//	DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form sub(Subj,Obj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.dlNeg(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj))));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//DBGLOG(DBG, "No");
-			}
-
-			//	DBGLOG(DBG, "Checking if this is a domain definition");
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "domain") && isOwlConstant(obj))
-			{
-				//DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form sub(exSubj,Obj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.subID);
-					fact.tuple.push_back(theDLLitePlugin.dlEx(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj))));
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//DBGLOG(DBG, "No");
-			}
-
-			//checking if this is role functionality
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "type") && theDLLitePlugin.cmpOwlType(obj, "FunctionalProperty"))
-			{
-				//DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form funct(subj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.functID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//DBGLOG(DBG, "No");
-			}
-
-			//checking if this is role inverse definition
-			if (isOwlConstant(subj) && theDLLitePlugin.cmpOwlType(pred, "inverseOf") && isOwlConstant(obj))
-			{
-				//DBGLOG(DBG, "Yes");
-				DBGLOG(DBG,"Construct facts of the form funct(subj)");
-				{
-					OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					fact.tuple.push_back(theDLLitePlugin.invID);
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj)));
-					fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj)));
-					edb->setFact(reg->storeOrdinaryAtom(fact).address);
-				}
-			} else {
-				//DBGLOG(DBG, "No");
-			}
+#ifndef NDEBUG
+		DBGLOG(DBG, "LSS: Using the following facts as input to the classification program: " << *edb);
+#endif
 
+		CtxData::ClassificationMode mode = ctx.getPluginData<DLLitePlugin>().classificationMode;
 
+		// compute the closure natively
+		if (mode == CtxData::native || mode == CtxData::check) {
+			DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidnativeclassification, "DLLite native classification");
+			classificationIndex = ClassificationIndexPtr(new ClassificationIndex(reg));
+			classificationIndex->saturate(edb);
+			classification = classificationIndex->getInterpretation();
+			DBGLOG(DBG, "Classification (native): " << *classification);
 		}
 
-		DBGLOG(DBG,"Checking if there are any domain restrictions on properties");
-
-		std::map<std::string,std::string>::iterator p1;
-		std::map<std::string,std::string>::iterator p2;
-		for(p1 = domainRestr.begin(); p1!= domainRestr.end(); p1++) {
-			std::string subj1 = p1->first;
-			DBGLOG(DBG, "subj1 is "<<subj1);
-			std::string obj1 = p1->second;
-			DBGLOG(DBG, "obj1 is "<<obj1);
-
-			for(p2 = onProp.begin(); p2 != onProp.end(); p2++) {
-				std::string subj2 = p2->first;
-				DBGLOG(DBG, "subj2 is "<<subj2);
-				std::string obj2 = p2->second;
-				DBGLOG(DBG, "obj2 is "<<obj2);
-				if (obj1==subj2) {
-					DBGLOG(DBG,"Yes");
-					DBGLOG(DBG,"Construct facts of the form sub(Subj,exObj)");
-					{
-						OrdinaryAtom fact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-						fact.tuple.push_back(theDLLitePlugin.subID);
-						fact.tuple.push_back(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(subj1))); fact.tuple.push_back(theDLLitePlugin.dlEx(theDLLitePlugin.storeQuotedConstantTerm(removeNamespaceFromString(obj2)))); edb->setFact(reg->storeOrdinaryAtom(fact).address);
-					}
+		// evaluate the classification program without custom model generators
+		if (mode == CtxData::asp || mode == CtxData::check) {
+			ProgramCtx pc = ctx;
+			pc.config.setOption("ForceGC", 0);
+			pc.idb = theDLLitePlugin.classificationIDB;
+			pc.edb = edb;
+			pc.currentOptimum.clear();
+			pc.customModelGeneratorProvider.reset();
+
+			std::vector<InterpretationPtr> answersets = ctx.evaluateSubprogram(pc, false);
+			assert(answersets.size() == 1 && "Subprogram must have exactly one answer set");
+			DBGLOG(DBG, "Classification (ASP): " << *answersets[0]);
+
+			if (mode == CtxData::check) {
+				// the answer set of the subprogram contains also the EDB
+				if (answersets[0]->getStorage() != classification->getStorage()) {
+					InterpretationPtr missing(new Interpretation(reg));
+					missing->getStorage() = answersets[0]->getStorage() - classification->getStorage();
+					InterpretationPtr additional(new Interpretation(reg));
+					additional->getStorage() = classification->getStorage() - answersets[0]->getStorage();
+					std::stringstream ss;
+					ss << "Native classification differs from the classification program: missing " << *missing << ", additional " << *additional;
+					throw PluginError(ss.str());
 				}
-				else DBGLOG(DBG,"No");
+				DBGLOG(DBG, "Native classification coincides with the classification program");
+			} else {
+				classification = answersets[0];
+				classificationIndex = ClassificationIndexPtr(new ClassificationIndex(reg));
+				classificationIndex->load(classification);
 			}
 		}
-		DBGLOG(DBG, "CLP: EDB of classification program: " << *edb);
-
-		// evaluate the subprogram and return its unique answer set
-#ifndef NDEBUG
-		DBGLOG(DBG, "LSS: Using the following facts as input to the classification program: " << *edb);
-#endif
 
-		// evaluate the classification program without custom model generators
+		assert(!!classification && "Could not compute classification");
+		tboxFacts.reset();
 
-		ProgramCtx pc = ctx;
-		pc.config.setOption("ForceGC", 0);
-		pc.idb = theDLLitePlugin.classificationIDB;
-		pc.edb = edb;
-		pc.currentOptimum.clear();
-		pc.customModelGeneratorProvider.reset();
+		// store the classification for later runs
+		if (snapshotDir != "" && fileHash != "") saveSnapshot();
+	}
 
-		std::vector<InterpretationPtr> answersets = ctx.evaluateSubprogram(pc, false);
-		assert(answersets.size() == 1 && "Subprogram must have exactly one answer set");
-		DBGLOG(DBG, "Classification: " << *answersets[0]);
+	NativeReasonerPtr DLLitePlugin::CachedOntology::getNativeReasoner(ProgramCtx& ctx) {
 
-		classification = answersets[0];
-		assert(!!classification && "Could not compute classification");
+		boost::mutex::scoped_lock lock(mutex);
+		if (!nativeReasoner) {
+			DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidnativereasoner, "DLLite native reasoner setup");
+			if (!classification) computeClassification(ctx);
+			nativeReasoner = NativeReasonerPtr(new NativeReasoner(reg, *this));
+		}
+		return nativeReasoner;
 	}
 
 	InterpretationPtr DLLitePlugin::CachedOntology::getAllIndividuals(const PluginAtom::Query& query, bool addPotentialIndividuals) {
@@ -723,6 +990,10 @@ namespace dllite {
 		return !theDLLitePlugin.isOwlType(str);
 	}
 
+	ID DLLitePlugin::CachedOntology::storeQuotedConstantTerm(const std::string& str) const {
+		return theDLLitePlugin.storeQuotedConstantTerm(str);
+	}
+
 	bool DLLitePlugin::CachedOntology::checkConceptAssertion(RegistryPtr reg, ID guardAtomID) const {
 		assert(reg->ogatoms.getByAddress(guardAtomID.address).tuple.size() == 3 && "Concept guard atoms must be of arity 2");
 		assert(!theDLLitePlugin.isDlEx(reg->ogatoms.getByID(guardAtomID).tuple[2]) && "existentials in guard atoms are disallowed");
@@ -733,10 +1004,24 @@ namespace dllite {
 		const OrdinaryAtom& ogatom = reg->ogatoms.getByAddress(guardAtomID.address);
 		assert(ogatom.tuple.size() == 4 && "Role guard atoms must be of arity 3");
 		assert(!theDLLitePlugin.isDlEx(ogatom.tuple[2]) && !theDLLitePlugin.isDlEx(ogatom.tuple[3]) && "existentials in guard atoms are disallowed");
-		BOOST_FOREACH (RoleAssertion ra, roleAssertions) {
-			if (ra.first == ogatom.tuple[1] && ra.second.first == ogatom.tuple[2] && ra.second.second == ogatom.tuple[3]) return true;
+		return roleAssertionIndex.contains(ogatom.tuple[1], ogatom.tuple[2], ogatom.tuple[3]);
+	}
+
+	void DLLitePlugin::CachedOntology::checkGuardAtoms(RegistryPtr reg, InterpretationConstPtr guardAtoms, InterpretationPtr holding) const {
+
+		// concept guards hold iff they are among the concept assertions
+		holding->getStorage() |= (guardAtoms->getStorage() & conceptAssertions->getStorage());
+
+		// look up the remaining role guards in the index
+		bm::bvector<> roleGuards = guardAtoms->getStorage() - conceptAssertions->getStorage();
+		bm::bvector<>::enumerator en = roleGuards.first();
+		bm::bvector<>::enumerator en_end = roleGuards.end();
+		while (en < en_end) {
+			const OrdinaryAtom& ogatom = reg->ogatoms.getByAddress(*en);
+			assert(ogatom.tuple[0] == theDLLitePlugin.guardPredicateID && "tried to check a non-guard atom");
+			if (ogatom.tuple.size() == 4 && roleAssertionIndex.contains(ogatom.tuple[1], ogatom.tuple[2], ogatom.tuple[3])) holding->setFact(*en);
+			en++;
 		}
-		return false;
 	}
 
 	// ============================== Class DLLitePlugin ==============================
@@ -932,6 +1217,7 @@ namespace dllite {
 
 		assert(!!reg && "Registry must be set for preparing ontologies");
 		DBGLOG(DBG, "prepareOntology");
+		boost::mutex::scoped_lock lock(ctx.getPluginData<DLLitePlugin>().ontologyMutex);
 
 		BOOST_FOREACH (CachedOntologyPtr o, ontologies) {
 			if (o->ontologyName == ontologyNameID && o->includeAbox == includeAbox) {
@@ -954,6 +1240,8 @@ namespace dllite {
 		DBGLOG(DBG, "Loading ontology" << reg->terms.getByID(ontologyNameID).getUnquotedString());
 
 		CachedOntologyPtr co = CachedOntologyPtr(new CachedOntology(reg));
+		co->snapshotDir = ctx.getPluginData<DLLitePlugin>().cachedir;
+		co->maxKernels = ctx.getPluginData<DLLitePlugin>().kernels;
 		try {
 			co->load(ontologyNameID, includeAbox);
 			ontologies.push_back(co);
@@ -1195,6 +1483,147 @@ namespace dllite {
 				ctx.getPluginData<DLLitePlugin>().optimize = true;
 				found.push_back(it);
 			}
+
+			// --cachedir specifies a directory where snapshots of loaded ontologies and support families are stored for later runs
+
+			if (option.find("--cachedir=") != std::string::npos) {
+				ctx.getPluginData<DLLitePlugin>().cachedir = option.substr(11);
+				found.push_back(it);
+			}
+
+			// --classification selects between the native closure and the classification program
+
+			if (option.find("--classification=") != std::string::npos) {
+				std::string mode = option.substr(17);
+				if (mode == "native") ctx.getPluginData<DLLitePlugin>().classificationMode = CtxData::native;
+				else if (mode == "asp") ctx.getPluginData<DLLitePlugin>().classificationMode = CtxData::asp;
+				else if (mode == "check") ctx.getPluginData<DLLitePlugin>().classificationMode = CtxData::check;
+				else throw PluginError("Unknown classification mode \"" + mode + "\"");
+				found.push_back(it);
+			}
+
+			// --requiemworkers specifies how many Requiem processes rewrite queries in parallel (EL mode)
+
+			if (option.find("--requiemworkers=") != std::string::npos) {
+				std::string s = option.substr(17);
+				try
+				{
+					ctx.getPluginData<DLLitePlugin>().requiemworkers = boost::lexical_cast<unsigned>(s);
+				}
+				catch(const boost::bad_lexical_cast&)
+				{
+					assert(false && "Specified number of Requiem workers is not a number");
+				}
+				found.push_back(it);
+			}
+
+			// --supthreads specifies how many threads learn support families concurrently (repair mode)
+
+			if (option.find("--supthreads=") != std::string::npos) {
+				std::string s = option.substr(13);
+				try
+				{
+					ctx.getPluginData<DLLitePlugin>().supthreads = boost::lexical_cast<unsigned>(s);
+				}
+				catch(const boost::bad_lexical_cast&)
+				{
+					assert(false && "Specified number of support set threads is not a number");
+				}
+				if (ctx.getPluginData<DLLitePlugin>().supthreads == 0) ctx.getPluginData<DLLitePlugin>().supthreads = 1;
+				found.push_back(it);
+			}
+
+			// --checkthreads specifies how many threads post check repair candidates while the solver enumerates further ones (repair mode)
+
+			if (option.find("--checkthreads=") != std::string::npos) {
+				std::string s = option.substr(15);
+				try
+				{
+					ctx.getPluginData<DLLitePlugin>().checkthreads = boost::lexical_cast<unsigned>(s);
+				}
+				catch(const boost::bad_lexical_cast&)
+				{
+					assert(false && "Specified number of post check threads is not a number");
+				}
+				if (ctx.getPluginData<DLLitePlugin>().checkthreads == 0) ctx.getPluginData<DLLitePlugin>().checkthreads = 1;
+				found.push_back(it);
+			}
+			if (option == "--checkunordered") {
+				ctx.getPluginData<DLLitePlugin>().checkunordered = true;
+				found.push_back(it);
+			}
+
+			// --aboxconflicts prunes candidates which keep two conflicting Abox assertions already during the search (repair mode,
+			// DL-Lite only); the post check rejects such candidates in any case
+
+			if (option == "--aboxconflicts") {
+				ctx.getPluginData<DLLitePlugin>().aboxconflicts = true;
+				found.push_back(it);
+			}
+
+			// --kernels specifies how many FaCT++ kernels per ontology may answer queries of DL-atoms concurrently
+
+			if (option.find("--kernels=") != std::string::npos) {
+				std::string s = option.substr(10);
+				try
+				{
+					ctx.getPluginData<DLLitePlugin>().kernels = boost::lexical_cast<unsigned>(s);
+				}
+				catch(const boost::bad_lexical_cast&)
+				{
+					assert(false && "Specified number of kernels is not a number");
+				}
+				if (ctx.getPluginData<DLLitePlugin>().kernels == 0) ctx.getPluginData<DLLitePlugin>().kernels = 1;
+				found.push_back(it);
+			}
+
+			// --reasoner selects between FaCT++ and the native DL-Lite reasoner for evaluating DL-atoms
+
+			if (option.find("--reasoner=") != std::string::npos) {
+				std::string engine = option.substr(11);
+				if (engine == "factpp") ctx.getPluginData<DLLitePlugin>().queryEngine = CtxData::factppEngine;
+				else if (engine == "native") ctx.getPluginData<DLLitePlugin>().queryEngine = CtxData::nativeEngine;
+				else throw PluginError("Unknown reasoner \"" + engine + "\"");
+				found.push_back(it);
+			}
+
+			// --answercache bounds the memory used for caching the answers of each DL-atom
+
+			if (option.find("--answercache=") != std::string::npos) {
+				std::string s = option.substr(14);
+				try
+				{
+					ctx.getPluginData<DLLitePlugin>().answercache = boost::lexical_cast<unsigned>(s);
+				}
+				catch(const boost::bad_lexical_cast&)
+				{
+					assert(false && "Specified size of the answer cache is not a number");
+				}
+				found.push_back(it);
+			}
+
+			// --updatebatches bounds the number of recent DL-atom inputs per ontology whose overlays are shared
+
+			if (option.find("--updatebatches=") != std::string::npos) {
+				std::string s = option.substr(16);
+				try
+				{
+					ctx.getPluginData<DLLitePlugin>().updatebatches = boost::lexical_cast<unsigned>(s);
+				}
+				catch(const boost::bad_lexical_cast&)
+				{
+					assert(false && "Specified number of update batches is not a number");
+				}
+				if (ctx.getPluginData<DLLitePlugin>().updatebatches == 0) ctx.getPluginData<DLLitePlugin>().updatebatches = 1;
+				found.push_back(it);
+			}
+
+			// --requiem uses the external Requiem rewriter instead of the native one (EL mode)
+
+			if (option == "--requiem") {
+				ctx.getPluginData<DLLitePlugin>().requiem = true;
+				found.push_back(it);
+			}
 		}
 
 		/*	if (ctx.config.getOption("SupportSets")) {
@@ -1249,6 +1678,29 @@ namespace dllite {
 		o << "     --ontology=[ontology name]  Specifies the ontology used by DL-atoms" << std::endl;
 		o << "     --optimize                  Rewrites default-negated consistency checking DL-atoms" << std::endl
 		<< "                                 to inconsistency checks (makes them monotonic)" << std::endl;
+		o << "     --cachedir=[directory]      Stores snapshots of loaded ontologies and learned support sets" << std::endl
+		<< "                                 in this directory and reuses them if the ontology file did not change" << std::endl;
+		o << "     --classification=[native|asp|check]" << std::endl
+		<< "                                 Computes the classification natively, using the" << std::endl
+		<< "                                 classification program (default), or both and compares them" << std::endl;
+		o << "     --requiem                   Uses Requiem instead of the native rewriter in EL mode" << std::endl;
+		o << "     --reasoner=[factpp|native]  Evaluates DL-atoms using FaCT++ (default) or natively" << std::endl
+		<< "                                 from the classification (DL-Lite only); FaCT++ answers" << std::endl
+		<< "                                 queries with updates over the expanded Abox" << std::endl;
+		o << "     --supthreads=[integer]      Number of threads for support set learning in repair mode" << std::endl;
+		o << "     --checkthreads=[integer]    Number of threads for post checks of repair candidates, which run" << std::endl
+		<< "                                 while the solver enumerates further candidates (default: 1)" << std::endl;
+		o << "     --checkunordered            Returns repair answer sets of concurrent post checks in any order" << std::endl;
+		o << "     --aboxconflicts             Prunes repair candidates which keep two conflicting Abox assertions" << std::endl
+		<< "                                 as soon as both are fixed during the search instead of" << std::endl
+		<< "                                 in the post check (DL-Lite only)" << std::endl;
+		o << "     --kernels=[integer]         Number of FaCT++ kernels per ontology for concurrent" << std::endl
+		<< "                                 evaluation of DL-atoms (default: 1)" << std::endl;
+		o << "     --answercache=[integer]     Memory bound of the answer cache of each DL-atom in MB" << std::endl
+		<< "                                 (default: 64, 0 disables the cache)" << std::endl;
+		o << "     --updatebatches=[integer]   Number of recent DL-atom inputs per ontology whose overlays" << std::endl
+		<< "                                 and consistency are shared by all DL-atoms (default: 16)" << std::endl;
+		o << "     --requiemworkers=[integer]  Number of Requiem processes used for rewriting in EL mode" << std::endl;
 	}
 
 	void DLLitePlugin::setRegistry(RegistryPtr reg) {
@@ -1290,6 +1742,38 @@ namespace dllite {
 		return gatom;
 	}
 
+	ID DLLitePlugin::getQuotedTerm(ID term) {
+
+		// only constants are cached (variables occur in nonground input atoms)
+		if (!term.isConstantTerm()) return storeQuotedConstantTerm(reg->terms.getByID(term).getUnquotedString());
+		{
+			boost::mutex::scoped_lock lock(termMutex);
+			boost::unordered_map<IDAddress, ID>::const_iterator it = quotedTerms.find(term.address);
+			if (it != quotedTerms.end()) return it->second;
+		}
+
+		// the term mutex is not recursive, thus the term is stored before the cache is updated
+		ID quoted = storeQuotedConstantTerm(reg->terms.getByID(term).getUnquotedString());
+		boost::mutex::scoped_lock lock(termMutex);
+		quotedTerms[term.address] = quoted;
+		return quoted;
+	}
+
+	ID DLLitePlugin::dlNeg(ID id) {
+
+		{
+			boost::mutex::scoped_lock lock(termMutex);
+			boost::unordered_map<IDAddress, ID>::const_iterator it = negatedTerms.find(id.address);
+			if (it != negatedTerms.end()) return it->second;
+		}
+
+		const std::string& str = reg->terms.getByID(id).getUnquotedString();
+		ID neg = (str[0] == '-' ? storeQuotedConstantTerm(str.substr(1)) : storeQuotedConstantTerm("-" + str));
+		boost::mutex::scoped_lock lock(termMutex);
+		negatedTerms[id.address] = neg;
+		return neg;
+	}
+
 	void DLLitePlugin::prepareIDs() {
 
 		assert(!!reg && "registry must be set before IDs can be prepared");
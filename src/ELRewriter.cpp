@@ -0,0 +1,641 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file ELRewriter.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Native rewriting of atomic concept queries over ELHIO ontologies.
+ *
+ * The Tbox is normalized such that complex class expressions are replaced by
+ * fresh concepts. A query is then rewritten backwards by
+ *   - replacing an atom B(X) by the left-hand side of an axiom with B on the right,
+ *   - replacing an atom R(X,Y) by S(X,Y) resp. S(Y,X) for S <= R resp. S^- <= R,
+ *   - removing a non-answer variable Z whose atoms R1(X,Z), ..., Rn(X,Z), C(Z) are
+ *     implied by an axiom A <= exS.C with S <= R1, ..., S <= Rn, which yields A(X), and
+ *   - unifying two neighbours of a non-answer variable (to make the previous step applicable).
+ * Each query generated this way is a rewriting of the original query.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "ELRewriter.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Registry.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include "boost/foreach.hpp"
+#include <boost/lexical_cast.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "owlcpp/rdf/triple_store.hpp"
+#include "owlcpp/terms/node_tags_owl.hpp"
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+
+	// ============================== Class ELTboxNormalizer ==============================
+
+	// reads the Tbox from the triple store and adds its normal form to an ELRewriter
+	class ELTboxNormalizer{
+	private:
+		typedef std::pair<int, bool> RoleExpression;
+		typedef boost::unordered_map<owlcpp::Node_id, owlcpp::Node_id> NodeMap;
+		enum AxiomKind { SubClassOf, EquivalentClass, SubPropertyOf, EquivalentProperty, InverseOf, Domain, Range };
+		typedef std::pair<AxiomKind, std::pair<owlcpp::Node_id, owlcpp::Node_id> > Axiom;
+
+		// bound for nested class expressions (protects against cyclic lists)
+		static const int maxDepth = 64;
+
+		ELRewriter& rewriter;
+		const DLLitePlugin::CachedOntology& ontology;
+		const owlcpp::Triple_store& store;
+
+		// structure of anonymous class and property expressions
+		NodeMap onProperty, someValuesFrom, intersectionOf, unionOf, inverseOf, first, rest;
+		boost::unordered_set<owlcpp::Node_id> complements;
+		std::vector<Axiom> axioms;
+		boost::unordered_map<owlcpp::Node_id, bool> namedNodes;
+
+		bool isNamed(owlcpp::Node_id node) {
+			boost::unordered_map<owlcpp::Node_id, bool>::const_iterator it = namedNodes.find(node);
+			if (it != namedNodes.end()) return it->second;
+			std::string str = to_string(node, store);
+			bool named = (str.substr(0, 2) != "_:" && ontology.isOwlConstant(str));
+			namedNodes[node] = named;
+			return named;
+		}
+
+		ID getTerm(owlcpp::Node_id node) {
+			// same as DLLitePlugin::storeQuotedConstantTerm
+			return ontology.reg->storeConstantTerm("\"" + ontology.removeNamespaceFromString(to_string(node, store)) + "\"");
+		}
+
+		static bool lookup(const NodeMap& map, owlcpp::Node_id node, owlcpp::Node_id& value) {
+			NodeMap::const_iterator it = map.find(node);
+			if (it == map.end()) return false;
+			value = it->second;
+			return true;
+		}
+
+		// returns the elements of an RDF list
+		bool getList(owlcpp::Node_id list, std::vector<owlcpp::Node_id>& elements) {
+			owlcpp::Node_id element;
+			while (list != owlcpp::terms::rdf_nil::id()) {
+				if (!lookup(first, list, element) || elements.size() > (unsigned)maxDepth) return false;
+				elements.push_back(element);
+				if (!lookup(rest, list, list)) return false;
+			}
+			return true;
+		}
+
+		// returns the role index and the inverse flag, or -1 as index if the expression is not supported
+		RoleExpression getRoleExpression(owlcpp::Node_id node) {
+			owlcpp::Node_id inverse;
+			if (isNamed(node)) return RoleExpression(rewriter.getRole(getTerm(node)), false);
+			if (lookup(inverseOf, node, inverse) && isNamed(inverse)) return RoleExpression(rewriter.getRole(getTerm(inverse)), true);
+			return RoleExpression(-1, false);
+		}
+
+		// returns a concept C such that the class expression is subsumed by C, or -1 if the expression is not supported
+		int normalizeLeft(owlcpp::Node_id node, int depth) {
+			if (depth > maxDepth) return -1;
+			if (node == owlcpp::terms::owl_Thing::id()) return ELRewriter::top;
+			if (isNamed(node)) return rewriter.getConcept(getTerm(node));
+
+			owlcpp::Node_id property, filler, list;
+			std::vector<owlcpp::Node_id> elements;
+			if (lookup(someValuesFrom, node, filler) && lookup(onProperty, node, property)) {
+				RoleExpression role = getRoleExpression(property);
+				int fillerConcept = normalizeLeft(filler, depth + 1);
+				if (role.first == -1 || fillerConcept == -1) return -1;
+				int c = rewriter.newConcept();
+				ELRewriter::Existential ex;
+				ex.role = role;
+				ex.filler = fillerConcept;
+				rewriter.existentialsLeft[c].push_back(ex);
+				return c;
+			}
+			if (lookup(intersectionOf, node, list) && getList(list, elements)) {
+				std::vector<int> conjuncts;
+				BOOST_FOREACH (owlcpp::Node_id element, elements) {
+					int conjunct = normalizeLeft(element, depth + 1);
+					if (conjunct == -1) return -1;
+					if (conjunct != ELRewriter::top) conjuncts.push_back(conjunct);
+				}
+				int c = rewriter.newConcept();
+				rewriter.conjunctions[c].push_back(conjuncts);
+				return c;
+			}
+			if (lookup(unionOf, node, list) && getList(list, elements)) {
+				int c = rewriter.newConcept();
+				BOOST_FOREACH (owlcpp::Node_id element, elements) {
+					int disjunct = normalizeLeft(element, depth + 1);
+					if (disjunct == -1) rewriter.approximated = true;
+					else rewriter.subConcepts[c].push_back(disjunct);
+				}
+				return c;
+			}
+			return -1;
+		}
+
+		// adds axioms such that concept c is subsumed by the class expression
+		void normalizeRight(int c, owlcpp::Node_id node, int depth) {
+			if (depth > maxDepth) {
+				rewriter.approximated = true;
+				return;
+			}
+			if (node == owlcpp::terms::owl_Thing::id()) return;
+			if (complements.count(node) > 0) return;	// negative information is irrelevant for the rewriting
+			if (c == ELRewriter::top) {
+				// an axiom of form Thing <= C cannot be expressed by a rewriting
+				rewriter.approximated = true;
+				return;
+			}
+			if (isNamed(node)) {
+				rewriter.subConcepts[rewriter.getConcept(getTerm(node))].push_back(c);
+				return;
+			}
+
+			owlcpp::Node_id property, filler, list;
+			std::vector<owlcpp::Node_id> elements;
+			if (lookup(someValuesFrom, node, filler) && lookup(onProperty, node, property)) {
+				RoleExpression role = getRoleExpression(property);
+				if (role.first == -1) {
+					rewriter.approximated = true;
+					return;
+				}
+				int fillerConcept;
+				if (filler == owlcpp::terms::owl_Thing::id()) fillerConcept = ELRewriter::top;
+				else if (isNamed(filler)) fillerConcept = rewriter.getConcept(getTerm(filler));
+				else {
+					fillerConcept = rewriter.newConcept();
+					normalizeRight(fillerConcept, filler, depth + 1);
+				}
+				ELRewriter::Existential ex;
+				ex.role = role;
+				ex.filler = fillerConcept;
+				rewriter.existentialsRight.push_back(std::pair<int, ELRewriter::Existential>(c, ex));
+				return;
+			}
+			if (lookup(intersectionOf, node, list) && getList(list, elements)) {
+				BOOST_FOREACH (owlcpp::Node_id element, elements) normalizeRight(c, element, depth + 1);
+				return;
+			}
+			rewriter.approximated = true;
+		}
+
+		void addSubClassOf(owlcpp::Node_id sub, owlcpp::Node_id sup) {
+			int c = normalizeLeft(sub, 0);
+			if (c == -1) rewriter.approximated = true;
+			else normalizeRight(c, sup, 0);
+		}
+
+		void addSubPropertyOf(RoleExpression sub, RoleExpression sup) {
+			if (sub.first == -1 || sup.first == -1) {
+				rewriter.approximated = true;
+				return;
+			}
+			// S^a <= R^b iff S^(a xor b) <= R
+			rewriter.subRoles[sup.first].push_back(RoleExpression(sub.first, sub.second != sup.second));
+		}
+
+		void addExistentialSubClassOf(RoleExpression role, owlcpp::Node_id sup) {
+			if (role.first == -1) {
+				rewriter.approximated = true;
+				return;
+			}
+			int c = rewriter.newConcept();
+			ELRewriter::Existential ex;
+			ex.role = role;
+			ex.filler = ELRewriter::top;
+			rewriter.existentialsLeft[c].push_back(ex);
+			normalizeRight(c, sup, 0);
+		}
+
+	public:
+		ELTboxNormalizer(ELRewriter& rewriter, const DLLitePlugin::CachedOntology& ontology) : rewriter(rewriter), ontology(ontology), store(ontology.store) {}
+
+		void normalize() {
+
+			// collect the axioms and the structure of anonymous expressions in one pass
+			BOOST_FOREACH(owlcpp::Triple const& t, store.map_triple()) {
+				const owlcpp::Node_id pred = t.pred_;
+				if (pred == owlcpp::terms::rdfs_subClassOf::id()) axioms.push_back(Axiom(SubClassOf, std::make_pair(t.subj_, t.obj_)));
+				else if (pred == owlcpp::terms::owl_equivalentClass::id()) axioms.push_back(Axiom(EquivalentClass, std::make_pair(t.subj_, t.obj_)));
+				else if (pred == owlcpp::terms::rdfs_subPropertyOf::id()) axioms.push_back(Axiom(SubPropertyOf, std::make_pair(t.subj_, t.obj_)));
+				else if (pred == owlcpp::terms::owl_equivalentProperty::id()) axioms.push_back(Axiom(EquivalentProperty, std::make_pair(t.subj_, t.obj_)));
+				else if (pred == owlcpp::terms::rdfs_domain::id()) axioms.push_back(Axiom(Domain, std::make_pair(t.subj_, t.obj_)));
+				else if (pred == owlcpp::terms::rdfs_range::id()) axioms.push_back(Axiom(Range, std::make_pair(t.subj_, t.obj_)));
+				else if (pred == owlcpp::terms::owl_inverseOf::id()) {
+					if (isNamed(t.subj_)) axioms.push_back(Axiom(InverseOf, std::make_pair(t.subj_, t.obj_)));
+					else inverseOf[t.subj_] = t.obj_;
+				}
+				else if (pred == owlcpp::terms::owl_onProperty::id()) onProperty[t.subj_] = t.obj_;
+				else if (pred == owlcpp::terms::owl_someValuesFrom::id()) someValuesFrom[t.subj_] = t.obj_;
+				else if (pred == owlcpp::terms::owl_intersectionOf::id()) intersectionOf[t.subj_] = t.obj_;
+				else if (pred == owlcpp::terms::owl_unionOf::id()) unionOf[t.subj_] = t.obj_;
+				else if (pred == owlcpp::terms::owl_complementOf::id()) complements.insert(t.subj_);
+				else if (pred == owlcpp::terms::rdf_first::id()) first[t.subj_] = t.obj_;
+				else if (pred == owlcpp::terms::rdf_rest::id()) rest[t.subj_] = t.obj_;
+				else if (pred == owlcpp::terms::rdf_type::id()) {
+					if (t.obj_ == owlcpp::terms::owl_Class::id() && isNamed(t.subj_)) rewriter.getConcept(getTerm(t.subj_));
+					else if (t.obj_ == owlcpp::terms::owl_ObjectProperty::id() && isNamed(t.subj_)) rewriter.getRole(getTerm(t.subj_));
+					else if (t.obj_ == owlcpp::terms::owl_SymmetricProperty::id()) {
+						RoleExpression role = getRoleExpression(t.subj_);
+						addSubPropertyOf(RoleExpression(role.first, !role.second), role);
+					}
+					else if (t.obj_ == owlcpp::terms::owl_TransitiveProperty::id()) {
+						DBGLOG(DBG, "EL rewriter: ignoring transitive property " << to_string(t.subj_, store));
+						rewriter.approximated = true;
+					}
+				}
+			}
+
+			BOOST_FOREACH (const Axiom& axiom, axioms) {
+				owlcpp::Node_id subj = axiom.second.first;
+				owlcpp::Node_id obj = axiom.second.second;
+				switch (axiom.first) {
+				case SubClassOf:
+					addSubClassOf(subj, obj);
+					break;
+				case EquivalentClass:
+					addSubClassOf(subj, obj);
+					addSubClassOf(obj, subj);
+					break;
+				case SubPropertyOf:
+					addSubPropertyOf(getRoleExpression(subj), getRoleExpression(obj));
+					break;
+				case EquivalentProperty:
+					addSubPropertyOf(getRoleExpression(subj), getRoleExpression(obj));
+					addSubPropertyOf(getRoleExpression(obj), getRoleExpression(subj));
+					break;
+				case InverseOf: {
+					RoleExpression p = getRoleExpression(subj);
+					RoleExpression q = getRoleExpression(obj);
+					addSubPropertyOf(p, RoleExpression(q.first, !q.second));
+					addSubPropertyOf(q, RoleExpression(p.first, !p.second));
+					break;
+				}
+				case Domain:
+					addExistentialSubClassOf(getRoleExpression(subj), obj);
+					break;
+				case Range: {
+					RoleExpression role = getRoleExpression(subj);
+					addExistentialSubClassOf(RoleExpression(role.first, !role.second), obj);
+					break;
+				}
+				}
+			}
+		}
+	};
+
+	// ============================== Class ELRewriter ==============================
+
+	ELRewriter::ELRewriter(DLLitePlugin::CachedOntology& ontology, const std::vector<ID>& queryConcepts) : reg(ontology.reg), approximated(false) {
+
+		DBGLOG(DBG, "EL rewriter: normalizing Tbox");
+
+		// concept 0 is top
+		newConcept();
+
+		ELTboxNormalizer normalizer(*this, ontology);
+		normalizer.normalize();
+		BOOST_FOREACH (ID concept, queryConcepts) getConcept(concept);
+		computeClosures();
+
+		DBGLOG(DBG, "EL rewriter: " << conceptTerms.size() << " concepts (including fresh ones), " << roleTerms.size() << " roles, " << existentialsRight.size() << " existential axioms" << (approximated ? ", some axioms are outside of ELHIO" : ""));
+	}
+
+	int ELRewriter::newConcept() {
+		int c = conceptTerms.size();
+		conceptTerms.push_back(ID_FAIL);
+		subConcepts.push_back(std::vector<int>());
+		conjunctions.push_back(std::vector<std::vector<int> >());
+		existentialsLeft.push_back(std::vector<Existential>());
+		return c;
+	}
+
+	int ELRewriter::getConcept(ID term) {
+		boost::unordered_map<IDAddress, int>::const_iterator it = conceptIndices.find(term.address);
+		if (it != conceptIndices.end()) return it->second;
+		int c = newConcept();
+		conceptTerms[c] = term;
+		conceptIndices[term.address] = c;
+		return c;
+	}
+
+	int ELRewriter::getRole(ID term) {
+		boost::unordered_map<IDAddress, int>::const_iterator it = roleIndices.find(term.address);
+		if (it != roleIndices.end()) return it->second;
+		int r = roleTerms.size();
+		roleTerms.push_back(term);
+		roleIndices[term.address] = r;
+		subRoles.push_back(std::vector<RoleExpression>());
+		return r;
+	}
+
+	void ELRewriter::computeClosures() {
+
+		subConceptClosure.resize(conceptTerms.size());
+		for (unsigned c = 0; c < conceptTerms.size(); ++c) {
+			std::vector<bool> visited(conceptTerms.size(), false);
+			std::vector<int> todo(1, c);
+			visited[c] = true;
+			while (!todo.empty()) {
+				int current = todo.back();
+				todo.pop_back();
+				if (current != (int)c) subConceptClosure[c].push_back(current);
+				BOOST_FOREACH (int sub, subConcepts[current]) {
+					if (!visited[sub]) {
+						visited[sub] = true;
+						todo.push_back(sub);
+					}
+				}
+			}
+		}
+
+		subRoleClosure.resize(roleTerms.size());
+		for (unsigned r = 0; r < roleTerms.size(); ++r) {
+			std::set<RoleExpression>& closure = subRoleClosure[r];
+			std::vector<RoleExpression> todo(1, RoleExpression(r, false));
+			closure.insert(todo.back());
+			while (!todo.empty()) {
+				RoleExpression current = todo.back();
+				todo.pop_back();
+				// S^a <= R and the current role is R^b, thus S^(a xor b) <= R^b
+				BOOST_FOREACH (RoleExpression sub, subRoles[current.first]) {
+					RoleExpression next(sub.first, sub.second != current.second);
+					if (closure.insert(next).second) todo.push_back(next);
+				}
+			}
+		}
+	}
+
+	bool ELRewriter::subsumes(RoleExpression r, RoleExpression p) const {
+		// P^a <= R^b iff P^(a xor b) <= R
+		return subRoleClosure[r.first].count(RoleExpression(p.first, p.second != r.second)) > 0;
+	}
+
+	void ELRewriter::canonicalize(ConjunctiveQuery& q) const {
+
+		// rename the variables in the order of their first occurrence (the answer variable remains 0);
+		// since the order of the atoms depends on the names, this is repeated once to make the result more stable
+		for (int round = 0; round < 2; ++round) {
+			std::sort(q.begin(), q.end());
+			std::map<int, int> renaming;
+			renaming[0] = 0;
+			BOOST_FOREACH (QueryAtom& atom, q) {
+				if (renaming.find(atom.arg1) == renaming.end()) {
+					int next = renaming.size();
+					renaming[atom.arg1] = next;
+				}
+				if (atom.isRole() && renaming.find(atom.arg2) == renaming.end()) {
+					int next = renaming.size();
+					renaming[atom.arg2] = next;
+				}
+			}
+			BOOST_FOREACH (QueryAtom& atom, q) {
+				atom.arg1 = renaming[atom.arg1];
+				if (atom.isRole()) atom.arg2 = renaming[atom.arg2];
+			}
+		}
+		std::sort(q.begin(), q.end());
+		q.erase(std::unique(q.begin(), q.end()), q.end());
+	}
+
+	namespace {
+		// bounds for the search if no size limit is given (rewritings of EL ontologies can be infinite)
+		const int defaultMaxSize = 10;
+		const unsigned maxQueries = 100000;
+
+		inline ELRewriter::QueryAtom conceptAtom(int c, int x) {
+			ELRewriter::QueryAtom atom;
+			atom.pred = c;
+			atom.arg1 = x;
+			atom.arg2 = -1;
+			return atom;
+		}
+
+		inline ELRewriter::QueryAtom roleAtom(int r, int x, int y) {
+			ELRewriter::QueryAtom atom;
+			atom.pred = r;
+			atom.arg1 = x;
+			atom.arg2 = y;
+			return atom;
+		}
+
+		// replaces variable from by to
+		void substitute(ELRewriter::ConjunctiveQuery& q, int from, int to) {
+			BOOST_FOREACH (ELRewriter::QueryAtom& atom, q) {
+				if (atom.arg1 == from) atom.arg1 = to;
+				if (atom.isRole() && atom.arg2 == from) atom.arg2 = to;
+			}
+		}
+	}
+
+	void ELRewriter::expand(const ConjunctiveQuery& q, std::vector<ConjunctiveQuery>& successors) const {
+
+		int freshVariable = 0;
+		BOOST_FOREACH (const QueryAtom& atom, q) freshVariable = std::max(freshVariable, std::max(atom.arg1, atom.arg2) + 1);
+
+		// rewrite single atoms
+		for (unsigned i = 0; i < q.size(); ++i) {
+			ConjunctiveQuery base = q;
+			base.erase(base.begin() + i);
+			const QueryAtom& atom = q[i];
+
+			if (!atom.isRole()) {
+				// A <= B
+				BOOST_FOREACH (int sub, subConceptClosure[atom.pred]) {
+					successors.push_back(base);
+					if (sub != top) successors.back().push_back(conceptAtom(sub, atom.arg1));
+				}
+				// A1 & ... & An <= B
+				BOOST_FOREACH (const std::vector<int>& conjuncts, conjunctions[atom.pred]) {
+					successors.push_back(base);
+					BOOST_FOREACH (int conjunct, conjuncts) successors.back().push_back(conceptAtom(conjunct, atom.arg1));
+				}
+				// exR.A <= B
+				BOOST_FOREACH (const Existential& ex, existentialsLeft[atom.pred]) {
+					successors.push_back(base);
+					if (ex.role.second) successors.back().push_back(roleAtom(ex.role.first, freshVariable, atom.arg1));
+					else successors.back().push_back(roleAtom(ex.role.first, atom.arg1, freshVariable));
+					if (ex.filler != top) successors.back().push_back(conceptAtom(ex.filler, freshVariable));
+				}
+			} else {
+				// S <= R resp. S^- <= R
+				BOOST_FOREACH (const RoleExpression& sub, subRoleClosure[atom.pred]) {
+					if (sub.first == atom.pred && !sub.second) continue;
+					successors.push_back(base);
+					if (sub.second) successors.back().push_back(roleAtom(sub.first, atom.arg2, atom.arg1));
+					else successors.back().push_back(roleAtom(sub.first, atom.arg1, atom.arg2));
+				}
+			}
+		}
+
+		// eliminate non-answer variables
+		for (int z = 1; z < freshVariable; ++z) {
+			std::vector<std::pair<RoleExpression, int> > edges;	// role from the neighbour to z and the neighbour
+			std::vector<int> fillers;
+			bool eliminable = true;
+			BOOST_FOREACH (const QueryAtom& atom, q) {
+				if (atom.isRole() && atom.arg1 == z && atom.arg2 == z) eliminable = false;
+				else if (atom.isRole() && atom.arg2 == z) edges.push_back(std::make_pair(RoleExpression(atom.pred, false), atom.arg1));
+				else if (atom.isRole() && atom.arg1 == z) edges.push_back(std::make_pair(RoleExpression(atom.pred, true), atom.arg2));
+				else if (!atom.isRole() && atom.arg1 == z) fillers.push_back(atom.pred);
+			}
+			if (!eliminable || edges.empty()) continue;
+
+			// all neighbours must be the same; otherwise unify them
+			int x = edges[0].second;
+			bool sameNeighbour = true;
+			for (unsigned i = 1; i < edges.size(); ++i) {
+				int y = edges[i].second;
+				if (y == x) continue;
+				sameNeighbour = false;
+				if (y != 0) {
+					successors.push_back(q);
+					substitute(successors.back(), y, x);
+				}
+				if (x != 0) {
+					successors.push_back(q);
+					substitute(successors.back(), x, y);
+				}
+			}
+			if (!sameNeighbour) continue;
+
+			// A <= exS.C
+			typedef std::pair<int, Existential> ExistentialAxiom;
+			BOOST_FOREACH (const ExistentialAxiom& axiom, existentialsRight) {
+				bool applicable = true;
+				BOOST_FOREACH (int filler, fillers) {
+					if (filler != axiom.second.filler) applicable = false;
+				}
+				for (unsigned i = 0; i < edges.size() && applicable; ++i) {
+					if (!subsumes(edges[i].first, axiom.second.role)) applicable = false;
+				}
+				if (!applicable) continue;
+
+				successors.push_back(ConjunctiveQuery());
+				BOOST_FOREACH (const QueryAtom& atom, q) {
+					if (atom.arg1 != z && atom.arg2 != z) successors.back().push_back(atom);
+				}
+				successors.back().push_back(conceptAtom(axiom.first, x));
+			}
+		}
+	}
+
+	bool ELRewriter::isRelevant(const ConjunctiveQuery& q, const std::set<ID>& relevant) const {
+
+		// the query must still contain the answer variable
+		bool answerVariable = false;
+		BOOST_FOREACH (const QueryAtom& atom, q) {
+			ID pred = (atom.isRole() ? roleTerms[atom.pred] : conceptTerms[atom.pred]);
+			if (pred == ID_FAIL || relevant.count(pred) == 0) return false;
+			if (atom.arg1 == 0 || atom.arg2 == 0) answerVariable = true;
+		}
+		return answerVariable;
+	}
+
+	void ELRewriter::toNogood(const ConjunctiveQuery& q, Nogood& ng) const {
+
+		BOOST_FOREACH (const QueryAtom& atom, q) {
+			OrdinaryAtom oatom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYN);
+			oatom.tuple.push_back(atom.isRole() ? roleTerms[atom.pred] : conceptTerms[atom.pred]);
+			oatom.tuple.push_back(reg->storeVariableTerm("O" + boost::lexical_cast<std::string>(atom.arg1)));
+			if (atom.isRole()) oatom.tuple.push_back(reg->storeVariableTerm("O" + boost::lexical_cast<std::string>(atom.arg2)));
+			ng.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(oatom)));
+		}
+	}
+
+	bool ELRewriter::rewrite(ID concept, const std::set<ID>& relevant, int maxSize, int maxNumber, std::vector<ConjunctiveQuery>& rewritings) const {
+
+		bool complete = !approximated;
+		if (maxSize == -1) maxSize = defaultMaxSize;
+
+		boost::unordered_map<IDAddress, int>::const_iterator it = conceptIndices.find(concept.address);
+		if (it == conceptIndices.end()) {
+			DBGLOG(DBG, "EL rewriter: query concept was not indexed");
+			return false;
+		}
+		DBGLOG(DBG, "EL rewriter: rewriting query for concept " << it->second);
+		ConjunctiveQuery start;
+		start.push_back(conceptAtom(it->second, 0));
+
+		// breadth-first search, such that small rewritings are found first
+		std::set<ConjunctiveQuery> seen;
+		std::deque<ConjunctiveQuery> queue;
+		seen.insert(start);
+		queue.push_back(start);
+		std::vector<ConjunctiveQuery> successors;
+		while (!queue.empty()) {
+			ConjunctiveQuery q = queue.front();
+			queue.pop_front();
+
+			if (isRelevant(q, relevant)) {
+				if (maxNumber != -1 && rewritings.size() >= (unsigned)maxNumber) {
+					DBGLOG(DBG, "EL rewriter: limit for the number of rewritings reached");
+					return false;
+				}
+				rewritings.push_back(q);
+			}
+
+			successors.clear();
+			expand(q, successors);
+			BOOST_FOREACH (ConjunctiveQuery& successor, successors) {
+				canonicalize(successor);
+				if (successor.size() > (unsigned)maxSize) {
+					// the query might still lead to smaller rewritings later
+					complete = false;
+					continue;
+				}
+				if (seen.insert(successor).second) queue.push_back(successor);
+			}
+			if (seen.size() > maxQueries) {
+				DBGLOG(DBG, "EL rewriter: limit for the number of explored queries reached");
+				return false;
+			}
+		}
+
+		DBGLOG(DBG, "EL rewriter: " << rewritings.size() << " rewritings, " << seen.size() << " queries explored" << (complete ? "" : " (incomplete)"));
+		return complete;
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
@@ -36,6 +36,9 @@
 #endif // HAVE_CONFIG_H
 #include "DLLitePlugin.h"
 #include "ExternalAtoms.h"
+#include "ELRewriter.h"
+#include "SupportSetCache.h"
+#include "AnswerCache.h"
 #include "dlvhex2/PlatformDefinitions.h"
 #include "dlvhex2/ProgramCtx.h"
 #include "dlvhex2/Registry.h"
@@ -43,19 +46,28 @@
 #include "dlvhex2/Printhelpers.h"
 #include "dlvhex2/Logger.h"
 #include "dlvhex2/ExternalLearningHelper.h"
+#include "dlvhex2/Benchmarking.h"
 
 #include <cmath>
 #include <utility>
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <vector>
+#include <map>
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
+#include <iterator>
 #include <stdio.h>
 #include "boost/program_options.hpp"
 #include "boost/range.hpp"
 #include "boost/foreach.hpp"
 #include "boost/filesystem.hpp"
+#include <boost/unordered_set.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/reverse_lock.hpp>
 
 #include "owlcpp/rdf/triple_store.hpp"
 #include "owlcpp/rdf/query_triples.hpp"
@@ -92,16 +104,13 @@ namespace dllite {
 
 	bool DLPluginAtom::Actor_collector::apply(const TaxonomyVertex& node) {
 		DBGLOG(DBG, "Actor collector called with " << node.getPrimer()->getName());
-		std::string returnValue(node.getPrimer()->getName());
 
-		if (node.getPrimer()->getId() == -1
-				|| !ontology->containsNamespace(returnValue)) {
+		// the name is mapped to its term without building strings (after it was seen once)
+		ID tid = (node.getPrimer()->getId() == -1 ? ID_FAIL : ontology->getTermByIri(node.getPrimer()->getName()));
+		if (tid == ID_FAIL) {
 			DBGLOG(DBG,
-					"DLLite reasoner returned constant " << returnValue << ", which seems to be not a valid individual name (will ignore it)");
+					"DLLite reasoner returned constant " << node.getPrimer()->getName() << ", which seems to be not a valid individual name (will ignore it)");
 		} else {
-			ID tid = theDLLitePlugin.storeQuotedConstantTerm(
-					ontology->removeNamespaceFromString(returnValue));
-
 			if (!ontology->concepts->getFact(tid.address)
 					&& !ontology->roles->getFact(tid.address)) {
 				DBGLOG(DBG, "Adding element to tuple (ID=" << tid << ")");
@@ -165,197 +174,478 @@ namespace dllite {
 		DBGLOG(DBG,
 				"Filtering SupportSet " << ng.getStringRepresentation(reg) << " wrt. " << *ontology->conceptAssertions);
 
-		// find guard atom in the nogood
+		// collect the guard atoms in the nogood
+		InterpretationPtr guardAtoms(new Interpretation(reg));
 		BOOST_FOREACH (ID lit, ng) {
 			// since nogoods eliminate "unnecessary" property flags, we need to recover the original ID by retrieving it again
 			ID litID = reg->ogatoms.getIDByAddress(lit.address);
-
-			// check if it is a guard atom
-			if (litID.isAuxiliary()) {
-				const OrdinaryAtom& possibleGuardAtom = reg->ogatoms.getByID(litID);
-				if (possibleGuardAtom.tuple[0] != theDLLitePlugin.guardPredicateID)
-				continue;
-
+			if (litID.isAuxiliary() && reg->ogatoms.getByID(litID).tuple[0] == theDLLitePlugin.guardPredicateID) {
 #ifndef NDEBUG
 				std::string guardStr = theDLLitePlugin.printGuardAtom(litID);
-
 				DBGLOG(DBG,
-						"GUARD: Checking " << (possibleGuardAtom.tuple.size() == 3 ? "concept" : "role") << " guard atom " << guardStr);
+						"GUARD: Checking " << (reg->ogatoms.getByID(litID).tuple.size() == 3 ? "concept" : "role") << " guard atom " << guardStr);
 #endif
+				guardAtoms->setFact(lit.address);
+			}
+		}
+		if (guardAtoms->getStorage().none()) {
+			DBGLOG(DBG,
+					"GUARD: Keeping support set " << ng.getStringRepresentation(reg) << " without guard atom");
+			keep = true;
+			return;
+		}
 
-				// concept or role guard?
-				bool holds;
-				if (possibleGuardAtom.tuple.size() == 3) {
-					// concept guard
-					holds = ontology->checkConceptAssertion(reg, litID);
-				} else {
-					// role guard
-					holds = ontology->checkRoleAssertion(reg, litID);
-				}
-				DBGLOG(DBG,
-						"GUARD: Guard atom " << guardStr << " " << (holds ? " holds" : "does not hold"));
-
-				if (holds) {
-					// remove the guard atom
-					Nogood restricted;
-					BOOST_FOREACH (ID lit2, ng) {
-						if (lit2 != lit) {
-							restricted.insert(lit2);
-						}
-					}
-					DBGLOG(DBG,
-							"GUARD: Keeping support set " << ng.getStringRepresentation(reg) << " with satisfied guard atom " << guardStr << " in form " << restricted.getStringRepresentation(reg));
-					ng = restricted;
-					keep = true;
-					return;
-				} else {
-					DBGLOG(DBG,
-							"GUARD: Removing support set " << ng.getStringRepresentation(reg) << " because guard atom " << guardStr << " is unsatisfied");
-					keep = false;
-					return;
-				}
+		// check all guard atoms in one call
+		InterpretationPtr holding(new Interpretation(reg));
+		ontology->checkGuardAtoms(reg, guardAtoms, holding);
+		if (holding->getStorage().count() != guardAtoms->getStorage().count()) {
+			DBGLOG(DBG,
+					"GUARD: Removing support set " << ng.getStringRepresentation(reg) << " because some guard atom is unsatisfied");
+			keep = false;
+			return;
+		}
+
+		// remove the guard atoms
+		Nogood restricted;
+		BOOST_FOREACH (ID lit, ng) {
+			if (!guardAtoms->getFact(lit.address)) {
+				restricted.insert(lit);
 			}
 		}
 		DBGLOG(DBG,
-				"GUARD: Keeping support set " << ng.getStringRepresentation(reg) << " without guard atom");
+				"GUARD: Keeping support set " << ng.getStringRepresentation(reg) << " with satisfied guard atoms in form " << restricted.getStringRepresentation(reg));
+		ng = restricted;
 		keep = true;
 	}
 
-	std::vector<TDLAxiom*> DLPluginAtom::expandAbox(const Query& query,
-			bool useExistingAbox, bool addAll) {
-		DBGLOG(DBG,"Expand Abox is started with useAbox = "<<useExistingAbox);
+	bool DLPluginAtom::isDLLite() {
+		return !ctx.getPluginData<DLLitePlugin>().el;
+	}
+
+	bool DLPluginAtom::useNativeReasoner() {
+		return isDLLite() && ctx.getPluginData<DLLitePlugin>().queryEngine == DLLitePlugin::CtxData::nativeEngine;
+	}
+
+	NativeReasonerPtr DLPluginAtom::getNativeReasoner(DLLitePlugin::CachedOntologyPtr ontology) {
+		return ontology->getNativeReasoner(ctx);
+	}
+
+	void DLPluginAtom::addInputAtom(const Query& query, DLLitePlugin::CachedOntologyPtr ontology,
+			bool useExistingAbox, IDAddress atom, NativeReasoner::Update& update) {
 		RegistryPtr reg = getRegistry();
 
-		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(
-				ctx, query.input[0], useExistingAbox);
+		// the terms are stored in the same form as in the ontology (quoted and without namespace)
+		const OrdinaryAtom& ogatom = reg->ogatoms.getByAddress(atom);
 
-		// add the additional assertions
-		std::vector<TDLAxiom*> addedAxioms;
+		if (ogatom.tuple[0] == query.input[1]
+				|| ogatom.tuple[0] == query.input[2]) {
+			if (useExistingAbox || ogatom.tuple.size() == 3) {
+				// c+ or c-
+				ID concept = theDLLitePlugin.getQuotedTerm(ogatom.tuple[1]);
+				if (!ontology->concepts->getFact(concept.address) && concept != theDLLitePlugin.storeQuotedConstantTerm("000")) {
+					throw PluginError(
+							"Tried to expand concept "
+							+ RawPrinter::toString(reg, ogatom.tuple[1])
+							+ ", which does not appear in the ontology");
+				}
+				bool negated = (ogatom.tuple.size() == 4 ? ogatom.tuple[3].address == 1 : ogatom.tuple[0] == query.input[2]);
+				update.addConceptAssertion(negated ? theDLLitePlugin.dlNeg(concept) : concept,
+						theDLLitePlugin.getQuotedTerm(ogatom.tuple[2]));
+			}
+		} else if (ogatom.tuple[0] == query.input[3]
+				|| ogatom.tuple[0] == query.input[4]) {
+			// r+ or r-
+			ID role = theDLLitePlugin.getQuotedTerm(ogatom.tuple[1]);
+			if (!ontology->roles->getFact(role.address)) {
+				throw PluginError(
+						"Tried to expand role "
+						+ RawPrinter::toString(reg, ogatom.tuple[1])
+						+ ", which does not appear in the ontology");
+			}
+			update.addRoleAssertion(ogatom.tuple[0] == query.input[4] ? theDLLitePlugin.dlNeg(role) : role,
+					theDLLitePlugin.getQuotedTerm(ogatom.tuple[2]),
+					theDLLitePlugin.getQuotedTerm(ogatom.tuple[3]));
+		} else {
+			assert(false && "Invalid input atom");
+		}
+	}
 
+	void DLPluginAtom::getAboxUpdate(const Query& query, DLLitePlugin::CachedOntologyPtr ontology,
+			bool useExistingAbox, NativeReasoner::Update& update, NativeReasoner::Update* unknown) {
 
-		bm::bvector<>::enumerator en;
-		bm::bvector<>::enumerator en_end;
+		// assertions from the input predicates
+		bm::bvector<>::enumerator en = query.interpretation->getStorage().first();
+		bm::bvector<>::enumerator en_end = query.interpretation->getStorage().end();
+		while (en < en_end) {
+			addInputAtom(query, ontology, useExistingAbox, *en, update);
+			en++;
+		}
 
-		// decide whether everything should be added, or just the assertions from the input predicates
-		if (addAll) {
-			DBGLOG(DBG, "Expanding Abox with all role and concept assertions");
+		// assertions which might still be added (all other atoms of the input predicates)
+		if (unknown) {
 			const ExternalAtom& eatom = query.ctx->registry()->eatoms.getByID(query.eatomID);
 			en = eatom.getPredicateInputMask()->getStorage().first();
 			en_end = eatom.getPredicateInputMask()->getStorage().end();
-		} else {
-			DBGLOG(DBG, "Expanding Abox");
-			en = query.interpretation->getStorage().first();
-			en_end = query.interpretation->getStorage().end();
+			while (en < en_end) {
+				if (!query.interpretation->getFact(*en)) addInputAtom(query, ontology, useExistingAbox, *en, *unknown);
+				en++;
+			}
 		}
+	}
 
-		while (en < en_end) {
-			const OrdinaryAtom& ogatom = reg->ogatoms.getByAddress(*en);
+	UpdateBatchPtr DLPluginAtom::getUpdateBatch(const Query& query, DLLitePlugin::CachedOntologyPtr ontology,
+			bool useExistingAbox, bool withUnknown) {
 
-			DBGLOG(DBG,
-					"Checking " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(*en)));
+		const ExternalAtom& eatom = query.ctx->registry()->eatoms.getByID(query.eatomID);
+		const bm::bvector<>& mask = eatom.getPredicateInputMask()->getStorage();
+		bm::bvector<> inputAtoms = query.interpretation->getStorage() & mask;
+		Tuple inputPredicates(query.input.begin() + 1, query.input.begin() + 5);
+
+		// look for a batch with the same input (a batch with unknown assertions can also be used if they are not needed)
+		{
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			for (std::list<UpdateBatchPtr>::iterator it = ontology->updateBatches.begin(); it != ontology->updateBatches.end(); ++it) {
+				const UpdateBatch& b = **it;
+				if (b.useAbox == useExistingAbox && b.inputPredicates == inputPredicates && b.inputAtoms == inputAtoms
+						&& (!withUnknown || (b.hasUnknown && b.unknownMask == mask))) {
+					DLVHEX_BENCHMARK_REGISTER(sidbatchhits, "DLLite shared updates");
+					DLVHEX_BENCHMARK_COUNT(sidbatchhits, 1);
+					UpdateBatchPtr batch = *it;
+					ontology->updateBatches.splice(ontology->updateBatches.begin(), ontology->updateBatches, it);
+					return batch;
+				}
+			}
+		}
 
-			// determine type of additional assertion
-			if (ogatom.tuple[0] == query.input[1]
-					|| ogatom.tuple[0] == query.input[2]) {
-				if (useExistingAbox||(ogatom.tuple.size() == 3)) {
-				// c+ or c-
-				assert(
-						((ogatom.tuple.size() == 3)
-								|| ((ogatom.tuple.size() == 4)
-										&& (ogatom.tuple[3].address <= 1)
-										&& (ogatom.tuple[3].isIntegerTerm())))
-						&& "Second parameter must be a binary predicate");
-				ID concept = ogatom.tuple[1];
-				ID newauxIDun = theDLLitePlugin.storeQuotedConstantTerm("000");
-				if ((!ontology->concepts->getFact(concept.address))&&(concept!=newauxIDun)) {
-					throw PluginError(
-							"Tried to expand concept "
-							+ RawPrinter::toString(reg, concept)
-							+ ", which does not appear in the ontology");
+		UpdateBatchPtr batch(new UpdateBatch());
+		batch->inputPredicates = inputPredicates;
+		batch->useAbox = useExistingAbox;
+		batch->inputAtoms = inputAtoms;
+		batch->hasUnknown = withUnknown;
+		if (withUnknown) batch->unknownMask = mask;
+		getAboxUpdate(query, ontology, useExistingAbox, batch->update, withUnknown ? &batch->unknown : NULL);
+
+		// only the most recent inputs are kept, since the interpretation changes over time
+		const std::size_t maxBatches = ctx.getPluginData<DLLitePlugin>().updatebatches;
+		boost::mutex::scoped_lock lock(ontology->mutex);
+		ontology->updateBatches.push_front(batch);
+		while (ontology->updateBatches.size() > maxBatches) ontology->updateBatches.pop_back();
+		return batch;
+	}
+
+	bool DLPluginAtom::isConsistent(DLLitePlugin::CachedOntologyPtr ontology, UpdateBatch& batch, bool possibly) {
+
+		boost::mutex::scoped_lock lock(batch.mutex);
+		if (batch.consistent == -1) batch.consistent = (isConsistent(ontology, batch.update) ? 1 : 0);
+		if (!possibly || batch.consistent == 0) return batch.consistent == 1;
+
+		assert(batch.hasUnknown && "unknown assertions were not collected");
+		if (batch.possiblyConsistent == -1) {
+			NativeReasoner::Update possibleUpdate(batch.update);
+			possibleUpdate.add(batch.unknown);
+			batch.possiblyConsistent = (isConsistent(ontology, possibleUpdate) ? 1 : 0);
+		}
+		return batch.possiblyConsistent == 1;
+	}
+
+	const NativeReasoner::Individuals& DLPluginAtom::getKernelInstances(DLLitePlugin::CachedOntologyPtr ontology, ID concept) {
+
+		RegistryPtr reg = getRegistry();
+		{
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			boost::unordered_map<IDAddress, bm::bvector<> >::const_iterator it = ontology->kernelInstances.find(concept.address);
+			if (it != ontology->kernelInstances.end()) return it->second;
+
+			// make sure that the kernel is filled (this is delayed if the ontology was restored from a snapshot)
+			ontology->loadReasoner();
+		}
+
+		// unknown concepts are not sent to the kernel since this would extend its signature
+		NativeReasoner::Individuals instances;
+		bool negated = theDLLitePlugin.isDlNeg(concept);
+		ID positiveConcept = (negated ? theDLLitePlugin.dlNeg(concept) : concept);
+		if (ontology->concepts->getFact(positiveConcept.address)) {
+			// the kernel is leased from the pool, thus other DL-atoms can query further kernels meanwhile
+			DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+			DBGLOG(DBG, "Sending concept query for " << RawPrinter::toString(reg, concept) << " to the kernel");
+			Answer kernelAnswer;
+			Actor_collector ret(reg, kernelAnswer, ontology, Actor_collector::Concept, false);
+			try {
+				kernel->getInstances(kernel.getConcept(concept), ret);
+			} catch (...) {
+				throw PluginError(
+						"DLLite reasoner failed during concept query");
+			}
+			BOOST_FOREACH (const Tuple& tup, kernelAnswer.get()) {
+				instances.set_bit(tup[0].address);
+			}
+		}
+
+		// if another DL-atom computed the same answer meanwhile, the existing one is kept
+		boost::mutex::scoped_lock lock(ontology->mutex);
+		return ontology->kernelInstances.insert(std::make_pair(concept.address, instances)).first->second;
+	}
+
+	void DLPluginAtom::expandKernel(DLLitePlugin::CachedOntologyPtr ontology, DLLitePlugin::CachedOntology::KernelLease& kernel,
+			const NativeReasoner::Update& update) {
+
+		RegistryPtr reg = getRegistry();
+		NativeReasoner::Individuals names;	// individuals of the update
+		try {
+			// assertions of concepts which do not occur in the Tbox have no consequences and are not sent to the kernel
+			typedef std::pair<IDAddress, NativeReasoner::Individuals> ConceptPair;
+			BOOST_FOREACH (const ConceptPair& cp, update.concepts) {
+				ID concept = reg->terms.getIDByAddress(cp.first);
+				ID positiveConcept = (theDLLitePlugin.isDlNeg(concept) ? theDLLitePlugin.dlNeg(concept) : concept);
+				if (!ontology->concepts->getFact(positiveConcept.address)) continue;
+				names |= cp.second;
+				bm::bvector<>::enumerator en = cp.second.first();
+				bm::bvector<>::enumerator en_end = cp.second.end();
+				while (en < en_end) {
+					kernel.addAxiom(kernel->instanceOf(kernel.getIndividual(reg->terms.getIDByAddress(*en)), kernel.getConcept(concept)));
+					en++;
 				}
-				ID individual = ogatom.tuple[2];
-				DBGLOG(DBG,
-						"Adding concept assertion: " << (ogatom.tuple[0] == query.input[2] ? "-" : "") << reg->terms.getByID(concept).getUnquotedString() << "(" << reg->terms.getByID(individual).getUnquotedString() << ")");
-				TDLConceptExpression* factppConcept =
-				ontology->kernel->getExpressionManager()->Concept(
-						ontology->addNamespaceToString(
-								reg->terms.getByID(concept).getUnquotedString()));
-				if (ogatom.tuple.size() == 4) {
-					if (ogatom.tuple[3].address == 1) {
-						factppConcept = ontology->kernel->getExpressionManager()->Not(factppConcept);
-					}
-				} else if (ogatom.tuple[0] == query.input[2]) {
-					factppConcept = ontology->kernel->getExpressionManager()->Not(factppConcept);
+			}
+			typedef std::pair<IDAddress, NativeReasoner::Pairs> RolePair;
+			BOOST_FOREACH (const RolePair& rp, update.roles) {
+				ID role = reg->terms.getIDByAddress(rp.first);
+				bool negated = theDLLitePlugin.isDlNeg(role);
+				TDLObjectRoleExpression* factppRole = kernel.getRole(negated ? theDLLitePlugin.dlNeg(role) : role);
+				BOOST_FOREACH (const NativeReasoner::Pair& pair, rp.second) {
+					names.set_bit(pair.first);
+					names.set_bit(pair.second);
+					TDLIndividualExpression* first = kernel.getIndividual(reg->terms.getIDByAddress(pair.first));
+					TDLIndividualExpression* second = kernel.getIndividual(reg->terms.getIDByAddress(pair.second));
+					kernel.addAxiom(negated ? kernel->relatedToNot(first, factppRole, second) : kernel->relatedTo(first, factppRole, second));
 				}
+			}
 
-				addedAxioms.push_back(
-						ontology->kernel->instanceOf(
-								ontology->kernel->getExpressionManager()->Individual(
-										ontology->addNamespaceToString(
-												reg->terms.getByID(individual).getUnquotedString())),
-								factppConcept));}
-			} else if (ogatom.tuple[0] == query.input[3]
-					|| ogatom.tuple[0] == query.input[4]) {
-				// r+ or r-
-				assert(
-						ogatom.tuple.size() == 4
-						&& "Second parameter must be a ternery predicate");
-				ID role = ogatom.tuple[1];
-				if (!ontology->roles->getFact(role.address)) {
-					throw PluginError(
-							"Tried to expand role "
-							+ RawPrinter::toString(reg, role)
-							+ ", which does not appear in the ontology");
-				}
-				ID individual1 = ogatom.tuple[2];
-				ID individual2 = ogatom.tuple[3];
-				DBGLOG(DBG,
-						"Adding role assertion: " << (ogatom.tuple[0] == query.input[4] ? "-" : "") << reg->terms.getByID(role).getUnquotedString() << "(" << reg->terms.getByID(individual1).getUnquotedString() << ", " << reg->terms.getByID(individual2).getUnquotedString() << ")");
-				TDLObjectRoleExpression* factppRole =
-				ontology->kernel->getExpressionManager()->ObjectRole(
-						ontology->addNamespaceToString(
-								reg->terms.getByID(role).getUnquotedString()));
-
-				if (ogatom.tuple[0] == query.input[4]) {
-					addedAxioms.push_back(
-							ontology->kernel->relatedToNot(
-									ontology->kernel->getExpressionManager()->Individual(
-											ontology->addNamespaceToString(
-													reg->terms.getByID(individual1).getUnquotedString())),
-									factppRole,
-									ontology->kernel->getExpressionManager()->Individual(
-											ontology->addNamespaceToString(
-													reg->terms.getByID(individual2).getUnquotedString()))));
-				} else {
-					addedAxioms.push_back(
-							ontology->kernel->relatedTo(
-									ontology->kernel->getExpressionManager()->Individual(
-											ontology->addNamespaceToString(
-													reg->terms.getByID(individual1).getUnquotedString())),
-									factppRole,
-									ontology->kernel->getExpressionManager()->Individual(
-											ontology->addNamespaceToString(
-													reg->terms.getByID(individual2).getUnquotedString()))));
+			// new individuals must also be different from those of the ontology (unique name assumption, see NativeReasoner)
+			names -= ontology->individuals->getStorage();
+			if (ontology->functionalRoles && names.any()) kernel.addUniqueNames(names);
+		} catch (...) {
+			throw PluginError(
+					"DLLite reasoner failed while expanding the Abox");
+		}
+	}
+
+	bool DLPluginAtom::isConsistent(DLLitePlugin::CachedOntologyPtr ontology, const NativeReasoner::Update& update) {
+
+		if (useNativeReasoner()) return getNativeReasoner(ontology)->isConsistent(update);
+
+		// the kernel checks the unmodified Abox once and the Abox expanded by each update
+		int kernelConsistent;
+		{
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			kernelConsistent = ontology->kernelConsistent;
+			if (kernelConsistent == -1) ontology->loadReasoner();
+		}
+		if (kernelConsistent == -1) {
+			// the kernel is leased without holding the lock of the ontology (if another DL-atom checked the Abox meanwhile,
+			// it came to the same result)
+			{
+				DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+				kernelConsistent = (kernel->isKBConsistent() ? 1 : 0);
+			}
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			ontology->kernelConsistent = kernelConsistent;
+		}
+		if (kernelConsistent == 0) return false;
+		if (update.empty()) return true;
+
+		DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+		expandKernel(ontology, kernel, update);
+		try {
+			return kernel->isKBConsistent();
+		} catch (...) {
+			throw PluginError(
+					"DLLite reasoner failed during consistency check");
+		}
+	}
+
+	void DLPluginAtom::getInstances(DLLitePlugin::CachedOntologyPtr ontology, ID concept,
+			const NativeReasoner::Update& update, NativeReasoner::Individuals& instances) {
+
+		if (useNativeReasoner()) {
+			getNativeReasoner(ontology)->getInstances(concept, update, true, instances);
+		} else if (update.empty()) {
+			instances |= getKernelInstances(ontology, concept);
+		} else {
+			getExpandedInstances(ontology, concept, update, instances);
+		}
+	}
+
+	void DLPluginAtom::getExpandedInstances(DLLitePlugin::CachedOntologyPtr ontology, ID concept,
+			const NativeReasoner::Update& update, NativeReasoner::Individuals& instances) {
+
+		// a concept which does not occur in the Tbox has only the instances asserted by the update
+		bool negated = theDLLitePlugin.isDlNeg(concept);
+		ID positiveConcept = (negated ? theDLLitePlugin.dlNeg(concept) : concept);
+		if (!ontology->concepts->getFact(positiveConcept.address)) {
+			boost::unordered_map<IDAddress, NativeReasoner::Individuals>::const_iterator it = update.concepts.find(concept.address);
+			if (it != update.concepts.end()) instances |= it->second;
+			return;
+		}
+		{
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			ontology->loadReasoner();
+		}
+
+		RegistryPtr reg = getRegistry();
+		DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+		expandKernel(ontology, kernel, update);
+		DBGLOG(DBG, "Sending concept query for " << RawPrinter::toString(reg, concept) << " to the kernel with expanded Abox");
+		Answer kernelAnswer;
+		Actor_collector ret(reg, kernelAnswer, ontology, Actor_collector::Concept, false);
+		try {
+			kernel->getInstances(kernel.getConcept(concept), ret);
+		} catch (...) {
+			throw PluginError(
+					"DLLite reasoner failed during concept query");
+		}
+		BOOST_FOREACH (const Tuple& tup, kernelAnswer.get()) {
+			instances.set_bit(tup[0].address);
+		}
+	}
+
+	void DLPluginAtom::getRoleExtension(DLLitePlugin::CachedOntologyPtr ontology, ID role,
+			const NativeReasoner::Update& update, NativeReasoner::Pairs& extension) {
+
+		if (useNativeReasoner()) {
+			getNativeReasoner(ontology)->getRoleExtension(role, update, true, extension);
+			return;
+		}
+
+		// a role which does not occur in the Tbox has only the pairs asserted by the update
+		RegistryPtr reg = getRegistry();
+		boost::unordered_map<IDAddress, NativeReasoner::Pairs>::const_iterator it = update.roles.find(role.address);
+		if (!ontology->roles->getFact(role.address)) {
+			if (it != update.roles.end()) extension = it->second;
+		} else {
+			{
+				boost::mutex::scoped_lock lock(ontology->mutex);
+				ontology->loadReasoner();
+			}
+
+			// the kernel answers a separate query for each individual of the ontology and of the update
+			NativeReasoner::Individuals individuals = ontology->individuals->getStorage();
+			typedef std::pair<IDAddress, NativeReasoner::Individuals> ConceptPair;
+			BOOST_FOREACH (const ConceptPair& cp, update.concepts) individuals |= cp.second;
+			typedef std::pair<IDAddress, NativeReasoner::Pairs> RolePair;
+			BOOST_FOREACH (const RolePair& rp, update.roles) {
+				BOOST_FOREACH (const NativeReasoner::Pair& pair, rp.second) {
+					individuals.set_bit(pair.first);
+					individuals.set_bit(pair.second);
 				}
-			} else {
-				assert(false && "Invalid input atom");
 			}
 
-			en++;
+			DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+			if (!update.empty()) expandKernel(ontology, kernel, update);
+			DBGLOG(DBG, "Sending role queries for " << RawPrinter::toString(reg, role) << " to the kernel");
+			bm::bvector<>::enumerator en = individuals.first();
+			bm::bvector<>::enumerator en_end = individuals.end();
+			while (en < en_end) {
+				getRoleFillers(ontology, kernel, role, *en, extension);
+				en++;
+			}
 		}
-		return addedAxioms;
+		std::sort(extension.begin(), extension.end());
+		extension.erase(std::unique(extension.begin(), extension.end()), extension.end());
 	}
 
-	void DLPluginAtom::restoreAbox(const Query& query,
-			std::vector<TDLAxiom*> addedAxioms) {
+	void DLPluginAtom::getRoleFillers(DLLitePlugin::CachedOntologyPtr ontology, DLLitePlugin::CachedOntology::KernelLease& kernel,
+			ID role, IDAddress individual, NativeReasoner::Pairs& pairs) {
 
-		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(
-				ctx, query.input[0]);
+		std::vector<const TNamedEntry*> related;
+		try {
+			kernel->getRoleFillers(kernel.getIndividual(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, individual)), kernel.getRole(role), related);
+		} catch (...) {
+			throw PluginError(
+					"DLLite reasoner failed during role query");
+		}
+		BOOST_FOREACH (const TNamedEntry* entry, related) {
+			ID second = ontology->getTermByIri(entry->getName());
+			if (second != ID_FAIL) pairs.push_back(NativeReasoner::Pair(individual, second.address));
+		}
+	}
+
+	bool DLPluginAtom::isOutputBound(const Query& query) {
+
+		if (query.pattern.empty()) return false;
+		BOOST_FOREACH (ID term, query.pattern) {
+			if (!term.isConstantTerm()) return false;
+		}
+		return true;
+	}
+
+	bool DLPluginAtom::isInstance(DLLitePlugin::CachedOntologyPtr ontology, ID concept, IDAddress individual,
+			const NativeReasoner::Update& update) {
+
+		if (useNativeReasoner()) return getNativeReasoner(ontology)->isInstance(concept, individual, update, true);
+
+		// a non-empty update is added to the kernel (see getInstances)
+		bool expand = !update.empty();
+
+		// answers of the kernel over the unmodified Abox are reused if the extension of the concept is already known
+		{
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			boost::unordered_map<IDAddress, bm::bvector<> >::const_iterator it = ontology->kernelInstances.find(concept.address);
+			if (!expand && it != ontology->kernelInstances.end()) return it->second.get_bit(individual);
+			ontology->loadReasoner();
+		}
+
+		// unknown concepts and individuals are not sent to the kernel since this would extend its signature
+		// (individuals of an expanded Abox are part of it, and unknown concepts have only the asserted instances)
+		RegistryPtr reg = getRegistry();
+		bool negated = theDLLitePlugin.isDlNeg(concept);
+		ID positiveConcept = (negated ? theDLLitePlugin.dlNeg(concept) : concept);
+		if (!ontology->concepts->getFact(positiveConcept.address)) {
+			if (!expand) return false;
+			boost::unordered_map<IDAddress, NativeReasoner::Individuals>::const_iterator it = update.concepts.find(concept.address);
+			return it != update.concepts.end() && it->second.get_bit(individual);
+		}
+		if (!expand && !ontology->individuals->getFact(individual)) return false;
+
+		DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+		if (expand) expandKernel(ontology, kernel, update);
+		DBGLOG(DBG, "Sending instance check for " << RawPrinter::toString(reg, concept) << " to the kernel");
+		try {
+			return kernel->isInstance(kernel.getIndividual(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, individual)), kernel.getConcept(concept));
+		} catch (...) {
+			throw PluginError(
+					"DLLite reasoner failed during instance check");
+		}
+	}
+
+	bool DLPluginAtom::isRoleMember(DLLitePlugin::CachedOntologyPtr ontology, ID role, IDAddress first, IDAddress second,
+			const NativeReasoner::Update& update) {
+
+		if (useNativeReasoner()) return getNativeReasoner(ontology)->isRoleMember(role, first, second, update, true);
 
-		// remove the axioms again
-		BOOST_FOREACH (TDLAxiom* ax, addedAxioms) {
-			ontology->kernel->retract(ax);
+		// only the fillers of the first individual are queried (see getRoleExtension)
+		boost::unordered_map<IDAddress, NativeReasoner::Pairs>::const_iterator it = update.roles.find(role.address);
+		if (it != update.roles.end() && std::find(it->second.begin(), it->second.end(), NativeReasoner::Pair(first, second)) != it->second.end()) return true;
+		if (!ontology->roles->getFact(role.address)) return false;
+		{
+			boost::mutex::scoped_lock lock(ontology->mutex);
+			ontology->loadReasoner();
 		}
+
+		// an individual which occurs neither in the ontology nor in the update has no fillers
+		bool known = ontology->individuals->getFact(first);
+		typedef std::pair<IDAddress, NativeReasoner::Individuals> ConceptPair;
+		BOOST_FOREACH (const ConceptPair& cp, update.concepts) known = known || cp.second.get_bit(first);
+		typedef std::pair<IDAddress, NativeReasoner::Pairs> RolePair;
+		BOOST_FOREACH (const RolePair& rp, update.roles) {
+			BOOST_FOREACH (const NativeReasoner::Pair& pair, rp.second) known = known || pair.first == first || pair.second == first;
+		}
+		if (!known) return false;
+
+		NativeReasoner::Pairs pairs;
+		DLLitePlugin::CachedOntology::KernelLease kernel(*ontology);
+		if (!update.empty()) expandKernel(ontology, kernel, update);
+		getRoleFillers(ontology, kernel, role, first, pairs);
+		return std::find(pairs.begin(), pairs.end(), NativeReasoner::Pair(first, second)) != pairs.end();
 	}
 
 	void DLPluginAtom::retrieve(const Query& query, Answer& answer) {
@@ -364,15 +654,158 @@ namespace dllite {
 				&& "this method should never be called since the learning-based method is present");
 	}
 
+	void DLPluginAtom::retrieve(const Query& query, Answer& answer,
+			NogoodContainerPtr nogoods) {
+
+		DLLitePlugin::CtxData& ctxdata = ctx.getPluginData<DLLitePlugin>();
+		if (ctxdata.answercache == 0) {
+			evaluate(query, answer);
+			return;
+		}
+		AnswerCache::Key key(query, prop.providesPartialAnswer);
+		{
+			boost::mutex::scoped_lock lock(answerCacheMutex);
+			if (!answerCache) answerCache = AnswerCachePtr(new AnswerCache((std::size_t)ctxdata.answercache * 1024 * 1024));
+			if (answerCache->lookup(key, answer)) {
+				DLVHEX_BENCHMARK_REGISTER(sidanswercachehits, "DLLite answer cache hits");
+				DLVHEX_BENCHMARK_COUNT(sidanswercachehits, 1);
+				DBGLOG(DBG, "Answer of " << predName << " taken from cache (" << answerCache->getHits() << " hits, " << answerCache->getMisses() << " misses)");
+				return;
+			}
+		}
+		DLVHEX_BENCHMARK_REGISTER(sidanswercachemisses, "DLLite answer cache misses");
+		DLVHEX_BENCHMARK_COUNT(sidanswercachemisses, 1);
+
+		// the evaluation runs outside of the lock, such that different queries to this DL-atom can be answered concurrently
+		evaluate(query, answer);
+		boost::mutex::scoped_lock lock(answerCacheMutex);
+		answerCache->store(key, answer);
+	}
+
+	// builds the Requiem query for a concept (quotes are dropped as they were by the shell in earlier versions)
+	static std::string getRequiemQuery(const std::string& concept) {
+		std::string c = concept;
+		c.erase(std::remove(c.begin(), c.end(), '"'), c.end());
+		return "Q(?0)  <-  " + c + "(?0)";
+	}
+
+	// returns the concepts queried by cDL-atoms
+	static std::vector<ID> getConceptQueries(RegistryPtr reg) {
+		ID cdlID = reg->storeConstantTerm("cDL");
+		std::vector<ID> concepts;
+		ExternalAtomTable::PredicateIterator eit, eit_end;
+		for (boost::tie(eit, eit_end) = reg->eatoms.getRangeByPredicateID(cdlID); eit != eit_end; ++eit) {
+			if (eit->inputs.size() > 5 && eit->inputs[5].isConstantTerm()) concepts.push_back(eit->inputs[5]);
+		}
+		return concepts;
+	}
+
+	// translates a rewriting from Requiem (e.g. "A(X) R(X,Y)") to a set of nonground atoms as computed by the native rewriter
+	static Nogood parseRequiemRewriting(RegistryPtr reg, const std::string& rewriting) {
+		std::vector<std::string> strs;
+		boost::split(strs, rewriting, boost::is_any_of("\t "), boost::token_compress_on);
+
+		Nogood ng;
+		BOOST_FOREACH (std::string str, strs) {
+			if (str.empty()) continue;
+			std::size_t varb = str.find("(");
+			std::size_t vare = str.find(")");
+			std::size_t varm = str.find(",");
+			if (varb == std::string::npos) {
+				assert(false && "output from requiem has a form that is not expected");
+			}
+
+			OrdinaryAtom oatom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYN);
+			oatom.tuple.push_back(reg->storeConstantTerm("\"" + str.substr(0, varb) + "\""));
+			if (varm != std::string::npos) {
+				oatom.tuple.push_back(reg->storeVariableTerm(str.substr(varb + 1, varm - varb - 1)));
+				oatom.tuple.push_back(reg->storeVariableTerm(str.substr(varm + 1, vare - varm - 1)));
+			}
+			else {
+				oatom.tuple.push_back(reg->storeVariableTerm(str.substr(varb + 1, vare - varb - 1)));
+			}
+			ng.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(oatom)));
+		}
+		return ng;
+	}
+
+	RequiemWorkerPoolPtr DLPluginAtom::getRequiemWorkerPool(const std::string& ontologyPath) {
+
+		DLLitePlugin::CtxData& ctxdata = ctx.getPluginData<DLLitePlugin>();
+		std::map<std::string, RequiemWorkerPoolPtr>::iterator it = ctxdata.requiemWorkerPools.find(ontologyPath);
+		if (it != ctxdata.requiemWorkerPools.end()) return it->second;
+
+		std::string path = std::string(PLUGIN_DIR)+std::string("/requiem/dist/requiem-cli.jar");
+		DBGLOG(DBG, "LSS: EL: the path to requiem is : " <<path);
+		RequiemWorkerPoolPtr pool(new RequiemWorkerPool(path, ontologyPath, ctxdata.requiemworkers));
+		ctxdata.requiemWorkerPools[ontologyPath] = pool;
+
+		// rewrite the queries of all concept DL-atoms at once
+		RegistryPtr reg = getRegistry();
+		std::vector<std::string> queries;
+		BOOST_FOREACH (ID concept, getConceptQueries(reg)) queries.push_back(getRequiemQuery(RawPrinter::toString(reg, concept)));
+		pool->prefetch(queries);
+		return pool;
+	}
+
+	SupportSetCachePtr DLPluginAtom::getSupportSetCache(const Query& query) {
+
+		DLLitePlugin::CtxData& ctxdata = ctx.getPluginData<DLLitePlugin>();
+		if (ctxdata.cachedir == "") return SupportSetCachePtr();
+		RegistryPtr reg = getRegistry();
+
+		// in EL mode the support sets are computed wrt. the ontology given on the command-line
+		ID ontologyName = query.input[0];
+		if (ctxdata.el && ctxdata.repair) ontologyName = reg->storeConstantTerm(ctxdata.repairOntology);
+		else if (ctxdata.el && ctxdata.rewrite) ontologyName = reg->storeConstantTerm(ctxdata.ontology);
+
+		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(ctx, ontologyName);
+		if (ontology->fileHash == "") return SupportSetCachePtr();
+		if (!ontology->supportSetCache) {
+			std::string filename = (boost::filesystem::path(ctxdata.cachedir) / (ontology->fileHash + ".supportsets")).string();
+			ontology->supportSetCache = SupportSetCachePtr(new SupportSetCache(reg, filename, theDLLitePlugin.guardPredicateID));
+		}
+		return ontology->supportSetCache;
+	}
+
+	ID DLPluginAtom::storeLearnedAtom(const OrdinaryAtom& atom) {
+		boost::mutex::scoped_lock lock(ctx.getPluginData<DLLitePlugin>().learningMutex);
+		return getRegistry()->storeOrdinaryAtom(atom);
+	}
+
 	void DLPluginAtom::learnSupportSets(const Query& query, NogoodContainerPtr nogoods) {
 
 		DBGLOG(DBG, "LSS: learning support sets started");
+
+		// support sets of several DL-atoms may be learned concurrently (see RepairModelGenerator::learnSupportFamilies);
+		// since learning writes to the registry and the plugin data, only the parts which do not need them run in parallel
+		// (the search of the EL rewriter and the analysis of the classification in DL-Lite)
+		boost::unique_lock<boost::mutex> lock(ctx.getPluginData<DLLitePlugin>().learningMutex);
 		const ExternalAtom& eatom = query.ctx->registry()->eatoms.getByID(query.eatomID);
 
 		// prepare variables for storing query and a nogood container
 		std::string querystr;
 		SimpleNogoodContainerPtr potentialSupportSets = SimpleNogoodContainerPtr(new SimpleNogoodContainer());
 
+		// reuse the support family of an earlier run if neither the ontology nor the query and its input predicates changed
+		SupportSetCachePtr cache = getSupportSetCache(query);
+		std::string cacheKey;
+		std::size_t incompleteCount = ctx.getPluginData<DLLitePlugin>().incompletedlat.size();
+		if (!!cache) {
+			std::stringstream options;
+			options << "el=" << ctx.getPluginData<DLLitePlugin>().el << " requiem=" << ctx.getPluginData<DLLitePlugin>().requiem
+			        << " supsize=" << ctx.getPluginData<DLLitePlugin>().supsize << " supnumber=" << ctx.getPluginData<DLLitePlugin>().supnumber;
+			cacheKey = SupportSetCache::getKey(getRegistry(), query, options.str());
+
+			bool incomplete = false;
+			if (cache->lookup(cacheKey, query, potentialSupportSets, incomplete)) {
+				DBGLOG(DBG, "LSS: restored " << potentialSupportSets->getNogoodCount() << " support sets from cache");
+				if (incomplete) ctx.getPluginData<DLLitePlugin>().incompletedlat.push_back(eatom.inputs[5]);
+				optimizeSupportSets(potentialSupportSets, nogoods);
+				return;
+			}
+		}
+
 		// case when the ontology is in el
 
 		if (ctx.getPluginData<DLLitePlugin>().el) {
@@ -435,13 +868,16 @@ namespace dllite {
 			DBGLOG(DBG, "LSS: EL: ABox predicates are: ");
 			std::vector<ID> abp;
 			std::string opath;
+			DLLitePlugin::CachedOntologyPtr ontology;
 			if (ctx.getPluginData<DLLitePlugin>().repair) {
-				abp =theDLLitePlugin.prepareOntology(ctx,reg->storeConstantTerm(ctx.getPluginData<DLLitePlugin>().repairOntology))->AboxPredicates;
-				opath = std::string(theDLLitePlugin.prepareOntology(ctx,reg->storeConstantTerm(ctx.getPluginData<DLLitePlugin>().repairOntology))->ontologyPath);
+				ontology = theDLLitePlugin.prepareOntology(ctx,reg->storeConstantTerm(ctx.getPluginData<DLLitePlugin>().repairOntology));
+				abp = ontology->AboxPredicates;
+				opath = ontology->ontologyPath;
 			}
 			else if (ctx.getPluginData<DLLitePlugin>().rewrite) {
-				abp =theDLLitePlugin.prepareOntology(ctx,reg->storeConstantTerm(ctx.getPluginData<DLLitePlugin>().ontology))->AboxPredicates;
-				opath = std::string(theDLLitePlugin.prepareOntology(ctx,reg->storeConstantTerm(ctx.getPluginData<DLLitePlugin>().ontology))->ontologyPath);
+				ontology = theDLLitePlugin.prepareOntology(ctx,reg->storeConstantTerm(ctx.getPluginData<DLLitePlugin>().ontology));
+				abp = ontology->AboxPredicates;
+				opath = ontology->ontologyPath;
 			}
 
 			BOOST_FOREACH(ID id,abp) {
@@ -474,27 +910,8 @@ namespace dllite {
 			}
 
 
-			// getting support sets from Requiem tool
-			FILE *in;
-			char buff[512];
-			std::string param = (cQID != ID_FAIL) ? std::string("(?0)") : std::string("(?0,?1)");
-			std::string path = std::string(PLUGIN_DIR)+std::string("/requiem/dist/requiem-cli.jar");
-			//std::string path = "/usr/local/lib/dlvhex/plugins"+std::string("/requiem/dist/requiem-cli.jar");
-
-
-			DBGLOG(DBG, "LSS: EL: the path to requiem is : " <<path);
+			// getting support sets from the rewritings of the query
 			if (cQID != ID_FAIL) {
-				std::string call = "java -Xmx1000M -jar "+path+" \"Q(?0)  <-  "+std::string(querystr)+param+"\" "+opath+" F";
-
-				DBGLOG(DBG, "LSS: EL: sending call to Requiem " << call);
-
-#ifdef WIN32
-				assert(false && "requiem not supported under Windows");
-#else
-				if(!(in = popen(call.c_str(), "r"))) {
-					assert(false&&"call to requiem failed");
-				}
-
 				bool computed_all_rewritings=true;
 				bool get_further_rewritings=true;
 
@@ -502,10 +919,50 @@ namespace dllite {
 					get_further_rewritings=false;
 					computed_all_rewritings=false;
 				}
-				int number_of_considered_rewritings=0;	             
-	
-				while((fgets(buff, sizeof(buff), in)!=NULL)&&get_further_rewritings) {
-					DBGLOG(DBG, "LSS: EL: got query rewriting from Requiem " << buff);
+				int number_of_considered_rewritings=0;
+
+				// each rewriting is a set of nonground atoms over ontology predicates
+				std::vector<Nogood> rewritings;
+				if (ctx.getPluginData<DLLitePlugin>().requiem) {
+					std::string call = getRequiemQuery(querystr);
+
+					DBGLOG(DBG, "LSS: EL: requesting rewritings from Requiem " << call);
+					BOOST_FOREACH (const std::string& rewriting, getRequiemWorkerPool(opath)->getRewritings(call)) {
+						rewritings.push_back(parseRequiemRewriting(reg, rewriting));
+					}
+				}
+				else if (get_further_rewritings) {
+					if (!ontology) ontology = theDLLitePlugin.prepareOntology(ctx, query.input[0]);
+					if (!ontology->elRewriter) {
+						ontology->loadReasoner();
+						ontology->elRewriter = ELRewriterPtr(new ELRewriter(*ontology, getConceptQueries(reg)));
+					}
+
+					// only rewritings over predicates of the Abox or the maximal input can form support sets
+					std::set<ID> relevant(abp.begin(), abp.end());
+					typedef std::pair<ID, std::vector<ID> > InputPair;
+					BOOST_FOREACH (const InputPair& p, maxinput) relevant.insert(p.first);
+
+					DBGLOG(DBG, "LSS: EL: computing rewritings natively");
+					std::vector<ELRewriter::ConjunctiveQuery> queries;
+					bool complete;
+					{
+						// the search does not access the registry, thus other DL-atoms can be processed meanwhile
+						boost::reverse_lock<boost::unique_lock<boost::mutex> > unlock(lock);
+						complete = ontology->elRewriter->rewrite(cQID, relevant, ctx.getPluginData<DLLitePlugin>().supsize, ctx.getPluginData<DLLitePlugin>().supnumber, queries);
+					}
+					if (!complete) {
+						DBGLOG(DBG, "LSS: EL: the rewriting is not complete");
+						computed_all_rewritings=false;
+					}
+					BOOST_FOREACH (const ELRewriter::ConjunctiveQuery& q, queries) {
+						rewritings.push_back(Nogood());
+						ontology->elRewriter->toNogood(q, rewritings.back());
+					}
+				}
+
+				for (std::vector<Nogood>::const_iterator rewriting = rewritings.begin(); rewriting != rewritings.end() && get_further_rewritings; ++rewriting) {
+					DBGLOG(DBG, "LSS: EL: got query rewriting " << rewriting->getStringRepresentation(reg));
 					if ((ctx.getPluginData<DLLitePlugin>().supnumber!=-1)&&(number_of_considered_rewritings>ctx.getPluginData<DLLitePlugin>().supnumber)) {
 						DBGLOG(DBG,"LSS: EL: we stop computing further rewritings, the limit for the number of rewritings allowed for computation is reached");
 						computed_all_rewritings=false;
@@ -514,12 +971,7 @@ namespace dllite {
 					}
 				
 
-					std::vector<std::string> strs;
-					boost::split(strs, buff, boost::is_any_of("\t "), boost::token_compress_on);
-					std::vector<std::string>::iterator row_it = strs.begin();
-					std::vector<std::string>::iterator row_end = strs.end();
-
-					DBGLOG(DBG, "LSS: EL: start parsing the rewriting");
+					DBGLOG(DBG, "LSS: EL: start processing the rewriting");
 					bool sup=true;
 					Nogood supportset;
 
@@ -537,10 +989,10 @@ namespace dllite {
 					std::vector<std::vector<dlvhex::ID> > ngset;
 
 					int rewriting_size=0;
-					while (row_it<row_end) {
+					BOOST_FOREACH (ID lit, *rewriting) {
 
-						std::string str (*row_it);
-						DBGLOG(DBG, "LSS: EL: current atom of the rewriting is: " << *row_it);
+						const OrdinaryAtom& ratom = reg->lookupOrdinaryAtom(lit);
+						DBGLOG(DBG, "LSS: EL: current atom of the rewriting is: " << RawPrinter::toString(reg, lit));
 						rewriting_size++;
 
 						if ((ctx.getPluginData<DLLitePlugin>().supsize!=-1)&&(rewriting_size>ctx.getPluginData<DLLitePlugin>().supsize)) {
@@ -550,28 +1002,14 @@ namespace dllite {
 							break;
 						}
 
-						std::size_t varb = str.find("(");
-						std::size_t vare = str.find(")");
-						std::size_t varm = str.find(",");
-						std::string var1;
-						std::string var2;
-						bool r=false;
-						std::string pred;
-
-						if (varb!=std::string::npos) {
-							pred = str.substr(0,varb);
-						}
-
-						else {assert(false&&"output from requiem has a form that is not expected");
-						}
-
-						pred = "\""+pred+"\"";
+						bool r = (ratom.tuple.size() == 3);
+						ID opID = ratom.tuple[0];
+						std::string pred = RawPrinter::toString(reg, opID);
 						DBGLOG(DBG, "LSS: EL: quoted predicate name is " << pred<<" check its relevance");
-						ID opID = reg->terms.getIDByString(pred);
 
 
 						// check whether the obtained predicate occurs in the ABox
-						if ((std::find(abp.begin(), abp.end(), opID) == abp.end())&&(maxinput.find(reg->terms.getIDByString(pred))==maxinput.end()))
+						if ((std::find(abp.begin(), abp.end(), opID) == abp.end())&&(maxinput.find(opID)==maxinput.end()))
 						{
 							// the element is not relevant
 							DBGLOG(DBG, "LSS: EL: predicate "<<pred<<" does not occur in either of the ABox or the maximum input, skip the rewriting");
@@ -582,28 +1020,10 @@ namespace dllite {
 						{
 							DBGLOG(DBG,"LSS: EL: the predicate "<< pred<< "is relevant");
 
-							// declare variables that will be used in the nogoods
-							ID var1ID;
-							ID var2ID;
-
-							// set the variables that participate in the nogoods
-							if (varm!=std::string::npos) {
-								r=true;
-								std::string var1 = str.substr (varb+1,varm-varb-1);
-								std::string var2 = str.substr (varm+1,vare-varm-1);
-								DBGLOG(DBG, "LSS: EL: this is a role predicate ");
-								var1ID = reg->terms.getIDByString(var1);
-								if (var1ID==ID_FAIL) var1ID = reg->storeVariableTerm(var1);
-								var2ID = reg->terms.getIDByString(var2);
-								if (var2ID==ID_FAIL) var2ID = reg->storeVariableTerm(var2);
-
-							}
-							else {
-								std::string var1 = str.substr (varb+1,vare-varb-1);
-								DBGLOG(DBG,  "LSS: EL: this is a concept predicate");
-								var1ID = reg->terms.getIDByString(var1);
-								if (var1ID==ID_FAIL) var1ID = reg->storeVariableTerm(var1);
-							}
+							// the variables that participate in the nogoods
+							ID var1ID = ratom.tuple[1];
+							ID var2ID = (r ? ratom.tuple[2] : ID_FAIL);
+							DBGLOG(DBG, "LSS: EL: this is a " << (r ? "role" : "concept") << " predicate");
 
 							// variable for storing ID of the created atom if the predicate occurs in the ABox
 							dlvhex::ID ia=ID_FAIL;
@@ -630,7 +1050,7 @@ namespace dllite {
 							ont.push_back(ia);
 							// check whether the predicate occurs in the maximal input
 
-							if (maxinput.find(reg->terms.getIDByString(pred))!=maxinput.end()) {
+							if (maxinput.find(opID)!=maxinput.end()) {
 								DBGLOG(DBG,"LSS: EL:  the predicate occurs in the input");
 								OrdinaryAtom rp = (r ? theDLLitePlugin.getNewAtom(query.input[3], true):theDLLitePlugin.getNewAtom(query.input[1], true));
 								if (!r) {
@@ -651,7 +1071,6 @@ namespace dllite {
 
 							inp.push_back(ip);
 						}
-						row_it++;
 					}
 
 					for(std::vector<std::string>::size_type k = 0; k != ont.size(); k++) {
@@ -728,9 +1147,6 @@ namespace dllite {
 					DBGLOG(DBG,"LSS: EL: Thus we add "<<RawPrinter::toString(reg,cQID)<<" the current atom to the set of atoms not known to be completely supported");
 					ctx.getPluginData<DLLitePlugin>().incompletedlat.push_back(cQID);
 				}
-
-				pclose(in);
-#endif
 			}
 			else if (rQID != ID_FAIL) {
 				DBGLOG(DBG, "LSS: EL: the query is a role, thus we do not call the Requeim tool");
@@ -830,9 +1246,14 @@ namespace dllite {
 			DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(ctx, query.input[0]);
 
 			// classify the Tbox if not already done
-			if (!ontology->classification)
-			ontology->computeClassification(ctx);
+			{
+				boost::mutex::scoped_lock lock(ontology->mutex);
+				if (!ontology->classification)
+				ontology->computeClassification(ctx);
+			}
 			InterpretationPtr classification = ontology->classification;
+			assert(!!ontology->classificationIndex && "classification was not indexed");
+			const ClassificationIndex& clIndex = *ontology->classificationIndex;
 
 #ifndef NDEBUG
 			DBGLOG(DBG,
@@ -887,6 +1308,10 @@ namespace dllite {
 			DBGLOG(DBG, "LSS: IPM: Output atom is " << outlitStr);
 #endif
 
+			// the support sets are derived from the classification index without holding the lock,
+			// only their atoms are stored under it (see storeLearnedAtom)
+			boost::reverse_lock<boost::unique_lock<boost::mutex> > unlock(lock);
+
 
 
 			// iterate over the maximum input
@@ -896,12 +1321,18 @@ namespace dllite {
 			bm::bvector<>::enumerator en = eatom.getPredicateInputMask()->getStorage().first();
 			bm::bvector<>::enumerator en_end = eatom.getPredicateInputMask()->getStorage().end();
 
-
+			// index the concepts and roles which occur in c- and r- of the maximum input
+			boost::unordered_set<IDAddress> cmConcepts, rmRoles;
+			while (en < en_end) {
+				const OrdinaryAtom& at = reg->ogatoms.getByAddress(*en);
+				if (at.tuple[0] == query.input[2] && at.tuple[1].isConstantTerm()) cmConcepts.insert(at.tuple[1].address);
+				if (at.tuple[0] == query.input[4] && at.tuple[1].isConstantTerm()) rmRoles.insert(at.tuple[1].address);
+				en++;
+			}
+			en = eatom.getPredicateInputMask()->getStorage().first();
 
 			ID qID = query.input[5];
 
-#define DBGCHECKATOM(id) { std::stringstream ss; RawPrinter printer(ss, reg); printer.print(id); DBGLOG(DBG, "LSS: Checking if " << ss.str() << " holds in CM:"); }
-
 			while (en < en_end) {
 				// check if it is c+, c-, r+ or r-
 
@@ -918,19 +1349,13 @@ namespace dllite {
 					ID cID = oatom.tuple[1];
 
 					// check if sub(C, Q) is true in the classification assignment
-					OrdinaryAtom subcq(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					subcq.tuple.push_back(theDLLitePlugin.subID);
-					subcq.tuple.push_back(cID);
-					subcq.tuple.push_back(qID);
-					ID subcqID = reg->storeOrdinaryAtom(subcq);
-
-					DBGCHECKATOM(subcqID)
-					if (classification->getFact(subcqID.address)) {
+					DBGLOG(DBG, "LSS: Checking if sub(" << RawPrinter::toString(reg, cID) << ", " << RawPrinter::toString(reg, qID) << ") holds in CM:");
+					if (clIndex.isSub(cID, qID)) {
 						OrdinaryAtom cpcx = theDLLitePlugin.getNewAtom(query.input[1]);
 						cpcx.tuple.push_back(cID);
 						cpcx.tuple.push_back(outvarID);
 						Nogood supportset;
-						supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cpcx)));
+						supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(cpcx)));
 						supportset.insert(outlit);
 						DBGLOG(DBG,"LSS: Holds --> Learned support set: " << supportset.getStringRepresentation(reg));
 						potentialSupportSets->addNogood(supportset);
@@ -939,19 +1364,13 @@ namespace dllite {
 					}
 
 					// check if conf(C, C) is true in the classification assignment
-					OrdinaryAtom confcc(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					confcc.tuple.push_back(theDLLitePlugin.confID);
-					confcc.tuple.push_back(cID);
-					confcc.tuple.push_back(cID);
-					ID confccID = reg->storeOrdinaryAtom(confcc);
-
-					DBGCHECKATOM(confccID)
-					if (classification->getFact(confccID.address)) {
+					DBGLOG(DBG, "LSS: Checking if conf(" << RawPrinter::toString(reg, cID) << ", " << RawPrinter::toString(reg, cID) << ") holds in CM:");
+					if (clIndex.isConf(cID, cID)) {
 						OrdinaryAtom cpcx = theDLLitePlugin.getNewAtom(query.input[1]);
 						cpcx.tuple.push_back(cID);
 						cpcx.tuple.push_back(theDLLitePlugin.xID);
 						Nogood supportset;
-						supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cpcx)));
+						supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(cpcx)));
 						supportset.insert(outlit);
 						DBGLOG(DBG,
 								"LSS: Holds --> Learned support set: " << supportset.getStringRepresentation(reg));
@@ -966,16 +1385,13 @@ namespace dllite {
 
 					DBGLOG(DBG,"LSS: Checking if conf(" << cStr << ", C') is true in the classification assignment (for some C')");
 #endif
-					bm::bvector<>::enumerator en2 = classification->getStorage().first();
-					bm::bvector<>::enumerator en2_end =	classification->getStorage().end();
-					while (en2 < en2_end) {
-#ifndef NDEBUG
-						std::string en2Str = RawPrinter::toString(reg,reg->ogatoms.getIDByAddress(*en2));
-						DBGLOG(DBG, "LSS: Current classification atom: " << en2Str);
-#endif
-						const OrdinaryAtom& clAtom = reg->ogatoms.getByAddress(*en2);
-						if (clAtom.tuple[0] == theDLLitePlugin.confID && clAtom.tuple[1] == cID) {
-							ID cpID = clAtom.tuple[2];
+					unsigned cIndex = clIndex.getIndex(cID);
+					if (cIndex != ClassificationIndex::npos) {
+						const ClassificationIndex::Row& conflicts = clIndex.getConflicts(cIndex);
+						ClassificationIndex::Row::enumerator en2 = conflicts.first();
+						ClassificationIndex::Row::enumerator en2_end = conflicts.end();
+						while (en2 < en2_end) {
+							ID cpID = clIndex.getTerm(*en2);
 #ifndef NDEBUG
 							std::string cpStr = RawPrinter::toString(reg, cpID);
 							DBGLOG(DBG,"LSS: Found a match with C=" << cStr << " and C'=" << cpStr);
@@ -987,26 +1403,25 @@ namespace dllite {
 							OrdinaryAtom cpcy = theDLLitePlugin.getNewAtom(query.input[1]);
 							cpcy.tuple.push_back(cID);
 							cpcy.tuple.push_back(theDLLitePlugin.yID);
-							supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cpcy)));
+							supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(cpcy)));
 
 							// guard atom
 							// since we cannot check guard atoms of form exR(Y), we rewrite them to R(Y,Z)
 
 							ID guardID;
 							if (theDLLitePlugin.isDlEx(cpID)) {
-								ID negnoexcpID = theDLLitePlugin.dlRemoveEx(clAtom.tuple[2]);
+								ID negnoexcpID = theDLLitePlugin.dlRemoveEx(cpID);
 								OrdinaryAtom negnoexcp = theDLLitePlugin.getNewGuardAtom();
 								negnoexcp.tuple.push_back(negnoexcpID);
 								negnoexcp.tuple.push_back(theDLLitePlugin.yID);
 								negnoexcp.tuple.push_back(theDLLitePlugin.zID);
-								guardID = reg->storeOrdinaryAtom(negnoexcp);
+								guardID = storeLearnedAtom(negnoexcp);
 								supportset.insert(NogoodContainer::createLiteral(guardID));
 							} else {
-								ID negcpID = clAtom.tuple[2];
 								OrdinaryAtom negcp = theDLLitePlugin.getNewGuardAtom();
-								negcp.tuple.push_back(negcpID);
+								negcp.tuple.push_back(cpID);
 								negcp.tuple.push_back(theDLLitePlugin.yID);
-								guardID = reg->storeOrdinaryAtom(negcp);
+								guardID = storeLearnedAtom(negcp);
 								supportset.insert(NogoodContainer::createLiteral(guardID));
 							}
 
@@ -1021,45 +1436,33 @@ namespace dllite {
 							potentialSupportSets->addNogood(supportset);
 
 							// check if c-(C', Y) occurs in the maximal interpretation
-							bm::bvector<>::enumerator en3 = eatom.getPredicateInputMask()->getStorage().first();
-							bm::bvector<>::enumerator en3_end = eatom.getPredicateInputMask()->getStorage().end();
-
 #ifndef NDEBUG
 							DBGLOG(DBG,"LSS: Checking if (C',Y) with C'=" << RawPrinter::toString(reg, theDLLitePlugin.dlNeg(cpID)) << " occurs in c- (for some Y)");
 #endif
-							while (en3 < en3_end) {
-								const OrdinaryAtom& at = reg->ogatoms.getByAddress(*en3);
-								if (at.tuple[0] == query.input[2] && at.tuple[1] == theDLLitePlugin.dlNeg(clAtom.tuple[2])) {
-#ifndef NDEBUG
-									std::string yStr = RawPrinter::toString(reg,at.tuple[2]);
-									DBGLOG(DBG,"LSS: --> Found a match with Y=" << yStr);
-#endif
-									Nogood supportset;
+							if (cmConcepts.count(theDLLitePlugin.dlNeg(cpID).address) > 0) {
+								DBGLOG(DBG,"LSS: --> Found a match");
+								Nogood supportset;
 
-									// add { T c+(C,Y), T c-(C,Y) }
-									OrdinaryAtom cpcy = theDLLitePlugin.getNewAtom(query.input[1], false);
-									cpcy.tuple.push_back(cID);
-									cpcy.tuple.push_back(theDLLitePlugin.yID);
-									//cpcy.tuple.push_back(at.tuple[2]);
-									supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cpcy)));
+								// add { T c+(C,Y), T c-(C,Y) }
+								OrdinaryAtom cpcy = theDLLitePlugin.getNewAtom(query.input[1], false);
+								cpcy.tuple.push_back(cID);
+								cpcy.tuple.push_back(theDLLitePlugin.yID);
+								supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(cpcy)));
 
-									OrdinaryAtom cmcy = theDLLitePlugin.getNewAtom(query.input[2], false);
-									cmcy.tuple.push_back(theDLLitePlugin.dlNeg(cpID));
-									cmcy.tuple.push_back(theDLLitePlugin.yID);
-									supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cmcy)));
+								OrdinaryAtom cmcy = theDLLitePlugin.getNewAtom(query.input[2], false);
+								cmcy.tuple.push_back(theDLLitePlugin.dlNeg(cpID));
+								cmcy.tuple.push_back(theDLLitePlugin.yID);
+								supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(cmcy)));
 
-									supportset.insert(outlit);
+								supportset.insert(outlit);
 
-									DBGLOG(DBG,"LSS: --> !Learned support set: " << supportset.getStringRepresentation(reg));
-									potentialSupportSets->addNogood(supportset);
-									break;
-								}
-								en3++;
+								DBGLOG(DBG,"LSS: --> !Learned support set: " << supportset.getStringRepresentation(reg));
+								potentialSupportSets->addNogood(supportset);
 							}
 							DBGLOG(DBG,
 									"LSS: Finished checking if (C',Y) with C'=" << cpStr << " occurs in c- (for some Y)");
+							en2++;
 						}
-						en2++;
 					}
 					DBGLOG(DBG,"LSS: Finished checking if conf(" << cStr << ", C') is true in the classification assignment (for some C')");
 
@@ -1077,13 +1480,13 @@ namespace dllite {
 					OrdinaryAtom cmcy = theDLLitePlugin.getNewAtom(query.input[2], false);
 					cmcy.tuple.push_back(cID);
 					cmcy.tuple.push_back(theDLLitePlugin.yID);
-					supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cmcy)));
+					supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(cmcy)));
 
 					ID cyID = theDLLitePlugin.dlNeg(cID);
 					OrdinaryAtom cy = theDLLitePlugin.getNewGuardAtom();
 					cy.tuple.push_back(cyID);
 					cy.tuple.push_back(theDLLitePlugin.yID);
-					guardID = reg->storeOrdinaryAtom(cy);
+					guardID = storeLearnedAtom(cy);
 					supportset.insert(NogoodContainer::createLiteral(guardID));
 
 					supportset.insert(outlit);
@@ -1105,20 +1508,14 @@ namespace dllite {
 
 					if (cQID!=ID_FAIL) {
 						// check if sub(exR, Q) classification assignment (applicable only for concepts)
-						OrdinaryAtom subexrq(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-						subexrq.tuple.push_back(theDLLitePlugin.subID);
-						subexrq.tuple.push_back(theDLLitePlugin.dlEx(rID));
-						subexrq.tuple.push_back(qID);
-						ID subexrqID = reg->storeOrdinaryAtom(subexrq);
-
-						DBGCHECKATOM(subexrqID)
-						if (classification->getFact(subexrqID.address)) {
+						DBGLOG(DBG, "LSS: Checking if sub(" << RawPrinter::toString(reg, theDLLitePlugin.dlEx(rID)) << ", " << RawPrinter::toString(reg, qID) << ") holds in CM:");
+						if (clIndex.isSub(theDLLitePlugin.dlEx(rID), qID)) {
 							OrdinaryAtom rprxy = theDLLitePlugin.getNewAtom(query.input[3]);
 							rprxy.tuple.push_back(rID);
 							rprxy.tuple.push_back(outvarID);
 							rprxy.tuple.push_back(theDLLitePlugin.yID);
 							Nogood supportset;
-							supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprxy)));
+							supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprxy)));
 							supportset.insert(outlit);
 							DBGLOG(DBG,"LSS: Holds --> Learned support set: " << supportset.getStringRepresentation(reg));
 							potentialSupportSets->addNogood(supportset);
@@ -1129,20 +1526,14 @@ namespace dllite {
 
 					else {
 						// check if sub(R, Q) is true in the classification assignment (applicable only for roles)
-						OrdinaryAtom subrq(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-						subrq.tuple.push_back(theDLLitePlugin.subID);
-						subrq.tuple.push_back(rID);
-						subrq.tuple.push_back(qID);
-						ID subrqID = reg->storeOrdinaryAtom(subrq);
-
-						DBGCHECKATOM(subrqID)
-						if (classification->getFact(subrqID.address)) {
+						DBGLOG(DBG, "LSS: Checking if sub(" << RawPrinter::toString(reg, rID) << ", " << RawPrinter::toString(reg, qID) << ") holds in CM:");
+						if (clIndex.isSub(rID, qID)) {
 							OrdinaryAtom rprxy = theDLLitePlugin.getNewAtom(query.input[1]);
 							rprxy.tuple.push_back(rID);
 							rprxy.tuple.push_back(outvarID1);
 							rprxy.tuple.push_back(outvarID2);
 							Nogood supportset;
-							supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprxy)));
+							supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprxy)));
 							supportset.insert(outlit);
 							DBGLOG(DBG,"LSS: Holds --> Learned support set: " << supportset.getStringRepresentation(reg));
 							potentialSupportSets->addNogood(supportset);
@@ -1154,19 +1545,14 @@ namespace dllite {
 
 
 					// check if confref(R) is true in the classification assignment (applicable only for roles)
-					OrdinaryAtom confrefr(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					confrefr.tuple.push_back(theDLLitePlugin.confrefID);
-					confrefr.tuple.push_back(rID);
-					ID confrefrID = reg->storeOrdinaryAtom(confrefr);
-
-					DBGCHECKATOM(confrefrID)
-					if (classification->getFact(confrefrID.address)) {
+					DBGLOG(DBG, "LSS: Checking if confref(" << RawPrinter::toString(reg, rID) << ") holds in CM:");
+					if (clIndex.isConfref(rID)) {
 						OrdinaryAtom rprref = theDLLitePlugin.getNewAtom(query.input[3]);
 						rprref.tuple.push_back(rID);
 						rprref.tuple.push_back(theDLLitePlugin.yID);
 						rprref.tuple.push_back(theDLLitePlugin.yID);
 						Nogood supportset;
-						supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprref)));
+						supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprref)));
 						supportset.insert(outlit);
 						DBGLOG(DBG,"LSS: Holds --> Learned support set: " << supportset.getStringRepresentation(reg));
 						potentialSupportSets->addNogood(supportset);
@@ -1176,15 +1562,10 @@ namespace dllite {
 
 
 					// check if funct(R) is true in the classification assignment (applicable only for roles)
-					OrdinaryAtom functr(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-					functr.tuple.push_back(theDLLitePlugin.functID);
-					functr.tuple.push_back(rID);
-					ID functrID = reg->storeOrdinaryAtom(functr);
-
-					DBGCHECKATOM(functrID)
+					DBGLOG(DBG, "LSS: Checking if funct(" << RawPrinter::toString(reg, rID) << ") holds in CM:");
 
 					// add two support sets: {r+(R,X,Y), r+(R,X,Z)}, {r+(R,X,Y), R(X,Z)}
-					if (classification->getFact(functrID.address)) {
+					if (clIndex.isFunct(rID)) {
 						OrdinaryAtom rprfunct = theDLLitePlugin.getNewAtom(query.input[3]);
 						rprfunct.tuple.push_back(rID);
 						rprfunct.tuple.push_back(theDLLitePlugin.xID);
@@ -1201,15 +1582,15 @@ namespace dllite {
 						rfunct.tuple.push_back(theDLLitePlugin.zID);
 
 						Nogood supportset;
-						supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprfunct)));
-						supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprfunct2)));
+						supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprfunct)));
+						supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprfunct2)));
 						supportset.insert(outlit);
 						DBGLOG(DBG,"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
 						potentialSupportSets->addNogood(supportset);
 
 						Nogood supportset2;
-						supportset2.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprfunct)));
-						supportset2.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rfunct)));
+						supportset2.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprfunct)));
+						supportset2.insert(NogoodContainer::createLiteral(storeLearnedAtom(rfunct)));
 						supportset2.insert(outlit);
 						DBGLOG(DBG,"LSS: --> Learned support set: " << supportset2.getStringRepresentation(reg));
 						potentialSupportSets->addNogood(supportset2);
@@ -1226,15 +1607,18 @@ namespace dllite {
 						DBGLOG(DBG,"LSS: Checking if conf("<<cStr<<",C') holds in CM for some C' or conf("<<cStr2<<",R') holds for some R'");
 					#endif
 
-					bm::bvector<>::enumerator en2 = classification->getStorage().first();
-					bm::bvector<>::enumerator en2_end =	classification->getStorage().end();
-					while (en2 < en2_end) {
-						const OrdinaryAtom& at = reg->ogatoms.getByAddress(*en2);
-						if (at.tuple[0] == theDLLitePlugin.confID && at.tuple[1] == exrID) {
-							DBGLOG(DBG,"LSS: Found a match for conf("<<RawPrinter::toString(reg,exrID)<<",C') with C'=" << RawPrinter::toString(reg, at.tuple[2]));
+					// conflicts of exR with concepts
+					unsigned exrIndex = clIndex.getIndex(exrID);
+					if (exrIndex != ClassificationIndex::npos) {
+						const ClassificationIndex::Row& conflicts = clIndex.getConflicts(exrIndex);
+						ClassificationIndex::Row::enumerator en2 = conflicts.first();
+						ClassificationIndex::Row::enumerator en2_end = conflicts.end();
+						while (en2 < en2_end) {
+							ID cgID = clIndex.getTerm(*en2);
+							DBGLOG(DBG,"LSS: Found a match for conf("<<RawPrinter::toString(reg,exrID)<<",C') with C'=" << RawPrinter::toString(reg, cgID));
 							DBGLOG(DBG,"LSS: Check whether C' is a concept");
 
-							if ((theDLLitePlugin.isDlNeg(at.tuple[2]) && theDLLitePlugin.isDlEx(theDLLitePlugin.dlNeg(at.tuple[2])))||(theDLLitePlugin.isDlEx(at.tuple[2]))) {
+							if ((theDLLitePlugin.isDlNeg(cgID) && theDLLitePlugin.isDlEx(theDLLitePlugin.dlNeg(cgID)))||(theDLLitePlugin.isDlEx(cgID))) {
 								DBGLOG(DBG,"LSS: C' is of form exR or -exR, ignore it");
 							} else {
 								DBGLOG(DBG,"LSS: C' is a concept, create a support set");
@@ -1244,48 +1628,47 @@ namespace dllite {
 								rprxy.tuple.push_back(rID);
 								rprxy.tuple.push_back(theDLLitePlugin.xID);
 								rprxy.tuple.push_back(theDLLitePlugin.yID);
-								supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprxy)));
+								supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprxy)));
 
 								// guard atom
-								ID cgID = at.tuple[2];
 								OrdinaryAtom cg = theDLLitePlugin.getNewGuardAtom();
 								cg.tuple.push_back(cgID);
 								cg.tuple.push_back(theDLLitePlugin.xID);
-								ID cgatID = reg->storeOrdinaryAtom(cg);
+								ID cgatID = storeLearnedAtom(cg);
 								supportset.insert(NogoodContainer::createLiteral(cgatID));
 
 								supportset.insert(outlit);
 
 								DBGLOG(DBG,"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
 								potentialSupportSets->addNogood(supportset);
-								if (theDLLitePlugin.isDlNeg(cgID)) {
-									bm::bvector<>::enumerator en3 = eatom.getPredicateInputMask()->getStorage().first();
-									bm::bvector<>::enumerator en3_end = eatom.getPredicateInputMask()->getStorage().end();
-									while (en3 < en3_end) {
-											const OrdinaryAtom& inat = reg->ogatoms.getByAddress(*en3);
-											if (inat.tuple[0] == query.input[2]&& inat.tuple[1] == theDLLitePlugin.dlNeg(cgID)) {
-												DBGLOG(DBG,"LSS: Found a match for c-(inv(C'),X)");
-												Nogood supportset2;
-												// add { T r+(R,X,Y), T C-(X) }
-												supportset2.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprxy)));
-												OrdinaryAtom cx = theDLLitePlugin.getNewAtom(query.input[2]);
-												cx.tuple.push_back(theDLLitePlugin.dlNeg(cgID));
-												rprxy.tuple.push_back(theDLLitePlugin.xID);
-												supportset2.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(cx)));
-
-												supportset2.insert(outlit);
-
-												DBGLOG(DBG,"LSS: --> Learned support set: " << supportset2.getStringRepresentation(reg));
-
-											}
-											en3++;
-									}
+								if (theDLLitePlugin.isDlNeg(cgID) && cmConcepts.count(theDLLitePlugin.dlNeg(cgID).address) > 0) {
+									DBGLOG(DBG,"LSS: Found a match for c-(inv(C'),X)");
+									Nogood supportset2;
+									// add { T r+(R,X,Y), T C-(X) }
+									supportset2.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprxy)));
+									OrdinaryAtom cx = theDLLitePlugin.getNewAtom(query.input[2]);
+									cx.tuple.push_back(theDLLitePlugin.dlNeg(cgID));
+									rprxy.tuple.push_back(theDLLitePlugin.xID);
+									supportset2.insert(NogoodContainer::createLiteral(storeLearnedAtom(cx)));
+
+									supportset2.insert(outlit);
+
+									DBGLOG(DBG,"LSS: --> Learned support set: " << supportset2.getStringRepresentation(reg));
 								}
 							}
+							en2++;
 						}
+					}
 
-						if (at.tuple[0] == theDLLitePlugin.confID && at.tuple[1] == rID) {
-							DBGLOG(DBG,"LSS: --> Found a match for conf("<<RawPrinter::toString(reg,rID)<<",R') with R'=" << RawPrinter::toString(reg, at.tuple[2]));
+					// conflicts of R with roles
+					unsigned rIndex = clIndex.getIndex(rID);
+					if (rIndex != ClassificationIndex::npos) {
+						const ClassificationIndex::Row& conflicts = clIndex.getConflicts(rIndex);
+						ClassificationIndex::Row::enumerator en2 = conflicts.first();
+						ClassificationIndex::Row::enumerator en2_end = conflicts.end();
+						while (en2 < en2_end) {
+							ID rgID = clIndex.getTerm(*en2);
+							DBGLOG(DBG,"LSS: --> Found a match for conf("<<RawPrinter::toString(reg,rID)<<",R') with R'=" << RawPrinter::toString(reg, rgID));
 							Nogood supportset;
 
 							// add { T r+(R,X,Y), R'(X,Y) }
@@ -1293,15 +1676,14 @@ namespace dllite {
 							rprxy.tuple.push_back(rID);
 							rprxy.tuple.push_back(theDLLitePlugin.xID);
 							rprxy.tuple.push_back(theDLLitePlugin.yID);
-							supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(rprxy)));
+							supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprxy)));
 
 							// guard atom
-							ID rgID = at.tuple[2];
 							OrdinaryAtom rg = theDLLitePlugin.getNewGuardAtom();
 							rg.tuple.push_back(rgID);
 							rg.tuple.push_back(theDLLitePlugin.xID);
 							rg.tuple.push_back(theDLLitePlugin.yID);
-							ID rgatID = reg->storeOrdinaryAtom(rg);
+							ID rgatID = storeLearnedAtom(rg);
 							supportset.insert(NogoodContainer::createLiteral(rgatID));
 
 							supportset.insert(outlit);
@@ -1309,23 +1691,27 @@ namespace dllite {
 							DBGLOG(DBG,"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
 							potentialSupportSets->addNogood(supportset);
 
-							// if R' is negative, then check whether r-(R',X,Y) holds in the maximum input
-							if (theDLLitePlugin.isDlNeg(rgID)){
-
-								bm::bvector<>::enumerator en3 = eatom.getPredicateInputMask()->getStorage().first();
-								bm::bvector<>::enumerator en3_end = eatom.getPredicateInputMask()->getStorage().end();
-								while (en3 < en3_end) {
-									const OrdinaryAtom& inat = reg->ogatoms.getByAddress(*en3);
-									if (inat.tuple[0] == query.input[4]&& inat.tuple[1] == rgID) {
-										DBGLOG(DBG,"LSS: ");
-									}
-									en3++;
-								}
-							}
+							// if R' is a negated role -R'', then check whether r-(R'',X,Y) occurs in the maximum input
+							if (theDLLitePlugin.isDlNeg(rgID) && rmRoles.count(theDLLitePlugin.dlNeg(rgID).address) > 0) {
+								DBGLOG(DBG,"LSS: --> Found a match in r- for R''=" << RawPrinter::toString(reg, theDLLitePlugin.dlNeg(rgID)));
+								Nogood supportset;
 
-						}
+								// add { T r+(R,X,Y), T r-(R'',X,Y) }
+								supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rprxy)));
+
+								OrdinaryAtom rmrxy = theDLLitePlugin.getNewAtom(query.input[4]);
+								rmrxy.tuple.push_back(theDLLitePlugin.dlNeg(rgID));
+								rmrxy.tuple.push_back(theDLLitePlugin.xID);
+								rmrxy.tuple.push_back(theDLLitePlugin.yID);
+								supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(rmrxy)));
 
-						en2++;
+								supportset.insert(outlit);
+
+								DBGLOG(DBG,"LSS: --> !Learned support set: " << supportset.getStringRepresentation(reg));
+								potentialSupportSets->addNogood(supportset);
+							}
+							en2++;
+						}
 					}
 
 
@@ -1364,7 +1750,7 @@ namespace dllite {
 
 				Nogood supportset;
 				supportset.insert(
-						NogoodContainer::createLiteral(reg->storeOrdinaryAtom(qy)));
+						NogoodContainer::createLiteral(storeLearnedAtom(qy)));
 				supportset.insert(outlit);
 				DBGLOG(DBG,
 						"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
@@ -1377,63 +1763,60 @@ namespace dllite {
 				DBGLOG(DBG,
 						"LSS: Checking if sub(C, " << qstr << ") is true in the classification assignment (for some C')");
 #endif
-				bm::bvector<>::enumerator en = classification->getStorage().first();
-				bm::bvector<>::enumerator en_end = classification->getStorage().end();
+				unsigned qIndex = clIndex.getIndex(qID);
+				const ClassificationIndex::Row emptyRow;
+				const ClassificationIndex::Row& subsumees = (qIndex != ClassificationIndex::npos ? clIndex.getSubsumees(qIndex) : emptyRow);
+				ClassificationIndex::Row::enumerator en = subsumees.first();
+				ClassificationIndex::Row::enumerator en_end = subsumees.end();
 				while (en < en_end) {
-					DBGLOG(DBG,
-							"LSS: Current classification atom: " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(*en)));
-					const OrdinaryAtom& clAtom = reg->ogatoms.getByAddress(*en);
-					if (clAtom.tuple[0] == theDLLitePlugin.subID
-							&& clAtom.tuple[2] == qID) {
-						ID cID = clAtom.tuple[1];
+					ID cID = clIndex.getTerm(*en);
 #ifndef NDEBUG
-						DBGLOG(DBG,
-								"LSS: Found a match with C=" << RawPrinter::toString(reg, cID));
+					DBGLOG(DBG,
+							"LSS: Found a match with C=" << RawPrinter::toString(reg, cID));
 #endif
-						if (theDLLitePlugin.isDlEx(clAtom.tuple[1])) {
-							DBGLOG(DBG, "LSS: (this is form exR)");
-							// guard atom for C(O,Y)
-							OrdinaryAtom roy = theDLLitePlugin.getNewGuardAtom();
-							roy.tuple.push_back(theDLLitePlugin.dlRemoveEx(cID));
-							roy.tuple.push_back(outvarID);
-							roy.tuple.push_back(theDLLitePlugin.yID);
+					if (theDLLitePlugin.isDlEx(cID)) {
+						DBGLOG(DBG, "LSS: (this is form exR)");
+						// guard atom for C(O,Y)
+						OrdinaryAtom roy = theDLLitePlugin.getNewGuardAtom();
+						roy.tuple.push_back(theDLLitePlugin.dlRemoveEx(cID));
+						roy.tuple.push_back(outvarID);
+						roy.tuple.push_back(theDLLitePlugin.yID);
+						Nogood supportset;
+						supportset.insert(
+								NogoodContainer::createLiteral(
+										storeLearnedAtom(roy)));
+						supportset.insert(outlit);
+						DBGLOG(DBG,
+								"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
+						potentialSupportSets->addNogood(supportset);
+					} else {
+						DBGLOG(DBG, "LSS: (this is not of form exR)");
+						if (cQID != ID_FAIL) {
+							// guard atom for C(O)
+							OrdinaryAtom co = theDLLitePlugin.getNewGuardAtom();
+							co.tuple.push_back(cID);
+							co.tuple.push_back(outvarID);
 							Nogood supportset;
 							supportset.insert(
 									NogoodContainer::createLiteral(
-											reg->storeOrdinaryAtom(roy)));
+											storeLearnedAtom(co)));
 							supportset.insert(outlit);
 							DBGLOG(DBG,
 									"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
 							potentialSupportSets->addNogood(supportset);
+						} else if (rQID != ID_FAIL) {
+							// guard atom for C(O0,O1)
+							OrdinaryAtom co = theDLLitePlugin.getNewGuardAtom();
+							co.tuple.push_back(cID);
+							co.tuple.push_back(outvarID1);
+							co.tuple.push_back(outvarID2);
+							Nogood supportset;
+							supportset.insert(NogoodContainer::createLiteral(storeLearnedAtom(co)));
+							supportset.insert(outlit);
+							DBGLOG(DBG,"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
+							potentialSupportSets->addNogood(supportset);
 						} else {
-							DBGLOG(DBG, "LSS: (this is not of form exR)");
-							if (cQID != ID_FAIL) {
-								// guard atom for C(O)
-								OrdinaryAtom co = theDLLitePlugin.getNewGuardAtom();
-								co.tuple.push_back(cID);
-								co.tuple.push_back(outvarID);
-								Nogood supportset;
-								supportset.insert(
-										NogoodContainer::createLiteral(
-												reg->storeOrdinaryAtom(co)));
-								supportset.insert(outlit);
-								DBGLOG(DBG,
-										"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
-								potentialSupportSets->addNogood(supportset);
-							} else if (rQID != ID_FAIL) {
-								// guard atom for C(O0,O1)
-								OrdinaryAtom co = theDLLitePlugin.getNewGuardAtom();
-								co.tuple.push_back(cID);
-								co.tuple.push_back(outvarID1);
-								co.tuple.push_back(outvarID2);
-								Nogood supportset;
-								supportset.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(co)));
-								supportset.insert(outlit);
-								DBGLOG(DBG,"LSS: --> Learned support set: " << supportset.getStringRepresentation(reg));
-								potentialSupportSets->addNogood(supportset);
-							} else {
-								assert(false);
-							}
+							assert(false);
 						}
 					}
 					en++;
@@ -1443,11 +1826,78 @@ namespace dllite {
 			DBGLOG(DBG,"LSS: Number of learned nogoods: "<< potentialSupportSets->getNogoodCount());
 
 		}
+		if (!!cache) cache->store(cacheKey, query, potentialSupportSets, ctx.getPluginData<DLLitePlugin>().incompletedlat.size() > incompleteCount);
 		optimizeSupportSets(potentialSupportSets, nogoods);
 
 		DBGLOG(DBG, "LSS: finished support set learning");
 	}
 
+	void DLPluginAtom::generalizeNogood(Nogood ng, ProgramCtx* programCtx, NogoodContainerPtr nogoods) {
+
+		// the premises below entail the answer only by monotonicity, which consDL lacks (see its constructor)
+		if (!ng.isGround() || predName == "consDL") return;
+		RegistryPtr reg = getRegistry();
+		ID predicateID = reg->storeConstantTerm(predName);
+		ID positiveReplacementID = reg->getAuxiliaryConstantSymbol('r', predicateID);
+		ID negativeReplacementID = reg->getAuxiliaryConstantSymbol('n', predicateID);
+		ID guardID = reg->getAuxiliaryConstantSymbol('o', ID(0, 0));
+		ID barID = reg->getAuxiliaryConstantSymbol('o', ID(0, 1));
+
+		// find the replacement atom of this DL-atom
+		ID replacement = ID_FAIL;
+		BOOST_FOREACH (ID lit, ng) {
+			const OrdinaryAtom& atom = reg->ogatoms.getByAddress(lit.address);
+			if (atom.tuple[0] == positiveReplacementID || atom.tuple[0] == negativeReplacementID) {
+				replacement = lit;
+				break;
+			}
+		}
+		if (replacement == ID_FAIL) return;
+		const OrdinaryAtom& repl = reg->ogatoms.getByAddress(replacement.address);
+		if (repl.tuple.size() < 6 + getOutputArity()) return;
+		std::size_t outputBegin = repl.tuple.size() - getOutputArity();
+		Tuple inputPredicates(repl.tuple.begin() + 2, repl.tuple.begin() + 6);
+
+		// DL-atoms are invariant under renaming of individuals only wrt. the whole Abox, thus only nogoods whose premises
+		// (kept assertions, guards and true input atoms) entail the answer which the replacement atom denies remain valid
+		// for other individuals; the Abox of a post check is given by the removal atoms, thus at least one must occur
+		bool positive = (repl.tuple[0] == positiveReplacementID);
+		if (positive != replacement.isNaf()) return;
+		bool removal = false;
+		BOOST_FOREACH (ID lit, ng) {
+			if (lit.address == replacement.address) continue;
+			ID pred = reg->ogatoms.getByAddress(lit.address).tuple[0];
+			if (pred == barID) {
+				if (!lit.isNaf()) return;
+				removal = true;
+			} else if (pred == guardID || std::find(inputPredicates.begin(), inputPredicates.end(), pred) != inputPredicates.end()) {
+				if (lit.isNaf()) return;
+			} else {
+				return;
+			}
+		}
+		if (!removal) return;
+
+		// individuals are the output terms of the replacement atom and the terms after the concept resp. role of the other atoms
+		std::map<IDAddress, ID> variables;	// by constant term
+		Nogood generalized;
+		BOOST_FOREACH (ID lit, ng) {
+			OrdinaryAtom atom = reg->ogatoms.getByAddress(lit.address);
+			atom.kind = (atom.kind & (ID::ALL_ONES ^ ID::SUBKIND_MASK)) | ID::SUBKIND_ATOM_ORDINARYN;
+			for (std::size_t i = (lit.address == replacement.address ? outputBegin : 2); i < atom.tuple.size(); ++i) {
+				if (!atom.tuple[i].isConstantTerm()) continue;
+				std::map<IDAddress, ID>::const_iterator it = variables.find(atom.tuple[i].address);
+				if (it == variables.end()) {
+					it = variables.insert(std::make_pair(atom.tuple[i].address, reg->storeVariableTerm("I" + boost::lexical_cast<std::string>(variables.size())))).first;
+				}
+				atom.tuple[i] = it->second;
+			}
+			generalized.insert(NogoodContainer::createLiteral(reg->storeOrdinaryAtom(atom).address, !lit.isNaf(), false));
+		}
+		DBGLOG(DBG, "Generalized " << ng.getStringRepresentation(reg) << " to " << generalized.getStringRepresentation(reg));
+		nogoods->addNogood(generalized);
+	}
+
 	void DLPluginAtom::optimizeSupportSets(SimpleNogoodContainerPtr initial,
 			NogoodContainerPtr final) {
 
@@ -1569,10 +2019,9 @@ namespace dllite {
 	}
 
 	// called from the core
-	void CDLAtom::retrieve(const Query& query, Answer& answer,
-			NogoodContainerPtr nogoods) {
+	void CDLAtom::evaluate(const Query& query, Answer& answer) {
 
-		DBGLOG(DBG, "CDLAtom::retrieve");
+		DBGLOG(DBG, "CDLAtom::evaluate");
 
 		RegistryPtr reg = getRegistry();
 
@@ -1590,137 +2039,83 @@ namespace dllite {
 		DBGLOG(DBG,"useABox = "<<useAbox);
 		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(
 				ctx, query.input[0], useAbox);
-		std::vector<TDLAxiom*> addedAxioms = expandAbox(query, useAbox, false);
 
-		// handle inconsistency
-		if (!ontology->kernel->isKBConsistent()) {
-			// add all individuals to the output
-			DBGLOG(DBG, "KB is inconsistent: returning all tuples");
-			InterpretationPtr intr = ontology->getAllIndividuals(query, false);
-			bm::bvector<>::enumerator en = intr->getStorage().first();
-			bm::bvector<>::enumerator en_end = intr->getStorage().end();
-			while (en < en_end) {
-				Tuple tup;
-				tup.push_back(
-						ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en));
-				answer.get().push_back(tup);
-				en++;
-			}
-			DBGLOG(DBG, "Query answering complete, recovering Abox");
-			restoreAbox(query, addedAxioms);
-			return;
+		// the negated query concept -C is a term of the classification as well
+		ID queryConceptID = theDLLitePlugin.getQuotedTerm(query.input[5]);
+		ID positiveConceptID = (theDLLitePlugin.isDlNeg(queryConceptID) ? theDLLitePlugin.dlNeg(queryConceptID) : queryConceptID);
+		if (!ontology->concepts->getFact(positiveConceptID.address)) {
+			DBGLOG(WARNING, "Queried non-existing concept " << reg->terms.getByID(positiveConceptID).getUnquotedString());
 		}
 
-		// find the query concept
-		DBGLOG(DBG, "Looking up query concept");
-		bool found = false;
-		ID queryConceptID = query.input[5];
-		bool negated = false;
-		if (theDLLitePlugin.isDlNeg(query.input[5])) {
-			negated = true;
-			queryConceptID = theDLLitePlugin.dlNeg(queryConceptID);
-		}
-		std::string queryConcept = ontology->addNamespaceToString(
-				reg->terms.getByID(queryConceptID).getUnquotedString());
-		BOOST_FOREACH(owlcpp::Triple const& t, ontology->store.map_triple()) {
-			DBGLOG(DBG,
-					"Current triple: " << to_string(t.subj_, ontology->store) << " / " << to_string(t.pred_, ontology->store) << " / " << to_string(t.obj_, ontology->store));
+		// certain and (for partial answers) possible instances are computed together: the assertions from atoms which are not yet
+		// true form a second overlay, whose instances are computed over this overlay only and added to the certain ones
+		UpdateBatchPtr batch = getUpdateBatch(query, ontology, useAbox, prop.providesPartialAnswer);
+		const NativeReasoner::Update& update = batch->update;
+		const NativeReasoner::Update& unknownUpdate = batch->unknown;
 
-			if (to_string(t.subj_, ontology->store) == queryConcept) {
-				// found concept
-				DBGLOG(DBG,
-						"Preparing Actor_collector for " << to_string(t.subj_, ontology->store));
-				Actor_collector ret(reg, answer, ontology,
-						Actor_collector::Concept, false);
-				DBGLOG(DBG, "Sending concept query");
-				TDLConceptExpression* factppConcept =
-				ontology->kernel->getExpressionManager()->Concept(
-						to_string(t.subj_, ontology->store));
-
-				if (negated)
-				factppConcept = ontology->kernel->getExpressionManager()->Not(
-						factppConcept);
-				try {
-					ontology->kernel->getInstances(factppConcept, ret);
-				} catch (...) {
-					throw PluginError(
-							"DLLite reasoner failed during concept query");
-				}
-				found = true;
-				break;
+		// if the output is bound, only the membership of this individual is checked
+		bool bound = isOutputBound(query);
+		NativeReasoner::Individuals boundIndividual;
+		if (bound) boundIndividual.set_bit(query.pattern[0].address);
+
+		NativeReasoner::Individuals trueInstances, unknownInstances;
+		bool consistent = isConsistent(ontology, *batch, false);
+		if (!consistent) {
+			DBGLOG(DBG, "KB is inconsistent: returning all tuples");
+			trueInstances = ontology->getAllIndividuals(query, false)->getStorage();
+			if (bound) trueInstances &= boundIndividual;
+		} else {
+			if (bound) {
+				if (isInstance(ontology, queryConceptID, query.pattern[0].address, update)) trueInstances = boundIndividual;
+			} else {
+				getInstances(ontology, queryConceptID, update, trueInstances);
 			}
+			trueInstances -= ontology->concepts->getStorage();
+			trueInstances -= ontology->roles->getStorage();
 		}
-		if (!found) {
-			DBGLOG(WARNING,
-					"Queried non-existing concept " << ontology->removeNamespaceFromString(queryConcept));
-		}
-
-		DBGLOG(DBG, "Query answering complete, recovering Abox");
-		restoreAbox(query, addedAxioms);
-
-
 		if (prop.providesPartialAnswer) {
-			DBGLOG(DBG, "compute unknown output");
-
-			std::vector<TDLAxiom*> addedAxioms = expandAbox(query, useAbox, true);
-
-			// handle inconsistency
-			if (!ontology->kernel->isKBConsistent()) {
-				// add all individuals to the output
-				DBGLOG(DBG, "KB is inconsistent: returning all tuples");
-				InterpretationPtr intr = ontology->getAllIndividuals(query, true);
-				bm::bvector<>::enumerator en = intr->getStorage().first();
-				bm::bvector<>::enumerator en_end = intr->getStorage().end();
-				while (en < en_end) {
-					Tuple tup;
-					tup.push_back(
-							ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en));
-					// only add to unknown if not already in true extension
-					if(std::find(answer.get().begin(), answer.get().end(), tup) == answer.get().end()) {
-						answer.getUnknown().push_back(tup);
-					}
-					en++;
-				}
-				DBGLOG(DBG, "Query answering for unknown output complete, recovering Abox");
-				restoreAbox(query, addedAxioms);
-				return;
-			}
-
-			BOOST_FOREACH(owlcpp::Triple const& t, ontology->store.map_triple()) {
-				DBGLOG(DBG,
-						"Current triple: " << to_string(t.subj_, ontology->store) << " / " << to_string(t.pred_, ontology->store) << " / " << to_string(t.obj_, ontology->store));
-
-				if (to_string(t.subj_, ontology->store) == queryConcept) {
-					// found concept
-					DBGLOG(DBG,
-							"Preparing Actor_collector for " << to_string(t.subj_, ontology->store));
-					Actor_collector ret(reg, answer, ontology,
-							Actor_collector::Concept, true);
-					DBGLOG(DBG, "Sending concept query");
-					TDLConceptExpression* factppConcept =
-					ontology->kernel->getExpressionManager()->Concept(
-							to_string(t.subj_, ontology->store));
-
-					if (negated)
-					factppConcept = ontology->kernel->getExpressionManager()->Not(
-							factppConcept);
-					try {
-						ontology->kernel->getInstances(factppConcept, ret);
-					} catch (...) {
-						throw PluginError(
-								"DLLite reasoner failed during concept query");
+			if (!isConsistent(ontology, *batch, true)) {
+				DBGLOG(DBG, "KB is possibly inconsistent: returning all tuples as unknown");
+				unknownInstances = ontology->getAllIndividuals(query, true)->getStorage();
+				if (bound) unknownInstances &= boundIndividual;
+			} else if (!unknownUpdate.empty()) {
+				if (!useNativeReasoner()) {
+					// FaCT++ answers over the Abox expanded by both overlays (outside of DL-Lite instances may only follow
+					// from assertions of both overlays together)
+					NativeReasoner::Update possibleUpdate(update);
+					possibleUpdate.add(unknownUpdate);
+					if (bound) {
+						if (isInstance(ontology, queryConceptID, query.pattern[0].address, possibleUpdate)) unknownInstances = boundIndividual;
+					} else {
+						getInstances(ontology, queryConceptID, possibleUpdate, unknownInstances);
 					}
-					found = true;
-					break;
+				} else if (bound) {
+					if (getNativeReasoner(ontology)->isInstance(queryConceptID, query.pattern[0].address, unknownUpdate, false)) unknownInstances = boundIndividual;
+				} else {
+					getNativeReasoner(ontology)->getInstances(queryConceptID, unknownUpdate, false, unknownInstances);
 				}
+				unknownInstances -= ontology->concepts->getStorage();
+				unknownInstances -= ontology->roles->getStorage();
 			}
-			if (!found) {
-				DBGLOG(WARNING,
-						"Queried non-existing concept " << ontology->removeNamespaceFromString(queryConcept));
-			}
+			// only add to unknown if not already in true extension
+			unknownInstances -= trueInstances;
+		}
 
-			DBGLOG(DBG, "Query answering for unknown output complete, recovering Abox");
-			restoreAbox(query, addedAxioms);
+		bm::bvector<>::enumerator en = trueInstances.first();
+		bm::bvector<>::enumerator en_end = trueInstances.end();
+		while (en < en_end) {
+			Tuple tup;
+			tup.push_back(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en));
+			answer.get().push_back(tup);
+			en++;
+		}
+		en = unknownInstances.first();
+		en_end = unknownInstances.end();
+		while (en < en_end) {
+			Tuple tup;
+			tup.push_back(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en));
+			answer.getUnknown().push_back(tup);
+			en++;
 		}
 	}
 
@@ -1745,10 +2140,9 @@ namespace dllite {
 		prop.completePositiveSupportSets = true; // we even provide (positive) complete support sets
 	}
 
-	void RDLAtom::retrieve(const Query& query, Answer& answer,
-			NogoodContainerPtr nogoods) {
+	void RDLAtom::evaluate(const Query& query, Answer& answer) {
 
-		DBGLOG(DBG, "RDLAtom::retrieve");
+		DBGLOG(DBG, "RDLAtom::evaluate");
 
 		RegistryPtr reg = getRegistry();
 
@@ -1761,177 +2155,87 @@ namespace dllite {
 		&& (query.input.size() < 7 || query.input[6].address == 1);
 		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(
 				ctx, query.input[0], useAbox);
-		std::vector<TDLAxiom*> addedAxioms = expandAbox(query, useAbox, false);
-
-		// handle inconsistency
-		if (!ontology->kernel->isKBConsistent()) {
-			// add all pairs of individuals to the output
-			DBGLOG(DBG, "KB is inconsistent: returning all tuples");
-			InterpretationPtr intr = ontology->getAllIndividuals(query, false);
-			bm::bvector<>::enumerator en = intr->getStorage().first();
-			bm::bvector<>::enumerator en_end = intr->getStorage().end();
-			while (en < en_end) {
-				bm::bvector<>::enumerator en2 = intr->getStorage().first();
-				bm::bvector<>::enumerator en2_end = intr->getStorage().end();
-				while (en2 < en2_end) {
-					Tuple tup;
-					tup.push_back(
-							ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en));
-					tup.push_back(
-							ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT,
-									*en2));
-					answer.get().push_back(tup);
-					en2++;
-				}
-				en++;
-			}
-			DBGLOG(DBG, "Query answering complete, recovering Abox");
-			restoreAbox(query, addedAxioms);
-			return;
-		}
 
-		// get the query role
-		ID queryRoleID = query.input[5];
-		bool negated = false;
-		if (theDLLitePlugin.isDlNeg(queryRoleID)) {
-			queryRoleID = theDLLitePlugin.dlNeg(queryRoleID);
-			negated = true;
-			// TODO: Are such queries possible in DLLite?
-			// I did not find a FaCT++ method for constructing negative role expressions
+		if (theDLLitePlugin.isDlNeg(query.input[5])) {
 			throw PluginError("Negative role queries are not supported");
 		}
-		std::string role = reg->terms.getByID(queryRoleID).getUnquotedString();
-		TDLObjectRoleExpression* factppRole =
-		ontology->kernel->getExpressionManager()->ObjectRole(
-				ontology->addNamespaceToString(role));
-		DBGLOG(DBG, "Query is:" <<&factppRole);
-		DBGLOG(DBG, "Answering role query");
-		InterpretationPtr intr = ontology->getAllIndividuals(query, false);
-
-		// for all individuals
-		bm::bvector<>::enumerator en = intr->getStorage().first();
-		bm::bvector<>::enumerator en_end = intr->getStorage().end();
-		while (en < en_end) {
-			ID individual = ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en);
+		ID queryRoleID = theDLLitePlugin.getQuotedTerm(query.input[5]);
 
-			// query related individuals
-			DBGLOG(DBG,
-					"Querying individuals related to " << RawPrinter::toString(reg, individual));
-			std::vector<const TNamedEntry*> relatedIndividuals;
-			try {
-				DBGLOG(DBG, "Entered try block"<< ontology->reg->terms.getByID(individual).getUnquotedString());
-				ontology->kernel->getRoleFillers(
-						ontology->kernel->getExpressionManager()->Individual(
-								ontology->addNamespaceToString(
-										reg->terms.getByID(individual).getUnquotedString())),
-						//			ontology->reg->terms.getByID(individual).getUnquotedString()),
-						factppRole, relatedIndividuals);
-			} catch (...) {
-				throw PluginError("DLLite reasoner failed during role query");
-			}
+		// certain and (for partial answers) possible pairs are computed together as for cDL
+		UpdateBatchPtr batch = getUpdateBatch(query, ontology, useAbox, prop.providesPartialAnswer);
+		const NativeReasoner::Update& update = batch->update;
+		const NativeReasoner::Update& unknownUpdate = batch->unknown;
 
-			// translate the result to HEX
-			BOOST_FOREACH (const TNamedEntry* related, relatedIndividuals) {
-				ID relatedIndividual = theDLLitePlugin.storeQuotedConstantTerm(
-						ontology->removeNamespaceFromString(related->getName()));
-				DBGLOG(DBG,
-						"Adding role membership: (" << reg->terms.getByID(relatedIndividual).getUnquotedString() << ", " << relatedIndividual << ")");
-				Tuple tup;
-				tup.push_back(individual);
-				tup.push_back(relatedIndividual);
-				answer.get().push_back(tup);
-			}
-			en++;
-		}
-
-		DBGLOG(DBG, "Query answering complete, recovering Abox");
-		restoreAbox(query, addedAxioms);
+		// if the output is bound, only the membership of this pair is checked
+		bool bound = isOutputBound(query);
+		NativeReasoner::Pair boundPair;
+		if (bound) boundPair = NativeReasoner::Pair(query.pattern[0].address, query.pattern[1].address);
 
+		NativeReasoner::Pairs truePairs, unknownPairs;
+		bool consistent = isConsistent(ontology, *batch, false);
+		if (!consistent) {
+			DBGLOG(DBG, "KB is inconsistent: returning all tuples");
+			getAllPairs(ontology->getAllIndividuals(query, false), bound ? &boundPair : NULL, truePairs);
+		} else if (bound) {
+			if (isRoleMember(ontology, queryRoleID, boundPair.first, boundPair.second, update)) truePairs.push_back(boundPair);
+		} else {
+			getRoleExtension(ontology, queryRoleID, update, truePairs);
+		}
 		if (prop.providesPartialAnswer) {
-			DBGLOG(DBG, "compute unknown output");
-			std::vector<TDLAxiom*> addedAxioms = expandAbox(query, useAbox, true);
-
-			// handle inconsistency
-			if (!ontology->kernel->isKBConsistent()) {
-				// add all pairs of individuals to the output
-				DBGLOG(DBG, "KB is inconsistent: returning all tuples");
-				InterpretationPtr intr = ontology->getAllIndividuals(query, true);
-				bm::bvector<>::enumerator en = intr->getStorage().first();
-				bm::bvector<>::enumerator en_end = intr->getStorage().end();
-				while (en < en_end) {
-					bm::bvector<>::enumerator en2 = intr->getStorage().first();
-					bm::bvector<>::enumerator en2_end = intr->getStorage().end();
-					while (en2 < en2_end) {
-						Tuple tup;
-						tup.push_back(
-								ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en));
-						tup.push_back(
-								ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT,
-										*en2));
-						// only add to unknown if not already in true extension
-						if(std::find(answer.get().begin(), answer.get().end(), tup) == answer.get().end()) {
-							answer.getUnknown().push_back(tup);
-						}
-						en2++;
+			NativeReasoner::Pairs possiblePairs;
+			if (!isConsistent(ontology, *batch, true)) {
+				DBGLOG(DBG, "KB is possibly inconsistent: returning all tuples as unknown");
+				getAllPairs(ontology->getAllIndividuals(query, true), bound ? &boundPair : NULL, possiblePairs);
+			} else if (!unknownUpdate.empty()) {
+				if (!useNativeReasoner()) {
+					// FaCT++ answers over the Abox expanded by both overlays (as for cDL)
+					NativeReasoner::Update possibleUpdate(update);
+					possibleUpdate.add(unknownUpdate);
+					if (bound) {
+						if (isRoleMember(ontology, queryRoleID, boundPair.first, boundPair.second, possibleUpdate)) possiblePairs.push_back(boundPair);
+					} else {
+						getRoleExtension(ontology, queryRoleID, possibleUpdate, possiblePairs);
 					}
-					en++;
+				} else if (bound) {
+					if (getNativeReasoner(ontology)->isRoleMember(queryRoleID, boundPair.first, boundPair.second, unknownUpdate, false)) possiblePairs.push_back(boundPair);
+				} else {
+					getNativeReasoner(ontology)->getRoleExtension(queryRoleID, unknownUpdate, false, possiblePairs);
 				}
-				DBGLOG(DBG, "Query answering for unknown output complete, recovering Abox");
-				restoreAbox(query, addedAxioms);
-				return;
 			}
+			// only add to unknown if not already in true extension (both lists are sorted)
+			std::set_difference(possiblePairs.begin(), possiblePairs.end(), truePairs.begin(), truePairs.end(), std::back_inserter(unknownPairs));
+		}
 
-			DBGLOG(DBG, "Query is:" <<&factppRole);
-			DBGLOG(DBG, "Answering role query");
-			InterpretationPtr intr = ontology->getAllIndividuals(query, true);
-
-			// for all individuals
-			en = intr->getStorage().first();
-			en_end = intr->getStorage().end();
-			while (en < en_end) {
-				ID individual = ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en);
+		BOOST_FOREACH (const NativeReasoner::Pair& pair, truePairs) {
+			Tuple tup;
+			tup.push_back(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, pair.first));
+			tup.push_back(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, pair.second));
+			answer.get().push_back(tup);
+		}
+		BOOST_FOREACH (const NativeReasoner::Pair& pair, unknownPairs) {
+			Tuple tup;
+			tup.push_back(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, pair.first));
+			tup.push_back(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, pair.second));
+			answer.getUnknown().push_back(tup);
+		}
+	}
 
-				// query related individuals
-				DBGLOG(DBG,
-						"Querying individuals related to " << RawPrinter::toString(reg, individual));
-				std::vector<const TNamedEntry*> relatedIndividuals;
-				try {
-					DBGLOG(DBG, "Entered try block"<< ontology->reg->terms.getByID(individual).getUnquotedString());
-					ontology->kernel->getRoleFillers(
-							ontology->kernel->getExpressionManager()->Individual(
-									ontology->addNamespaceToString(
-											reg->terms.getByID(individual).getUnquotedString())),
-							//			ontology->reg->terms.getByID(individual).getUnquotedString()),
-							factppRole, relatedIndividuals);
-				} catch (...) {
-					throw PluginError("DLLite reasoner failed during role query");
-				}
+	void RDLAtom::getAllPairs(InterpretationConstPtr individuals, const NativeReasoner::Pair* bound, NativeReasoner::Pairs& pairs) {
 
-				// translate the result to HEX
-				BOOST_FOREACH (const TNamedEntry* related, relatedIndividuals) {
-					ID relatedIndividual = theDLLitePlugin.storeQuotedConstantTerm(
-							ontology->removeNamespaceFromString(related->getName()));
-					DBGLOG(DBG,
-							"Adding role membership: (" << reg->terms.getByID(relatedIndividual).getUnquotedString() << ", " << relatedIndividual << ")");
-					Tuple tup;
-					tup.push_back(individual);
-					tup.push_back(relatedIndividual);
-					// only add to unknown if not already in true extension
-					if(std::find(answer.get().begin(), answer.get().end(), tup) == answer.get().end()) {
-						answer.getUnknown().push_back(tup);
-					}
-				}
-				en++;
+		if (bound) {
+			if (individuals->getFact(bound->first) && individuals->getFact(bound->second)) pairs.push_back(*bound);
+			return;
+		}
+		bm::bvector<>::enumerator en = individuals->getStorage().first();
+		bm::bvector<>::enumerator en_end = individuals->getStorage().end();
+		while (en < en_end) {
+			bm::bvector<>::enumerator en2 = individuals->getStorage().first();
+			bm::bvector<>::enumerator en2_end = individuals->getStorage().end();
+			while (en2 < en2_end) {
+				pairs.push_back(NativeReasoner::Pair(*en, *en2));
+				en2++;
 			}
-
-			DBGLOG(DBG, "Query answering for unknown output complete, recovering Abox");
-			restoreAbox(query, addedAxioms);
-
-
-
-
-
-
+			en++;
 		}
 	}
 
@@ -1950,10 +2254,9 @@ namespace dllite {
 		setOutputArity(0); // arity of the output list
 	}
 
-	void ConsDLAtom::retrieve(const Query& query, Answer& answer,
-			NogoodContainerPtr nogoods) {
+	void ConsDLAtom::evaluate(const Query& query, Answer& answer) {
 
-		DBGLOG(DBG, "ConsDLAtom::retrieve");
+		DBGLOG(DBG, "ConsDLAtom::evaluate");
 
 		RegistryPtr reg = getRegistry();
 
@@ -1966,15 +2269,12 @@ namespace dllite {
 		&& (query.input.size() < 6 || query.input[5].address == 1);
 		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(
 				ctx, query.input[0], useAbox);
-		std::vector<TDLAxiom*> addedAxioms = expandAbox(query, useAbox, false);
+		UpdateBatchPtr batch = getUpdateBatch(query, ontology, useAbox, false);
 
 		// handle inconsistency
-		if (ontology->kernel->isKBConsistent()) {
+		if (isConsistent(ontology, *batch, false)) {
 			answer.get().push_back(Tuple());
 		}
-
-		DBGLOG(DBG, "Consistency check complete, recovering Abox");
-		restoreAbox(query, addedAxioms);
 	}
 
 	// ============================== Class InonsDLAtom ==============================
@@ -1991,10 +2291,9 @@ namespace dllite {
 		setOutputArity(0); // arity of the output list
 	}
 
-	void InconsDLAtom::retrieve(const Query& query, Answer& answer,
-			NogoodContainerPtr nogoods) {
+	void InconsDLAtom::evaluate(const Query& query, Answer& answer) {
 
-		DBGLOG(DBG, "InconsDLAtom::retrieve");
+		DBGLOG(DBG, "InconsDLAtom::evaluate");
 
 		RegistryPtr reg = getRegistry();
 
@@ -2008,15 +2307,12 @@ namespace dllite {
 		&& (query.input.size() < 6 || query.input[5].address == 1);
 		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(
 				ctx, query.input[0], useAbox);
-		std::vector<TDLAxiom*> addedAxioms = expandAbox(query, useAbox, false);
+		UpdateBatchPtr batch = getUpdateBatch(query, ontology, useAbox, false);
 
 		// handle inconsistency
-		if (!ontology->kernel->isKBConsistent()) {
+		if (!isConsistent(ontology, *batch, false)) {
 			answer.get().push_back(Tuple());
 		}
-
-		DBGLOG(DBG, "Inconsistency check complete, recovering Abox");
-		restoreAbox(query, addedAxioms);
 	}
 
 }
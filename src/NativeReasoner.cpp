@@ -0,0 +1,560 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file NativeReasoner.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Native instance retrieval and consistency checking for DL-Lite ontologies.
+ *
+ * In DL-Lite, an individual a is an instance of a basic concept B iff the Abox
+ * contains an assertion B'(a) resp. R(a,b) such that B' resp. exR is subsumed by B.
+ * The ontology is inconsistent iff some individual (pair of individuals) is a member
+ * of two basic concepts (roles) which are in conflict according to the classification.
+ * or if some individual has two different fillers of a functional role (under the unique
+ * name assumption of DL-Lite).
+ * Since every such membership follows from a single assertion, the consistency of the
+ * Abox extended by an update can be decided by checking the memberships which follow
+ * from the update against each other and against the (consistent) Abox.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "NativeReasoner.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Printer.h"
+
+#include <bm/bmalgo.h>
+#include "boost/foreach.hpp"
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <iterator>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+	extern DLLitePlugin theDLLitePlugin;
+
+	// ============================== Class NativeReasoner::Update ==============================
+
+	void NativeReasoner::Update::addConceptAssertion(ID concept, ID individual) {
+		concepts[concept.address].set_bit(individual.address);
+	}
+
+	void NativeReasoner::Update::addRoleAssertion(ID role, ID individual1, ID individual2) {
+		roles[role.address].push_back(Pair(individual1.address, individual2.address));
+	}
+
+	void NativeReasoner::Update::add(const Update& other) {
+		typedef std::pair<IDAddress, Individuals> ConceptPair;
+		BOOST_FOREACH (const ConceptPair& cp, other.concepts) concepts[cp.first] |= cp.second;
+		typedef std::pair<IDAddress, Pairs> RolePair;
+		BOOST_FOREACH (const RolePair& rp, other.roles) roles[rp.first].insert(roles[rp.first].end(), rp.second.begin(), rp.second.end());
+	}
+
+	// ============================== Class NativeReasoner::MembershipHash ==============================
+
+	std::size_t NativeReasoner::MembershipHash::operator()(const Membership& m) const {
+		std::size_t seed = 0;
+		boost::hash_combine(seed, m.term);
+		boost::hash_combine(seed, m.first);
+		boost::hash_combine(seed, m.second);
+		return seed;
+	}
+
+	// ============================== Class NativeReasoner ==============================
+
+	NativeReasoner::NativeReasoner(RegistryPtr reg, const DLLitePlugin::CachedOntology& ontology) : reg(reg), classification(ontology.classificationIndex), baseRoles(ontology.includeAbox ? &ontology.roleAssertionIndex : NULL), baseConsistent(-1) {
+
+		assert(!!classification && "classification must be computed before the native reasoner is created");
+
+		// type of the terms in the classification
+		const unsigned n = classification->size();
+		existentialRoles.assign(n, ID_FAIL);
+		roleTerms.assign(n, false);
+		functTerms.assign(n, false);
+		for (unsigned i = 0; i < n; ++i) {
+			ID term = classification->getTerm(i);
+			if (theDLLitePlugin.isDlEx(term)) {
+				existentialRoles[i] = theDLLitePlugin.dlRemoveEx(term);
+				unsigned roleIndex = classification->getIndex(existentialRoles[i]);
+				if (roleIndex != ClassificationIndex::npos) existentials[roleIndex] = i;
+			} else if (ontology.roles->getFact(term.address)) {
+				roleTerms[i] = true;
+				functTerms[i] = classification->isFunct(term);
+			} else if (theDLLitePlugin.isDlNeg(term) && !theDLLitePlugin.isDlEx(theDLLitePlugin.dlNeg(term))) {
+				roleTerms[i] = ontology.roles->getFact(theDLLitePlugin.dlNeg(term).address);
+			}
+		}
+		baseMembers.resize(n);
+		baseMembersComputed.assign(n, false);
+
+		// posting lists of the Abox
+		if (ontology.includeAbox) {
+			bm::bvector<>::enumerator en = ontology.conceptAssertions->getStorage().first();
+			bm::bvector<>::enumerator en_end = ontology.conceptAssertions->getStorage().end();
+			while (en < en_end) {
+				const OrdinaryAtom& guard = reg->ogatoms.getByAddress(*en);
+				baseConcepts[guard.tuple[1].address].set_bit(guard.tuple[2].address);
+				en++;
+			}
+		}
+		DBGLOG(DBG, "Native reasoner: " << baseConcepts.size() << " concept posting lists and " << (baseRoles ? baseRoles->size() : 0) << " role assertions");
+	}
+
+	void NativeReasoner::addConceptMembers(unsigned index, const Update& update, bool includeBase, Individuals& members) const {
+
+		IDAddress term = classification->getTerm(index).address;
+		boost::unordered_map<IDAddress, Individuals>::const_iterator it;
+		if (includeBase) {
+			it = baseConcepts.find(term);
+			if (it != baseConcepts.end()) members |= it->second;
+		}
+		it = update.concepts.find(term);
+		if (it != update.concepts.end()) members |= it->second;
+
+		if (existentialRoles[index] != ID_FAIL) collectRole(existentialRoles[index], update, includeBase, NULL, &members);
+	}
+
+	void NativeReasoner::addRoleMembers(ID role, bool swapped, const Update& update, bool includeBase, Pairs* pairs, Individuals* subjects) const {
+
+		// bulk access to the Abox of the ontology
+		if (includeBase && baseRoles) {
+			if (pairs) baseRoles->getPairs(role, swapped, *pairs);
+			if (subjects) baseRoles->getSubjects(role, swapped, *subjects);
+		}
+
+		boost::unordered_map<IDAddress, Pairs>::const_iterator it = update.roles.find(role.address);
+		if (it == update.roles.end()) return;
+		BOOST_FOREACH (const Pair& p, it->second) {
+			Pair pair = swapped ? Pair(p.second, p.first) : p;
+			if (pairs) pairs->push_back(pair);
+			if (subjects) subjects->set_bit(pair.first);
+		}
+	}
+
+	void NativeReasoner::getRoleStates(unsigned index, bool upward, std::vector<unsigned>& states) const {
+
+		std::vector<bool> visited(2 * classification->size(), false);
+		states.push_back(2 * index);
+		visited[2 * index] = true;
+		for (unsigned k = 0; k < states.size(); ++k) {
+			unsigned x = states[k] / 2;
+			bool swapped = (states[k] % 2 == 1);
+
+			// subroles (resp. superroles) keep the direction, inverses flip it
+			const ClassificationIndex::Row& related = (upward ? classification->getSubsumers(x) : classification->getSubsumees(x));
+			ClassificationIndex::Row::enumerator en = related.first();
+			ClassificationIndex::Row::enumerator en_end = related.end();
+			while (en < en_end) {
+				unsigned next = 2 * (*en) + (swapped ? 1 : 0);
+				if (!visited[next]) {
+					visited[next] = true;
+					states.push_back(next);
+				}
+				en++;
+			}
+			en = classification->getInverses(x).first();
+			en_end = classification->getInverses(x).end();
+			while (en < en_end) {
+				unsigned next = 2 * (*en) + (swapped ? 0 : 1);
+				if (!visited[next]) {
+					visited[next] = true;
+					states.push_back(next);
+				}
+				en++;
+			}
+		}
+	}
+
+	bool NativeReasoner::hasRoleMember(ID role, IDAddress first, IDAddress second, const Update& update, bool includeBase) const {
+
+		if (includeBase && baseRoles && baseRoles->contains(role, ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, first), ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, second))) return true;
+		boost::unordered_map<IDAddress, Pairs>::const_iterator it = update.roles.find(role.address);
+		return it != update.roles.end() && std::find(it->second.begin(), it->second.end(), Pair(first, second)) != it->second.end();
+	}
+
+	bool NativeReasoner::hasRoleFiller(ID role, IDAddress individual, bool swapped, const Update& update, bool includeBase) const {
+
+		if (includeBase && baseRoles && baseRoles->hasFiller(role, individual, swapped)) return true;
+		boost::unordered_map<IDAddress, Pairs>::const_iterator it = update.roles.find(role.address);
+		if (it == update.roles.end()) return false;
+		BOOST_FOREACH (const Pair& p, it->second) {
+			if ((swapped ? p.second : p.first) == individual) return true;
+		}
+		return false;
+	}
+
+	void NativeReasoner::collectRole(ID role, const Update& update, bool includeBase, Pairs* pairs, Individuals* subjects) const {
+
+		unsigned index = classification->getIndex(role);
+		if (index == ClassificationIndex::npos) {
+			addRoleMembers(role, false, update, includeBase, pairs, subjects);
+			return;
+		}
+
+		// all subroles S of R contribute S(a,b) and all subroles of inv(R) contribute S(b,a)
+		std::vector<unsigned> states;
+		getRoleStates(index, false, states);
+		BOOST_FOREACH (unsigned state, states) {
+			addRoleMembers(classification->getTerm(state / 2), state % 2 == 1, update, includeBase, pairs, subjects);
+		}
+	}
+
+	bool NativeReasoner::checkAll(const Update& update) const {
+
+		DBGLOG(DBG, "Native consistency check of all conflicts");
+
+		// members of the terms which are involved in conflicts (computed on demand)
+		const unsigned n = classification->size();
+		std::vector<bool> computed(n, false);
+		std::vector<Individuals> conceptMembers(n);
+		std::vector<Pairs> roleMembers(n);
+
+		for (unsigned x = 0; x < n; ++x) {
+			const ClassificationIndex::Row& conflicts = classification->getConflicts(x);
+			if (!conflicts.any()) continue;
+
+			unsigned terms[2] = { x, 0 };
+			ClassificationIndex::Row::enumerator en = conflicts.first();
+			ClassificationIndex::Row::enumerator en_end = conflicts.end();
+			while (en < en_end) {
+				terms[1] = *en;
+				en++;
+				if (roleTerms[x] != roleTerms[terms[1]]) continue;
+
+				for (int t = 0; t < 2; ++t) {
+					unsigned i = terms[t];
+					if (computed[i]) continue;
+					computed[i] = true;
+					if (roleTerms[i]) {
+						collectRole(classification->getTerm(i), update, true, &roleMembers[i], NULL);
+						std::sort(roleMembers[i].begin(), roleMembers[i].end());
+						roleMembers[i].erase(std::unique(roleMembers[i].begin(), roleMembers[i].end()), roleMembers[i].end());
+					} else {
+						addConceptMembers(i, update, true, conceptMembers[i]);
+					}
+				}
+
+				unsigned y = terms[1];
+				bool clash;
+				if (roleTerms[x]) {
+					Pairs common;
+					std::set_intersection(roleMembers[x].begin(), roleMembers[x].end(), roleMembers[y].begin(), roleMembers[y].end(), std::back_inserter(common));
+					clash = !common.empty();
+				} else {
+					clash = (bm::count_and(conceptMembers[x], conceptMembers[y]) > 0);
+				}
+				if (clash) {
+					DBGLOG(DBG, "Native reasoner: conflict between " << RawPrinter::toString(reg, classification->getTerm(x)) << " and " << RawPrinter::toString(reg, classification->getTerm(y)));
+					return false;
+				}
+			}
+		}
+
+		// functional roles
+		for (unsigned x = 0; x < n; ++x) {
+			if (!functTerms[x]) continue;
+			if (!computed[x]) {
+				collectRole(classification->getTerm(x), update, true, &roleMembers[x], NULL);
+				std::sort(roleMembers[x].begin(), roleMembers[x].end());
+				roleMembers[x].erase(std::unique(roleMembers[x].begin(), roleMembers[x].end()), roleMembers[x].end());
+			}
+			if (hasTwoFillers(roleMembers[x])) {
+				DBGLOG(DBG, "Native reasoner: two fillers of functional role " << RawPrinter::toString(reg, classification->getTerm(x)));
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool NativeReasoner::hasTwoFillers(const Pairs& pairs) {
+
+		for (unsigned k = 1; k < pairs.size(); ++k) {
+			if (pairs[k].first == pairs[k - 1].first) return true;
+		}
+		return false;
+	}
+
+	void NativeReasoner::getMemberships(const Update& update, Memberships& memberships) const {
+
+		typedef std::pair<IDAddress, Individuals> ConceptPair;
+		BOOST_FOREACH (const ConceptPair& cp, update.concepts) {
+			unsigned index = classification->getIndex(reg->terms.getIDByAddress(cp.first));
+			if (index == ClassificationIndex::npos) continue;
+			Individuals::enumerator en = cp.second.first();
+			Individuals::enumerator en_end = cp.second.end();
+			while (en < en_end) {
+				memberships.insert(Membership(index, *en, 0));
+				en++;
+			}
+		}
+
+		typedef std::pair<IDAddress, Pairs> RolePair;
+		BOOST_FOREACH (const RolePair& rp, update.roles) {
+			unsigned index = classification->getIndex(reg->terms.getIDByAddress(rp.first));
+			if (index == ClassificationIndex::npos) continue;
+
+			// R(a,b) implies S(a,b) for all superroles S of R and S(b,a) for all superroles of inv(R)
+			std::vector<unsigned> states;
+			getRoleStates(index, true, states);
+			BOOST_FOREACH (unsigned state, states) {
+				unsigned x = state / 2;
+				bool swapped = (state % 2 == 1);
+				boost::unordered_map<unsigned, unsigned>::const_iterator ex = existentials.find(x);
+				BOOST_FOREACH (const Pair& p, rp.second) {
+					Pair pair = swapped ? Pair(p.second, p.first) : p;
+					memberships.insert(Membership(x, pair.first, pair.second));
+					if (ex != existentials.end()) memberships.insert(Membership(ex->second, pair.first, 0));
+				}
+			}
+		}
+	}
+
+	bool NativeReasoner::clashesWithBase(const Membership& m) const {
+
+		boost::unordered_map<Membership, bool, MembershipHash>::const_iterator it = baseClashes.find(m);
+		if (it != baseClashes.end()) return it->second;
+
+		bool clash = false;
+		ClassificationIndex::Row::enumerator en = classification->getConflicts(m.term).first();
+		ClassificationIndex::Row::enumerator en_end = classification->getConflicts(m.term).end();
+		while (!clash && en < en_end) {
+			unsigned y = *en;
+			en++;
+			if (roleTerms[m.term] != roleTerms[y]) continue;
+			if (roleTerms[y]) {
+				clash = isRoleMember(classification->getTerm(y), m.first, m.second, Update(), true);
+			} else {
+				if (!baseMembersComputed[y]) {
+					addConceptMembers(y, Update(), true, baseMembers[y]);
+					baseMembersComputed[y] = true;
+				}
+				clash = baseMembers[y].get_bit(m.first);
+			}
+			if (clash) DBGLOG(DBG, "Native reasoner: update conflicts with " << RawPrinter::toString(reg, classification->getTerm(y)) << " in the Abox");
+		}
+
+		// another filler of a functional role in the Abox
+		if (!clash && functTerms[m.term]) {
+			boost::unordered_map<unsigned, Pairs>::iterator fp = baseFunctPairs.find(m.term);
+			if (fp == baseFunctPairs.end()) {
+				fp = baseFunctPairs.insert(std::make_pair(m.term, Pairs())).first;
+				collectRole(classification->getTerm(m.term), Update(), true, &fp->second, NULL);
+				std::sort(fp->second.begin(), fp->second.end());
+				fp->second.erase(std::unique(fp->second.begin(), fp->second.end()), fp->second.end());
+			}
+			Pairs::const_iterator it = std::lower_bound(fp->second.begin(), fp->second.end(), Pair(m.first, 0));
+			for (; !clash && it != fp->second.end() && it->first == m.first; ++it) clash = (it->second != m.second);
+			if (clash) DBGLOG(DBG, "Native reasoner: update adds a filler of functional role " << RawPrinter::toString(reg, classification->getTerm(m.term)) << " to the Abox");
+		}
+		baseClashes[m] = clash;
+		return clash;
+	}
+
+	bool NativeReasoner::isConsistent(const Update& update) const {
+
+		boost::mutex::scoped_lock lock(mutex);
+		if (baseConsistent == -1) baseConsistent = checkAll(Update()) ? 1 : 0;
+		if (baseConsistent == 0) return false;
+		if (update.empty()) return true;
+
+		DBGLOG(DBG, "Native incremental consistency check");
+		Memberships memberships;
+		getMemberships(update, memberships);
+		boost::unordered_map<std::pair<unsigned, IDAddress>, IDAddress> fillers;	// of functional roles within the update
+		BOOST_FOREACH (const Membership& m, memberships) {
+			if (clashesWithBase(m)) return false;
+
+			if (functTerms[m.term]) {
+				std::pair<boost::unordered_map<std::pair<unsigned, IDAddress>, IDAddress>::iterator, bool> f = fillers.insert(std::make_pair(std::make_pair(m.term, m.first), m.second));
+				if (!f.second && f.first->second != m.second) {
+					DBGLOG(DBG, "Native reasoner: two fillers of functional role " << RawPrinter::toString(reg, classification->getTerm(m.term)) << " within the update");
+					return false;
+				}
+			}
+
+			// conflicts within the update
+			ClassificationIndex::Row::enumerator en = classification->getConflicts(m.term).first();
+			ClassificationIndex::Row::enumerator en_end = classification->getConflicts(m.term).end();
+			while (en < en_end) {
+				if (roleTerms[m.term] == roleTerms[*en] && memberships.count(Membership(*en, m.first, m.second)) > 0) {
+					DBGLOG(DBG, "Native reasoner: conflict between " << RawPrinter::toString(reg, classification->getTerm(m.term)) << " and " << RawPrinter::toString(reg, classification->getTerm(*en)) << " within the update");
+					return false;
+				}
+				en++;
+			}
+		}
+		return true;
+	}
+
+	void NativeReasoner::getConflicts(const std::vector<Update>& assertions, std::vector<std::pair<unsigned, unsigned> >& conflicts) const {
+
+		// assertions by the memberships which follow from them
+		boost::unordered_map<Membership, std::vector<unsigned>, MembershipHash> owners;
+		std::vector<Memberships> memberships(assertions.size());
+		for (unsigned i = 0; i < assertions.size(); ++i) {
+			getMemberships(assertions[i], memberships[i]);
+			BOOST_FOREACH (const Membership& m, memberships[i]) owners[m].push_back(i);
+		}
+
+		boost::unordered_set<std::pair<unsigned, unsigned> > found;
+		boost::unordered_map<std::pair<unsigned, IDAddress>, std::vector<std::pair<IDAddress, unsigned> > > functional;
+		for (unsigned i = 0; i < assertions.size(); ++i) {
+			BOOST_FOREACH (const Membership& m, memberships[i]) {
+				if (functTerms[m.term]) functional[std::make_pair(m.term, m.first)].push_back(std::make_pair(m.second, i));
+				ClassificationIndex::Row::enumerator en = classification->getConflicts(m.term).first();
+				ClassificationIndex::Row::enumerator en_end = classification->getConflicts(m.term).end();
+				while (en < en_end) {
+					if (roleTerms[m.term] == roleTerms[*en]) {
+						boost::unordered_map<Membership, std::vector<unsigned>, MembershipHash>::const_iterator it = owners.find(Membership(*en, m.first, m.second));
+						if (it != owners.end()) {
+							BOOST_FOREACH (unsigned j, it->second) {
+								if (j >= i) found.insert(std::make_pair(i, j));
+							}
+						}
+					}
+					en++;
+				}
+			}
+		}
+
+		// two different fillers of a functional role (unique name assumption)
+		typedef std::pair<std::pair<unsigned, IDAddress>, std::vector<std::pair<IDAddress, unsigned> > > FunctionalPair;
+		BOOST_FOREACH (const FunctionalPair& fp, functional) {
+			for (unsigned k = 0; k < fp.second.size(); ++k) {
+				for (unsigned l = k + 1; l < fp.second.size(); ++l) {
+					if (fp.second[k].first == fp.second[l].first || fp.second[k].second == fp.second[l].second) continue;
+					found.insert(std::make_pair(std::min(fp.second[k].second, fp.second[l].second), std::max(fp.second[k].second, fp.second[l].second)));
+				}
+			}
+		}
+
+		conflicts.assign(found.begin(), found.end());
+		std::sort(conflicts.begin(), conflicts.end());
+		DBGLOG(DBG, "Native reasoner: " << conflicts.size() << " conflicts between " << assertions.size() << " assertions");
+	}
+
+	void NativeReasoner::getInstances(ID concept, const Update& update, bool includeBase, Individuals& instances) const {
+
+		unsigned index = classification->getIndex(concept);
+		if (index == ClassificationIndex::npos) {
+			// the concept does not occur in the Tbox, thus only its assertions are relevant
+			boost::unordered_map<IDAddress, Individuals>::const_iterator it;
+			if (includeBase) {
+				it = baseConcepts.find(concept.address);
+				if (it != baseConcepts.end()) instances |= it->second;
+			}
+			it = update.concepts.find(concept.address);
+			if (it != update.concepts.end()) instances |= it->second;
+			return;
+		}
+
+		// union of the posting lists of all subsumees
+		ClassificationIndex::Row::enumerator en = classification->getSubsumees(index).first();
+		ClassificationIndex::Row::enumerator en_end = classification->getSubsumees(index).end();
+		while (en < en_end) {
+			addConceptMembers(*en, update, includeBase, instances);
+			en++;
+		}
+	}
+
+	void NativeReasoner::getRoleExtension(ID role, const Update& update, bool includeBase, Pairs& extension) const {
+
+		collectRole(role, update, includeBase, &extension, NULL);
+		std::sort(extension.begin(), extension.end());
+		extension.erase(std::unique(extension.begin(), extension.end()), extension.end());
+	}
+
+	bool NativeReasoner::isInstance(ID concept, IDAddress individual, const Update& update, bool includeBase) const {
+
+		// asserted members of the concept itself (the only ones if it does not occur in the Tbox)
+		boost::unordered_map<IDAddress, Individuals>::const_iterator it;
+		unsigned index = classification->getIndex(concept);
+		if (index == ClassificationIndex::npos) {
+			if (includeBase) {
+				it = baseConcepts.find(concept.address);
+				if (it != baseConcepts.end() && it->second.get_bit(individual)) return true;
+			}
+			it = update.concepts.find(concept.address);
+			return it != update.concepts.end() && it->second.get_bit(individual);
+		}
+
+		// otherwise check the posting lists of the subsumees, where a is a member of exR iff R(a,b) for some b
+		ClassificationIndex::Row::enumerator en = classification->getSubsumees(index).first();
+		ClassificationIndex::Row::enumerator en_end = classification->getSubsumees(index).end();
+		while (en < en_end) {
+			IDAddress term = classification->getTerm(*en).address;
+			if (includeBase) {
+				it = baseConcepts.find(term);
+				if (it != baseConcepts.end() && it->second.get_bit(individual)) return true;
+			}
+			it = update.concepts.find(term);
+			if (it != update.concepts.end() && it->second.get_bit(individual)) return true;
+
+			ID role = existentialRoles[*en];
+			if (role != ID_FAIL) {
+				unsigned roleIndex = classification->getIndex(role);
+				if (roleIndex == ClassificationIndex::npos) {
+					if (hasRoleFiller(role, individual, false, update, includeBase)) return true;
+				} else {
+					std::vector<unsigned> states;
+					getRoleStates(roleIndex, false, states);
+					BOOST_FOREACH (unsigned state, states) {
+						if (hasRoleFiller(classification->getTerm(state / 2), individual, state % 2 == 1, update, includeBase)) return true;
+					}
+				}
+			}
+			en++;
+		}
+		return false;
+	}
+
+	bool NativeReasoner::isRoleMember(ID role, IDAddress first, IDAddress second, const Update& update, bool includeBase) const {
+
+		unsigned index = classification->getIndex(role);
+		if (index == ClassificationIndex::npos) return hasRoleMember(role, first, second, update, includeBase);
+
+		std::vector<unsigned> states;
+		getRoleStates(index, false, states);
+		BOOST_FOREACH (unsigned state, states) {
+			bool swapped = (state % 2 == 1);
+			if (hasRoleMember(classification->getTerm(state / 2), swapped ? second : first, swapped ? first : second, update, includeBase)) return true;
+		}
+		return false;
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
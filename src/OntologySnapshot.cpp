@@ -0,0 +1,513 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file OntologySnapshot.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Persistent snapshots of the information derived from an ontology.
+ *
+ * A snapshot stores the vocabulary, the concept and role assertions, the Abox predicates,
+ * the classification and (if they capture the whole Tbox) the Tbox axioms of a CachedOntology.
+ * It is keyed by a hash of the owl-file, such that a later run on the same file can map the
+ * snapshot instead of parsing the ontology and computing the classification again. Terms
+ * and atoms are interned into the registry of the run, since IDs are registry addresses.
+ *
+ * Layout (native byte order, all integers are 32 bit unsigned):
+ *   header:   magic, version, byte order mark, hash, includeAbox, hasClassification,
+ *             hasTboxAxioms, functionalRoles
+ *   strings:  ontology path, namespace and version
+ *   terms:    number of terms, then (kind, symbol) for each term
+ *   sections: concepts, roles, individuals, Abox predicates (term indices),
+ *             concept assertions (pairs), role assertions (triples),
+ *             classification and Tbox axioms (kind, arity and term indices per atom)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "DLLitePlugin.h"
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Logger.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+#include "boost/foreach.hpp"
+#include "boost/filesystem.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+	extern DLLitePlugin theDLLitePlugin;
+
+	namespace {
+
+		const char snapshotMagic[8] = { 'D', 'L', 'L', 'S', 'N', 'A', 'P', '\0' };
+		const boost::uint32_t snapshotVersion = 2;
+		const boost::uint32_t byteOrderMark = 0x01020304;
+
+		// read-only view of a file; the file is memory-mapped where possible
+		class MappedFile {
+		private:
+			const char* data;
+			std::size_t length;
+#ifdef WIN32
+			std::vector<char> buffer;
+#endif
+
+		public:
+			MappedFile(const std::string& filename) : data(NULL), length(0) {
+#ifdef WIN32
+				std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+				if (!file) return;
+				buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+				data = buffer.size() > 0 ? &buffer[0] : NULL;
+				length = buffer.size();
+#else
+				int fd = open(filename.c_str(), O_RDONLY);
+				if (fd < 0) return;
+				struct stat st;
+				if (fstat(fd, &st) == 0 && st.st_size > 0) {
+					void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (addr != MAP_FAILED) {
+						data = static_cast<const char*>(addr);
+						length = st.st_size;
+					}
+				}
+				close(fd);
+#endif
+			}
+
+			~MappedFile() {
+#ifndef WIN32
+				if (data != NULL) munmap(const_cast<char*>(data), length);
+#endif
+			}
+
+			bool isOpen() const { return data != NULL; }
+			const char* begin() const { return data; }
+			const char* end() const { return data + length; }
+			std::size_t size() const { return length; }
+		};
+
+		// sequential reader over a mapped snapshot; throws if the snapshot is truncated
+		class SnapshotReader {
+		private:
+			const char* pos;
+			const char* end;
+
+		public:
+			struct Truncated {};
+
+			SnapshotReader(const char* begin, const char* end) : pos(begin), end(end) {}
+
+			void readBytes(char* out, std::size_t n) {
+				if (end - pos < (std::ptrdiff_t)n) throw Truncated();
+				std::memcpy(out, pos, n);
+				pos += n;
+			}
+
+			boost::uint32_t readUInt() {
+				boost::uint32_t value;
+				readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+				return value;
+			}
+
+			std::string readString() {
+				boost::uint32_t len = readUInt();
+				if (end - pos < (std::ptrdiff_t)len) throw Truncated();
+				std::string str(pos, len);
+				pos += len;
+				return str;
+			}
+
+			bool atEnd() const { return pos == end; }
+		};
+
+		class SnapshotWriter {
+		private:
+			std::ostream& out;
+
+		public:
+			SnapshotWriter(std::ostream& out) : out(out) {}
+
+			void writeBytes(const char* data, std::size_t n) {
+				out.write(data, n);
+			}
+
+			void writeUInt(boost::uint32_t value) {
+				writeBytes(reinterpret_cast<const char*>(&value), sizeof(value));
+			}
+
+			void writeString(const std::string& str) {
+				writeUInt(str.length());
+				writeBytes(str.data(), str.length());
+			}
+		};
+
+		// assigns consecutive indices to the terms which occur in the snapshot
+		class TermTable {
+		private:
+			RegistryPtr reg;
+			std::map<std::pair<IDKind, IDAddress>, boost::uint32_t> index;
+			std::vector<ID> terms;
+
+		public:
+			TermTable(RegistryPtr reg) : reg(reg) {}
+
+			boost::uint32_t get(ID id) {
+				std::pair<IDKind, IDAddress> key(id.kind, id.address);
+				std::map<std::pair<IDKind, IDAddress>, boost::uint32_t>::iterator it = index.find(key);
+				if (it != index.end()) return it->second;
+				boost::uint32_t i = terms.size();
+				index[key] = i;
+				terms.push_back(id);
+				return i;
+			}
+
+			void write(SnapshotWriter& writer) const {
+				writer.writeUInt(terms.size());
+				BOOST_FOREACH (ID id, terms) {
+					writer.writeUInt(id.kind);
+					if (id.isIntegerTerm()) writer.writeString(boost::lexical_cast<std::string>(id.address));
+					else writer.writeString(reg->terms.getByID(id).symbol);
+				}
+			}
+		};
+
+		// translates a section of term indices into the IDs of the current registry
+		ID termAt(const std::vector<ID>& terms, boost::uint32_t i) {
+			if (i >= terms.size()) throw SnapshotReader::Truncated();
+			return terms[i];
+		}
+
+		void writeTerms(SnapshotWriter& writer, TermTable& table, InterpretationConstPtr intr) {
+			writer.writeUInt(intr->getStorage().count());
+			bm::bvector<>::enumerator en = intr->getStorage().first();
+			bm::bvector<>::enumerator en_end = intr->getStorage().end();
+			while (en < en_end) {
+				writer.writeUInt(table.get(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, *en)));
+				en++;
+			}
+		}
+
+		void readTerms(SnapshotReader& reader, const std::vector<ID>& terms, InterpretationPtr intr) {
+			boost::uint32_t count = reader.readUInt();
+			for (boost::uint32_t i = 0; i < count; ++i) {
+				intr->setFact(termAt(terms, reader.readUInt()).address);
+			}
+		}
+
+		void writeFacts(SnapshotWriter& writer, TermTable& table, RegistryPtr reg, InterpretationConstPtr intr) {
+			writer.writeUInt(intr->getStorage().count());
+			bm::bvector<>::enumerator en = intr->getStorage().first();
+			bm::bvector<>::enumerator en_end = intr->getStorage().end();
+			while (en < en_end) {
+				const OrdinaryAtom& fact = reg->ogatoms.getByAddress(*en);
+				writer.writeUInt(fact.kind);
+				writer.writeUInt(fact.tuple.size());
+				BOOST_FOREACH (ID t, fact.tuple) writer.writeUInt(table.get(t));
+				en++;
+			}
+		}
+
+		InterpretationPtr readFacts(SnapshotReader& reader, const std::vector<ID>& terms, RegistryPtr reg) {
+			InterpretationPtr intr(new Interpretation(reg));
+			boost::uint32_t count = reader.readUInt();
+			for (boost::uint32_t i = 0; i < count; ++i) {
+				OrdinaryAtom fact(reader.readUInt());
+				boost::uint32_t arity = reader.readUInt();
+				for (boost::uint32_t j = 0; j < arity; ++j) {
+					fact.tuple.push_back(termAt(terms, reader.readUInt()));
+				}
+				intr->setFact(reg->storeOrdinaryAtom(fact).address);
+			}
+			return intr;
+		}
+	}
+
+	std::string DLLitePlugin::CachedOntology::computeFileHash(const std::string& filename) {
+
+		MappedFile file(filename);
+		if (!file.isOpen()) return "";
+
+		// 64 bit FNV-1a over the file content
+		boost::uint64_t hash = 14695981039346656037ULL;
+		for (const char* c = file.begin(); c != file.end(); ++c) {
+			hash ^= (unsigned char)*c;
+			hash *= 1099511628211ULL;
+		}
+
+		std::stringstream ss;
+		ss << std::hex << std::setw(16) << std::setfill('0') << hash << "-" << std::dec << file.size();
+		return ss.str();
+	}
+
+	std::string DLLitePlugin::CachedOntology::getSnapshotFile() const {
+		return (boost::filesystem::path(snapshotDir) / (fileHash + (includeAbox ? "-abox" : "-tbox") + ".snapshot")).string();
+	}
+
+	bool DLLitePlugin::CachedOntology::restoreSnapshot() {
+
+		assert(!concepts && "snapshot must be restored before the ontology is analyzed");
+
+		MappedFile file(getSnapshotFile());
+		if (!file.isOpen()) {
+			DBGLOG(DBG, "No snapshot found for ontology " << reg->terms.getByID(ontologyName).getUnquotedString());
+			return false;
+		}
+
+		DBGLOG(DBG, "Restoring ontology from snapshot " << getSnapshotFile());
+		try {
+			SnapshotReader reader(file.begin(), file.end());
+
+			// check the header
+			char magic[8];
+			reader.readBytes(magic, 8);
+			if (std::memcmp(magic, snapshotMagic, 8) != 0 || reader.readUInt() != snapshotVersion || reader.readUInt() != byteOrderMark) {
+				LOG(WARNING, "Ignoring incompatible snapshot " << getSnapshotFile());
+				return false;
+			}
+			if (reader.readString() != fileHash || (reader.readUInt() != 0) != includeAbox) {
+				LOG(WARNING, "Ignoring snapshot " << getSnapshotFile() << ", which belongs to a different ontology");
+				return false;
+			}
+			bool hasClassification = (reader.readUInt() != 0);
+			bool hasTboxAxioms = (reader.readUInt() != 0);
+			bool functional = (reader.readUInt() != 0);
+
+			std::string path = reader.readString();
+			std::string ns = reader.readString();
+			std::string version = reader.readString();
+
+			// intern the terms
+			std::vector<ID> terms;
+			boost::uint32_t termCount = reader.readUInt();
+			terms.reserve(termCount);
+			for (boost::uint32_t i = 0; i < termCount; ++i) {
+				IDKind kind = reader.readUInt();
+				std::string symbol = reader.readString();
+				if ((kind & ID::SUBKIND_MASK) == ID::SUBKIND_TERM_INTEGER) {
+					terms.push_back(ID::termFromInteger(boost::lexical_cast<boost::uint32_t>(symbol)));
+				} else {
+					ID id = reg->terms.getIDByString(symbol);
+					if (id == ID_FAIL) id = reg->terms.storeAndGetID(Term(kind, symbol));
+					terms.push_back(id);
+				}
+			}
+
+			// vocabulary
+			InterpretationPtr newConcepts(new Interpretation(reg));
+			InterpretationPtr newRoles(new Interpretation(reg));
+			InterpretationPtr newIndividuals(new Interpretation(reg));
+			readTerms(reader, terms, newConcepts);
+			readTerms(reader, terms, newRoles);
+			readTerms(reader, terms, newIndividuals);
+
+			std::vector<ID> newAboxPredicates;
+			boost::uint32_t predCount = reader.readUInt();
+			for (boost::uint32_t i = 0; i < predCount; ++i) {
+				newAboxPredicates.push_back(termAt(terms, reader.readUInt()));
+			}
+
+			// assertions
+			InterpretationPtr newConceptAssertions(new Interpretation(reg));
+			boost::uint32_t caCount = reader.readUInt();
+			for (boost::uint32_t i = 0; i < caCount; ++i) {
+				OrdinaryAtom guard = theDLLitePlugin.getNewGuardAtom(true /* ground! */);
+				guard.tuple.push_back(termAt(terms, reader.readUInt()));
+				guard.tuple.push_back(termAt(terms, reader.readUInt()));
+				newConceptAssertions->setFact(reg->storeOrdinaryAtom(guard).address);
+			}
+
+			std::vector<RoleAssertion> newRoleAssertions;
+			boost::uint32_t raCount = reader.readUInt();
+			newRoleAssertions.reserve(raCount);
+			for (boost::uint32_t i = 0; i < raCount; ++i) {
+				ID role = termAt(terms, reader.readUInt());
+				ID individual1 = termAt(terms, reader.readUInt());
+				ID individual2 = termAt(terms, reader.readUInt());
+				newRoleAssertions.push_back(RoleAssertion(role, std::pair<ID, ID>(individual1, individual2)));
+			}
+
+			// classification and Tbox axioms
+			InterpretationPtr newClassification, newTboxAxioms;
+			if (hasClassification) newClassification = readFacts(reader, terms, reg);
+			if (hasTboxAxioms) newTboxAxioms = readFacts(reader, terms, reg);
+
+			if (!reader.atEnd()) {
+				LOG(WARNING, "Ignoring corrupt snapshot " << getSnapshotFile());
+				return false;
+			}
+
+			// everything was read successfully
+			ontologyPath = path;
+			ontologyNamespace = ns;
+			ontologyVersion = version;
+			concepts = newConcepts;
+			roles = newRoles;
+			individuals = newIndividuals;
+			AboxPredicates = newAboxPredicates;
+			conceptAssertions = newConceptAssertions;
+			roleAssertions = newRoleAssertions;
+			roleAssertionIndex.clear();
+			BOOST_FOREACH (RoleAssertion ra, roleAssertions) roleAssertionIndex.add(ra.first, ra.second.first, ra.second.second);
+			roleAssertionIndex.finalize();
+			classification = newClassification;
+			if (!!classification) {
+				classificationIndex = ClassificationIndexPtr(new ClassificationIndex(reg));
+				classificationIndex->load(classification);
+			}
+			functionalRoles = functional;
+			tboxAxioms = newTboxAxioms;
+
+			// the classification can then be computed without reading the owl-file as well
+			if (!classification) tboxFacts = tboxAxioms;
+		} catch (const SnapshotReader::Truncated&) {
+			LOG(WARNING, "Ignoring truncated snapshot " << getSnapshotFile());
+			return false;
+		} catch (const boost::bad_lexical_cast&) {
+			LOG(WARNING, "Ignoring corrupt snapshot " << getSnapshotFile());
+			return false;
+		}
+
+		DBGLOG(DBG, "Restored snapshot " << (!!classification ? "with" : "without") << " classification and " << (!!tboxAxioms ? "with" : "without") << " Tbox axioms");
+		return true;
+	}
+
+	void DLLitePlugin::CachedOntology::saveSnapshot() const {
+
+		assert(!!concepts && "ontology must be analyzed before a snapshot can be saved");
+
+		std::string filename = getSnapshotFile();
+		DBGLOG(DBG, "Writing snapshot " << filename);
+
+		try {
+			boost::filesystem::create_directories(boost::filesystem::path(snapshotDir));
+
+			// the temporary file has a random name (unique per process and call), such that concurrent runs never write to the same file
+			std::string tmpFilename = filename + "." + boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%").string() + ".tmp";
+
+			std::ofstream out(tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out) {
+				LOG(WARNING, "Could not write snapshot " << filename);
+				return;
+			}
+
+			// the term table is collected while the sections are written, but it must precede them in the file;
+			// thus the sections are written to memory first and appended after the header
+			TermTable table(reg);
+			{
+				std::ostringstream sectionOut(std::ios::out | std::ios::binary);
+				{
+					SnapshotWriter writer(sectionOut);
+
+					writeTerms(writer, table, concepts);
+					writeTerms(writer, table, roles);
+					writeTerms(writer, table, individuals);
+
+					writer.writeUInt(AboxPredicates.size());
+					BOOST_FOREACH (ID pred, AboxPredicates) writer.writeUInt(table.get(pred));
+
+					writer.writeUInt(conceptAssertions->getStorage().count());
+					bm::bvector<>::enumerator en = conceptAssertions->getStorage().first();
+					bm::bvector<>::enumerator en_end = conceptAssertions->getStorage().end();
+					while (en < en_end) {
+						const OrdinaryAtom& guard = reg->ogatoms.getByAddress(*en);
+						writer.writeUInt(table.get(guard.tuple[1]));
+						writer.writeUInt(table.get(guard.tuple[2]));
+						en++;
+					}
+
+					writer.writeUInt(roleAssertions.size());
+					BOOST_FOREACH (RoleAssertion ra, roleAssertions) {
+						writer.writeUInt(table.get(ra.first));
+						writer.writeUInt(table.get(ra.second.first));
+						writer.writeUInt(table.get(ra.second.second));
+					}
+
+					if (!!classification) writeFacts(writer, table, reg, classification);
+					if (!!tboxAxioms) writeFacts(writer, table, reg, tboxAxioms);
+				}
+
+				// header
+				SnapshotWriter writer(out);
+				writer.writeBytes(snapshotMagic, 8);
+				writer.writeUInt(snapshotVersion);
+				writer.writeUInt(byteOrderMark);
+				writer.writeString(fileHash);
+				writer.writeUInt(includeAbox ? 1 : 0);
+				writer.writeUInt(!!classification ? 1 : 0);
+				writer.writeUInt(!!tboxAxioms ? 1 : 0);
+				writer.writeUInt(functionalRoles ? 1 : 0);
+				writer.writeString(ontologyPath);
+				writer.writeString(ontologyNamespace);
+				writer.writeString(ontologyVersion);
+				table.write(writer);
+
+				// append the sections
+				std::string sections = sectionOut.str();
+				out.write(sections.data(), sections.size());
+			}
+			out.close();
+			if (!out) {
+				LOG(WARNING, "Could not write snapshot " << filename);
+				boost::filesystem::remove(boost::filesystem::path(tmpFilename));
+				return;
+			}
+
+			// replace the old snapshot atomically, such that concurrent runs never see a partial file
+			boost::filesystem::rename(boost::filesystem::path(tmpFilename), boost::filesystem::path(filename));
+		} catch (const boost::filesystem::filesystem_error& e) {
+			LOG(WARNING, "Could not write snapshot " << filename << ": " << e.what());
+		}
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
@@ -50,6 +50,7 @@
 #include "dlvhex2/InternalGroundDASPSolver.h"
 #include "dlvhex2/UnfoundedSetChecker.h"
 #include "DLLitePlugin.h"
+#include "NativeReasoner.h"
 #include <bm/bmalgo.h>
 #include <map>
 #include <vector>
@@ -57,6 +58,10 @@
 #include <sstream>
 #include <string.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
 
 DLVHEX_NAMESPACE_BEGIN
 
@@ -131,6 +136,12 @@ namespace dllite {
 
 		globalLearnedEANogoods = SimpleNogoodContainerPtr(new SimpleNogoodContainer());
 
+		// masks for extracting repaired ABoxes from model candidates
+		guardMask.setRegistry(reg);
+		guardMask.addPredicate(reg->getAuxiliaryConstantSymbol('o', ID(0, 0)));
+		guardbarMask.setRegistry(reg);
+		guardbarMask.addPredicate(reg->getAuxiliaryConstantSymbol('o', ID(0, 1)));
+
 		//  rules
 		{
 			std::ostringstream s;
@@ -146,6 +157,34 @@ namespace dllite {
 		return ModelGeneratorPtr(new RepairModelGenerator(*this, input));
 	}
 
+	void RepairModelGeneratorFactory::updateGuardOfBar() {
+
+		guardMask.updateMask();
+		guardbarMask.updateMask();
+
+		// only atoms which are new since the last call are mapped (new atoms have higher addresses; the registry is only read),
+		// and those whose twin was missing so far are tried again (it may have been added meanwhile)
+		ID guardPredicateID = reg->getAuxiliaryConstantSymbol('o', ID(0, 0));
+		std::vector<IDAddress> bars;
+		bars.swap(unmappedBars);
+		IDAddress mapped = guardOfBar.size();
+		bm::bvector<>::enumerator en = guardbarMask.mask()->getStorage().first();
+		bm::bvector<>::enumerator en_end = guardbarMask.mask()->getStorage().end();
+		while (en < en_end) {
+			if (*en >= mapped) bars.push_back(*en);
+			en++;
+		}
+
+		BOOST_FOREACH (IDAddress bar, bars) {
+			if (bar >= guardOfBar.size()) guardOfBar.resize(bar + 1, ALL_ONES);
+			OrdinaryAtom guard = reg->ogatoms.getByAddress(bar);
+			guard.tuple[0] = guardPredicateID;
+			ID guardID = reg->ogatoms.getIDByStorage(guard);
+			if (guardID != ID_FAIL) guardOfBar[bar] = guardID.address;
+			else unmappedBars.push_back(bar);
+		}
+	}
+
 	std::ostream& RepairModelGeneratorFactory::print(
 			std::ostream& o) const
 	{
@@ -311,6 +350,21 @@ namespace dllite {
 			nogoodGrounder = NogoodGrounderPtr(new ImmediateNogoodGrounder(factory.ctx.registry(), learnedEANogoods, learnedEANogoods, annotatedGroundProgram));
 		}
 
+		// map the removal atoms of the ground program to their ABox facts once (post checks only extend it for new atoms)
+		factory.updateGuardOfBar();
+
+		// the post check rejects repairs which keep two conflicting assertions, the propagator prunes them early
+		conflictPropagator = false;
+		if (factory.ctx.getPluginData<DLLitePlugin>().el) {
+			if (factory.ctx.getPluginData<DLLitePlugin>().aboxconflicts) DBGLOG(WARNING, "RMG: Abox conflict propagation is only supported for DL-Lite ontologies");
+		} else {
+			computeAboxConflicts();
+			if (!conflictingBars.empty()) {
+				solver->addPropagator(this);
+				conflictPropagator = true;
+			}
+		}
+
 		// start learning support sets
 
 		DBGLOG(DBG, "RMG: start learning support sets (from nogoods)");
@@ -338,7 +392,16 @@ namespace dllite {
 	}
 
 	RepairModelGenerator::~RepairModelGenerator() {
-		//solver->removePropagator(this)
+		// the producer thread may still be inside the solver (and call propagate), thus stop it first
+		if (!!pipeline) {
+			{
+				boost::mutex::scoped_lock lock(pipeline->mutex);
+				pipeline->stop = true;
+			}
+			pipeline->changed.notify_all();
+			pipeline->threads.join_all();
+		}
+		if (conflictPropagator) solver->removePropagator(this);
 		DBGLOG(DBG, "Final Statistics:" << std::endl << solver->getStatistics());
 	}
 
@@ -351,6 +414,8 @@ namespace dllite {
 		factory.gpMask.updateMask();
 		factory.gnMask.updateMask();
 
+		if (factory.ctx.getPluginData<DLLitePlugin>().checkthreads > 1) return generateNextModelPipelined();
+
 		InterpretationPtr modelCandidate;
 		do
 		{
@@ -374,43 +439,330 @@ namespace dllite {
 			if (postCheck(modelCandidate)) {
 
 				DBGLOG(DBG,"RMG: model candidate, "<<*modelCandidate<<", is a compatible for the repaired ABox, and it passed the flp check.");
+				return filterModel(modelCandidate);
+			}
 
-				modelCandidate->getStorage() -= factory.gpMask.mask()->getStorage();
-				modelCandidate->getStorage() -= factory.gnMask.mask()->getStorage();
-				modelCandidate->getStorage() -= mask->getStorage();
+		}while(true);
+	}
 
-				InterpretationPtr I(new Interpretation(reg));
+	InterpretationPtr RepairModelGenerator::filterModel(InterpretationPtr modelCandidate) {
 
-				// filter out irrelevant atoms from the model
+		modelCandidate->getStorage() -= factory.gpMask.mask()->getStorage();
+		modelCandidate->getStorage() -= factory.gnMask.mask()->getStorage();
+		modelCandidate->getStorage() -= mask->getStorage();
 
-				bm::bvector<>::enumerator en = modelCandidate->getStorage().first();
-				bm::bvector<>::enumerator en_end = modelCandidate->getStorage().end();
+		InterpretationPtr I(new Interpretation(reg));
 
-				while (en < en_end) {
-					const OrdinaryAtom& oatom = reg->ogatoms.getByAddress(*en);
-					ID oatomID = reg->ogatoms.getIDByAddress(*en);
-					ID predID = oatom.tuple[0];
-					//DBGLOG(DBG,"RMG: current predicate is "<<RawPrinter::toString(reg,predID)<< " for atom "<<RawPrinter::toString(reg,oatomID));
+		// filter out irrelevant atoms from the model
 
-					if (std::find(auxiliarypredicates.begin(), auxiliarypredicates.end(),predID)!=auxiliarypredicates.end()) {
-						DBGLOG(DBG,"RMG: "<<RawPrinter::toString(reg,predID)<<" is auxiliary, should not be present in the final model ");
-						I->setFact(oatomID.address);
-					}
+		bm::bvector<>::enumerator en = modelCandidate->getStorage().first();
+		bm::bvector<>::enumerator en_end = modelCandidate->getStorage().end();
+
+		while (en < en_end) {
+			const OrdinaryAtom& oatom = reg->ogatoms.getByAddress(*en);
+			ID oatomID = reg->ogatoms.getIDByAddress(*en);
+			ID predID = oatom.tuple[0];
+			//DBGLOG(DBG,"RMG: current predicate is "<<RawPrinter::toString(reg,predID)<< " for atom "<<RawPrinter::toString(reg,oatomID));
+
+			if (std::find(auxiliarypredicates.begin(), auxiliarypredicates.end(),predID)!=auxiliarypredicates.end()) {
+				DBGLOG(DBG,"RMG: "<<RawPrinter::toString(reg,predID)<<" is auxiliary, should not be present in the final model ");
+				I->setFact(oatomID.address);
+			}
+
+			en++;
+		}
+
+		//DBGLOG(DBG,"RMG: filtermodel is "<<*I);
+		modelCandidate->getStorage() -= I->getStorage();
+		return modelCandidate;
+	}
+
+	InterpretationPtr RepairModelGenerator::generateNextModelPipelined() {
+
+		const DLLitePlugin::CtxData& ctxdata = factory.ctx.getPluginData<DLLitePlugin>();
+
+		// the solver thread and the workers are started on the first call
+		if (!pipeline) {
+			DBGLOG(DBG, "RMG: starting pipelined post checks with " << ctxdata.checkthreads << " workers");
+			pipeline.reset(new Pipeline());
+			pipeline->enumerated = 0;
+			pipeline->returned = 0;
+			pipeline->next = 0;
+			pipeline->capacity = 2 * ctxdata.checkthreads;
+			pipeline->exhausted = false;
+			pipeline->stop = false;
+			pipeline->threads.create_thread(boost::bind(&RepairModelGenerator::runCandidateProducer, this));
+			for (unsigned i = 0; i < ctxdata.checkthreads; ++i) pipeline->threads.create_thread(boost::bind(&RepairModelGenerator::runPostCheckWorker, this));
+		}
+
+		while (true) {
+			InterpretationPtr model;
+			{
+				boost::mutex::scoped_lock lock(pipeline->mutex);
+				while (pipeline->error == "" && !(pipeline->exhausted && pipeline->returned == pipeline->enumerated)) {
+					if (ctxdata.checkunordered ? !pipeline->results.empty() : pipeline->results.count(pipeline->next) > 0) break;
+					pipeline->changed.wait(lock);
+				}
+				if (pipeline->error != "") throw PluginError("Post check failed: " + pipeline->error);
+				if (pipeline->exhausted && pipeline->returned == pipeline->enumerated) {
+					LOG(DBG,"RMG: unsatisfiable -> returning no model");
+					return InterpretationPtr();
+				}
+
+				// in ordered mode the result with the next number is taken, otherwise the one which was enumerated first
+				std::map<unsigned, InterpretationPtr>::iterator it = (ctxdata.checkunordered ? pipeline->results.begin() : pipeline->results.find(pipeline->next));
+				model = it->second;
+				pipeline->results.erase(it);
+				pipeline->next++;
+				pipeline->returned++;
+			}
+			// the solver thread may enumerate further candidates
+			pipeline->changed.notify_all();
+
+			if (!!model) return filterModel(model);
+		}
+	}
+
+	void RepairModelGenerator::runCandidateProducer() {
+
+		std::vector<Nogood> learned;
+		try {
+			while (true) {
+				{
+					boost::mutex::scoped_lock lock(pipeline->mutex);
+					while (!pipeline->stop && pipeline->enumerated - pipeline->returned >= pipeline->capacity) pipeline->changed.wait(lock);
+					if (pipeline->stop) return;
+
+					// the solver is only accessed by this thread, thus nogoods of the workers are added here
+					BOOST_FOREACH (const Nogood& ng, pipeline->nogoods) solver->addNogood(ng);
+					pipeline->nogoods.clear();
+					learned.swap(pipeline->learnedNogoods);
+				}
+				if (!learned.empty()) {
+					// nogoods of failed post checks are generalized and transferred like those of the synchronous mode
+					boost::mutex::scoped_lock lock(postCheckMutex);
+					BOOST_FOREACH (const Nogood& ng, learned) learnedEANogoods->addNogood(ng);
+					learned.clear();
+					updateEANogoods();
+				}
 
-					en++;
+				LOG(DBG,"RMG: asking for next model candidate");
+				InterpretationPtr modelCandidate = solver->getNextModel();
+				{
+					boost::mutex::scoped_lock lock(pipeline->mutex);
+					if (!modelCandidate) {
+						pipeline->exhausted = true;
+					} else {
+						DBGLOG(DBG,"RMG: model candidate " << pipeline->enumerated << " is "<<*modelCandidate);
+						DLVHEX_BENCHMARK_REGISTER_AND_COUNT(ssidmodelcandidates, "Candidate compatible sets", 1);
+						pipeline->candidates.push_back(std::pair<unsigned, InterpretationPtr>(pipeline->enumerated++, modelCandidate));
+					}
 				}
+				pipeline->changed.notify_all();
+				if (!modelCandidate) return;
+			}
+		} catch (const std::exception& e) {
+			boost::mutex::scoped_lock lock(pipeline->mutex);
+			if (pipeline->error == "") pipeline->error = e.what();
+		} catch (...) {
+			boost::mutex::scoped_lock lock(pipeline->mutex);
+			if (pipeline->error == "") pipeline->error = "unknown error";
+		}
+		pipeline->changed.notify_all();
+	}
 
-				//DBGLOG(DBG,"RMG: filtermodel is "<<*I);
-				modelCandidate->getStorage() -= I->getStorage();
-				return modelCandidate;
+	void RepairModelGenerator::runPostCheckWorker() {
 
+		while (true) {
+			std::pair<unsigned, InterpretationPtr> candidate;
+			{
+				boost::mutex::scoped_lock lock(pipeline->mutex);
+				while (!pipeline->stop && pipeline->error == "" && pipeline->candidates.empty() && !pipeline->exhausted) pipeline->changed.wait(lock);
+				if (pipeline->stop || pipeline->error != "" || pipeline->candidates.empty()) return;
+				candidate = pipeline->candidates.front();
+				pipeline->candidates.pop_front();
 			}
 
-		}while(true);
+			// the candidate is checked outside of the lock (post checks of different candidates are independent)
+			bool repair;
+			try {
+				repair = postCheck(candidate.second);
+			} catch (const std::exception& e) {
+				boost::mutex::scoped_lock lock(pipeline->mutex);
+				if (pipeline->error == "") pipeline->error = e.what();
+				pipeline->changed.notify_all();
+				return;
+			} catch (...) {
+				boost::mutex::scoped_lock lock(pipeline->mutex);
+				if (pipeline->error == "") pipeline->error = "unknown error";
+				pipeline->changed.notify_all();
+				return;
+			}
+
+			{
+				boost::mutex::scoped_lock lock(pipeline->mutex);
+				DBGLOG(DBG, "RMG: model candidate " << candidate.first << (repair ? " passed" : " failed") << " the post check");
+				pipeline->results[candidate.first] = (repair ? candidate.second : InterpretationPtr());
+			}
+			pipeline->changed.notify_all();
+		}
 	}
 
 	void RepairModelGenerator::generalizeNogood(Nogood ng) {
 
+		if (!ng.isGround()) return;
+		DBGLOG(DBG, "RMG: generalizing " << ng.getStringRepresentation(reg));
+
+		// find the external atom related to this nogood
+		ID eaAux = ID_FAIL;
+		BOOST_FOREACH (ID l, ng) {
+			if (reg->ogatoms.getIDByAddress(l.address).isExternalAuxiliary() && annotatedGroundProgram.mapsAux(l.address)) {
+				eaAux = l;
+				break;
+			}
+		}
+		if (eaAux == ID_FAIL) return;
+
+		// the plugin atom abstracts the nogood from its individuals (see DLPluginAtom::generalizeNogood), such that
+		// the nonground nogood is instantiated by nogoodGrounder for the other individuals
+		BOOST_FOREACH (ID eaID, annotatedGroundProgram.getAuxToEA(eaAux.address)) {
+			const ExternalAtom& eatom = reg->eatoms.getByID(eaID);
+			int oldCount = learnedEANogoods->getNogoodCount();
+			eatom.pluginAtom->generalizeNogood(ng, &factory.ctx, learnedEANogoods);
+			DBGLOG(DBG, "RMG: generalization of " << RawPrinter::toString(reg, eaID) << " learned " << (learnedEANogoods->getNogoodCount() - oldCount) << " nonground nogoods");
+		}
+	}
+
+	Nogood RepairModelGenerator::getEvaluationNogood(InterpretationConstPtr modelCandidate, const ExternalAtom& eatom, ID replacement) {
+
+		// the evaluation depends only on the repaired Abox (the removal atoms) and on the input of the external atom;
+		// if the external atom is monotonic, a failed positive replacement fails as well if further assertions are removed
+		// or less input is true, and a failed negative one if less assertions are removed or further input is true,
+		// thus only the removed assertions and false input atoms resp. the kept assertions and true input atoms are needed
+		Nogood ng;
+		ng.insert(NogoodContainer::createLiteral(replacement.address, modelCandidate->getFact(replacement.address)));
+		bm::bvector<> bars, guards;
+		{
+			boost::mutex::scoped_lock lock(postCheckMutex);
+			bars = factory.guardbarMask.mask()->getStorage();
+			guards = factory.guardMask.mask()->getStorage();
+		}
+		eatom.updatePredicateInputMask();
+		bm::bvector<> relevant = bars | eatom.getPredicateInputMask()->getStorage();
+		relevant &= annotatedGroundProgram.getProgramMask()->getStorage();
+
+		// moreover, in EL (without nominals and inconsistencies, cf. ELRewriter) the answer for the output individuals
+		// depends only on the assertions of their connected component in the Abox; the component is taken over all assertions
+		// which may hold (Abox facts and input atoms of any value), such that it covers the component of every repair
+		boost::unordered_map<IDAddress, std::vector<IDAddress> > neighbours;
+		bm::bvector<> assertions = (guards & modelCandidate->getStorage()) | relevant;
+		bm::bvector<>::enumerator en = assertions.first();
+		bm::bvector<>::enumerator en_end = assertions.end();
+		while (en < en_end) {
+			const OrdinaryAtom& atom = reg->ogatoms.getByAddress(*en);
+			if (atom.tuple.size() == 4 && atom.tuple[2].isConstantTerm() && atom.tuple[3].isConstantTerm()) {
+				neighbours[atom.tuple[2].address].push_back(atom.tuple[3].address);
+				neighbours[atom.tuple[3].address].push_back(atom.tuple[2].address);
+			}
+			en++;
+		}
+		const OrdinaryAtom& repl = reg->ogatoms.getByAddress(replacement.address);
+		std::vector<IDAddress> todo;
+		for (std::size_t i = repl.tuple.size() - eatom.tuple.size(); i < repl.tuple.size(); ++i) {
+			if (repl.tuple[i].isConstantTerm()) todo.push_back(repl.tuple[i].address);
+		}
+		bm::bvector<> component;
+		while (!todo.empty()) {
+			IDAddress individual = todo.back();
+			todo.pop_back();
+			if (component.get_bit(individual)) continue;
+			component.set_bit(individual);
+			boost::unordered_map<IDAddress, std::vector<IDAddress> >::const_iterator it = neighbours.find(individual);
+			if (it != neighbours.end()) todo.insert(todo.end(), it->second.begin(), it->second.end());
+		}
+
+		bool monotonic = eatom.getExtSourceProperties().isMonotonic();
+		bool positive = reg->isPositiveExternalAtomAuxiliaryAtom(replacement);
+		en = relevant.first();
+		en_end = relevant.end();
+		while (en < en_end) {
+			// atoms without individuals (e.g. the flags of the input) are always kept
+			const OrdinaryAtom& atom = reg->ogatoms.getByAddress(*en);
+			bool individuals = false;
+			bool connected = false;
+			for (std::size_t i = 2; i < atom.tuple.size(); ++i) {
+				if (!atom.tuple[i].isConstantTerm()) continue;
+				individuals = true;
+				connected = connected || component.get_bit(atom.tuple[i].address);
+			}
+
+			bool value = modelCandidate->getFact(*en);
+			bool weakening = (bars.get_bit(*en) ? value : !value);	// removes an assertion resp. leaves an input atom false
+			if ((!monotonic || weakening == positive) && (connected || !individuals)) ng.insert(NogoodContainer::createLiteral(*en, value));
+			en++;
+		}
+		return ng;
+	}
+
+	void RepairModelGenerator::learnPostCheckNogood(const Nogood& ng) {
+
+		DBGLOG(DBG, "RMG: learned from failed post check: " << ng.getStringRepresentation(reg));
+		DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidpostchecknogoods, "RMG: post check nogoods", 1);
+		if (!!pipeline) {
+			// the solver thread transfers the nogood
+			boost::mutex::scoped_lock lock(pipeline->mutex);
+			pipeline->learnedNogoods.push_back(ng);
+		} else {
+			learnedEANogoods->addNogood(ng);
+			updateEANogoods();
+		}
+	}
+
+	void RepairModelGenerator::learnSupportFamilies(std::vector<SimpleNogoodContainerPtr>& supportSetsOfExternalAtom) {
+
+		SupportFamilyJobs jobs;
+		jobs.next = 0;
+		jobs.supportSetsOfExternalAtom = &supportSetsOfExternalAtom;
+
+		supportSetsOfExternalAtom.clear();
+		for(unsigned eaIndex = 0; eaIndex < factory.innerEatoms.size(); ++eaIndex) {
+			supportSetsOfExternalAtom.push_back(SimpleNogoodContainerPtr(new SimpleNogoodContainer()));
+			if (reg->eatoms.getByID(factory.innerEatoms[eaIndex]).getExtSourceProperties().providesSupportSets()) jobs.eaIndices.push_back(eaIndex);
+		}
+
+		unsigned threads = std::min<unsigned>(factory.ctx.getPluginData<DLLitePlugin>().supthreads, jobs.eaIndices.size());
+		DBGLOG(DBG, "RMG: learning " << jobs.eaIndices.size() << " support families using " << threads << " threads");
+		if (threads <= 1) {
+			runSupportFamilyJobs(&jobs);
+		} else {
+			boost::thread_group workers;
+			for (unsigned i = 0; i < threads; ++i) workers.create_thread(boost::bind(&RepairModelGenerator::runSupportFamilyJobs, this, &jobs));
+			workers.join_all();
+		}
+		if (jobs.error != "") throw PluginError("Support set learning failed: " + jobs.error);
+	}
+
+	void RepairModelGenerator::runSupportFamilyJobs(SupportFamilyJobs* jobs) {
+
+		while (true) {
+			unsigned eaIndex;
+			{
+				boost::mutex::scoped_lock lock(jobs->mutex);
+				if (jobs->next >= jobs->eaIndices.size() || jobs->error != "") return;
+				eaIndex = jobs->eaIndices[jobs->next++];
+			}
+
+			DBGLOG(DBG, "RMG: evaluating external atom " << factory.innerEatoms[eaIndex] << " for support set learning");
+			try {
+				learnSupportSetsForExternalAtom(factory.ctx, factory.innerEatoms[eaIndex], (*jobs->supportSetsOfExternalAtom)[eaIndex]);
+			} catch (const std::exception& e) {
+				boost::mutex::scoped_lock lock(jobs->mutex);
+				if (jobs->error == "") jobs->error = e.what();
+			} catch (...) {
+				boost::mutex::scoped_lock lock(jobs->mutex);
+				if (jobs->error == "") jobs->error = "unknown error";
+			}
+		}
 	}
 
 	void RepairModelGenerator::learnSupportSets() {
@@ -1338,6 +1690,9 @@ namespace dllite {
 
 			// ONTOLOGY IS IN EL
 
+			// learn the support families of all external atoms first (possibly in parallel), they are processed in order below
+			learnSupportFamilies(supportSetsOfExternalAtom);
+
 			if (factory.ctx.getPluginData<DLLitePlugin>().el) {
 
 				DBGLOG(DBG,"RMG: EL:  --el option is enabled");
@@ -1371,15 +1726,7 @@ namespace dllite {
 
 					ID qid = eatom.inputs[5];
 
-					supportSetsOfExternalAtom.push_back(SimpleNogoodContainerPtr(new SimpleNogoodContainer()));
-
-					// if the external atom provides support sets then proceed with their learning
-					if (eatom.getExtSourceProperties().providesSupportSets()) {
-						DBGLOG(DBG, "RMG: EL:  evaluating external atom " << RawPrinter::toString(reg,factory.innerEatoms[eaIndex]) << " for support set learning");
-
-						learnSupportSetsForExternalAtom(factory.ctx, factory.innerEatoms[eaIndex], supportSetsOfExternalAtom[eaIndex]);
-						DBGLOG(DBG, "RMG: EL:  number of learned support sets: "<<supportSetsOfExternalAtom[eaIndex]->getNogoodCount());
-					}
+					DBGLOG(DBG, "RMG: EL:  number of learned support sets: "<<supportSetsOfExternalAtom[eaIndex]->getNogoodCount());
 
 					//DBGLOG(DBG,"RMG: EL:  the set of atoms with support families not known to be complete is as follows:" );
 					std::vector<ID>::iterator it = factory.ctx.getPluginData<DLLitePlugin>().incompletedlat.begin();
@@ -1415,8 +1762,8 @@ namespace dllite {
 					ID cQID = ID_FAIL;
 					ID rQID = ID_FAIL;
 
-					ID cdlID = reg->storeConstantTerm("cDL");
-					ID rdlID = reg->storeConstantTerm("rDL");
+					ID cdlID = storePostCheckTerm("cDL");
+					ID rdlID = storePostCheckTerm("rDL");
 
 					if (eatom.predicate==cdlID) {
 						// query is a concept
@@ -1951,8 +2298,8 @@ namespace dllite {
 					ID cQID = ID_FAIL;
 					ID rQID = ID_FAIL;
 
-					ID cdlID = reg->storeConstantTerm("cDL");
-					ID rdlID = reg->storeConstantTerm("rDL");
+					ID cdlID = storePostCheckTerm("cDL");
+					ID rdlID = storePostCheckTerm("rDL");
 
 					if (eatom.predicate==cdlID) {
 						// query is a concept
@@ -2014,12 +2361,7 @@ namespace dllite {
 					// evaluate the external atom if it provides support sets
 					const ExternalAtom& eatom = reg->eatoms.getByID(factory.innerEatoms[eaIndex]);
 
-					supportSetsOfExternalAtom.push_back(SimpleNogoodContainerPtr(new SimpleNogoodContainer()));
-					if (eatom.getExtSourceProperties().providesSupportSets()) {
-
-						learnSupportSetsForExternalAtom(factory.ctx, factory.innerEatoms[eaIndex], supportSetsOfExternalAtom[eaIndex]);
-						DBGLOG(DBG, "RMG: number of learned support sets: "<<supportSetsOfExternalAtom[eaIndex]->getNogoodCount());
-					}
+					DBGLOG(DBG, "RMG: number of learned support sets: "<<supportSetsOfExternalAtom[eaIndex]->getNogoodCount());
 
 					// prepare for rewriting
 					// cQID is the predicate for concept query
@@ -2028,8 +2370,8 @@ namespace dllite {
 					ID cQID = ID_FAIL;
 					ID rQID = ID_FAIL;
 
-					ID cdlID = reg->storeConstantTerm("cDL");
-					ID rdlID = reg->storeConstantTerm("rDL");
+					ID cdlID = storePostCheckTerm("cDL");
+					ID rdlID = storePostCheckTerm("rDL");
 
 					if (eatom.predicate==cdlID) {
 						cQID = eatom.inputs[5];
@@ -2797,6 +3139,26 @@ namespace dllite {
 		learnedEANogoodsTransferredIndex = learnedEANogoods->getNogoodCount();
 	}
 
+	std::size_t RepairModelGenerator::getPostCheckKeyHash(const PostCheckKey& key) {
+
+		std::size_t hash = key.eaIndex;
+		bm::bvector<>::enumerator en = key.removal.first();
+		bm::bvector<>::enumerator en_end = key.removal.end();
+		while (en < en_end) {
+			boost::hash_combine(hash, *en);
+			en++;
+		}
+		// separates the two sets
+		boost::hash_combine(hash, ALL_ONES);
+		en = key.input.first();
+		en_end = key.input.end();
+		while (en < en_end) {
+			boost::hash_combine(hash, *en);
+			en++;
+		}
+		return hash;
+	}
+
 	// evaluation postcheck and FLP check
 
 	bool RepairModelGenerator::postCheck(InterpretationConstPtr modelCandidate) {
@@ -2805,64 +3167,40 @@ namespace dllite {
 		DBGLOG(DBG,"RMG: PC: post check of the repair model candidate is started:");
 		DBGLOG(DBG,"RMG: PC: current model candidate is: "<< *modelCandidate);
 
-		// extract repair ABox candidate from the model
-		// vector for storing IDs of original ABox assertions
-		std::vector<ID> ab;
-
-		//vector for storing assertions that have to be removed (extracted from bar guards)
-		std::vector<ID> removal;
-
-		//vector for storing new ABox
-		std::vector<ID> newab;
-
+		// extract repair ABox candidate from the model:
+		// the original ABox assertions (aux_o) are the ones of the candidate without those that are marked for removal (bar_aux_o)
 		ID guardPredicateID = reg->getAuxiliaryConstantSymbol('o', ID(0, 0));
-		ID guardbarPredicateID = reg->getAuxiliaryConstantSymbol('o', ID(0, 1));
-
-		bm::bvector<>::enumerator nea = modelCandidate->getStorage().first();
-		bm::bvector<>::enumerator nea_end = modelCandidate->getStorage().end();
-
-		// collect facts that are to be removed into the removal vector and those that were in the original ABox into the ab vector
-
-		DBGLOG(DBG,"#RMG: PC: assertions removed from original ABox to get a repair:");
-		while (nea < nea_end) {
-			ID id = reg->ogatoms.getIDByAddress(*nea);
-			if (reg->ogatoms.getByID(id).tuple[0]==guardbarPredicateID) {
-				removal.push_back(id);
-				DBGLOG(DBG,"#RMG: PC: "<<RawPrinter::toString(reg,id));
-			}
-
-			else if (reg->ogatoms.getByID(id).tuple[0]==guardPredicateID) {
-				ab.push_back(id);
+		InterpretationPtr ab(new Interpretation(reg));
+		InterpretationPtr removal(new Interpretation(reg));
+		{
+			// the masks and guardOfBar are shared by concurrent post checks in pipelined mode
+			boost::mutex::scoped_lock lock(postCheckMutex);
+			factory.updateGuardOfBar();
+			ab->getStorage() = modelCandidate->getStorage() & factory.guardMask.mask()->getStorage();
+			bm::bvector<> bars = modelCandidate->getStorage() & factory.guardbarMask.mask()->getStorage();
+
+			DBGLOG(DBG,"#RMG: PC: assertions removed from original ABox to get a repair:");
+			bm::bvector<>::enumerator en = bars.first();
+			bm::bvector<>::enumerator en_end = bars.end();
+			while (en < en_end) {
+				DBGLOG(DBG,"#RMG: PC: "<<RawPrinter::toString(reg,reg->ogatoms.getIDByAddress(*en)));
+				if (factory.guardOfBar[*en] != ALL_ONES) removal->setFact(factory.guardOfBar[*en]);
+				en++;
 			}
-			nea++;
 		}
 
-		// go through facts in ab and remove all those that are also in the removal vector
-
-		std::vector<ID>::iterator it = ab.begin();
-		std::vector<ID>::iterator it_end = ab.end();
-
-		while (it<it_end) {
-			ID idab = ID(*it);
-			OrdinaryAtom aboxfact = reg->ogatoms.getByID(idab);
-			OrdinaryAtom a(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG | ID::PROPERTY_AUX);
-			a.tuple.push_back(guardbarPredicateID);
-
-			for (int i=1; i<aboxfact.tuple.size();i++) {
-				a.tuple.push_back(reg->ogatoms.getByID(idab).tuple[i]);
-			}
-
-			ID delID = reg->storeOrdinaryGAtom(a);
-
-			if ((std::find(removal.begin(), removal.end(), delID) != removal.end())) {
-			}
-			else {
-				newab.push_back(idab);
-			}
-			it++;
-		}
+		InterpretationPtr newabox(new Interpretation(reg));
+		newabox->getStorage() = ab->getStorage() - removal->getStorage();
 
 		// final abox is now stored in the vector newab
+		std::vector<ID> newab;
+		newab.reserve(newabox->getStorage().count());
+		bm::bvector<>::enumerator nea = newabox->getStorage().first();
+		bm::bvector<>::enumerator nea_end = newabox->getStorage().end();
+		while (nea < nea_end) {
+			newab.push_back(reg->ogatoms.getIDByAddress(*nea));
+			nea++;
+		}
 
 		std::vector<ID>::iterator newa = newab.begin();
 		std::vector<ID>::iterator newa_end = newab.end();
@@ -2880,9 +3218,26 @@ namespace dllite {
 				newa++;
 			}
 		}
-		DBGLOG(DBG, "RMG: PC: the number of assertions in the original ABox is "<<ab.size());
+		DBGLOG(DBG, "RMG: PC: the number of assertions in the original ABox is "<<ab->getStorage().count());
 		DBGLOG(DBG, "RMG: PC: the number of assertions in the repaired ABox is "<<newab.size());
-		DBGLOG(DBG, "RMG: PC: the number of removed assertions is "<<ab.size()-newab.size());
+		DBGLOG(DBG, "RMG: PC: the number of removed assertions is "<<ab->getStorage().count()-newab.size());
+
+		// in DL-Lite, the repaired Abox is consistent iff it keeps no conflicting pair of assertions
+		if (!factory.ctx.getPluginData<DLLitePlugin>().el) {
+			BOOST_FOREACH (const GuardPair& c, aboxConflicts) {
+				if (!newabox->getFact(c.first) || !newabox->getFact(c.second)) continue;
+				DBGLOG(DBG, "RMG: PC: repaired Abox keeps the conflicting assertions " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(c.first)) << " and " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(c.second)));
+
+				// at least one of them must be removed
+				Nogood ng;
+				boost::unordered_map<IDAddress, IDAddress>::const_iterator bar1 = barOfGuard.find(c.first);
+				boost::unordered_map<IDAddress, IDAddress>::const_iterator bar2 = barOfGuard.find(c.second);
+				if (bar1 != barOfGuard.end()) ng.insert(NogoodContainer::createLiteral(bar1->second, false));
+				if (bar2 != barOfGuard.end()) ng.insert(NogoodContainer::createLiteral(bar2->second, false));
+				if (ng.size() > 0) learnPostCheckNogood(ng);
+				return false;
+			}
+		}
 
 		// the case when ontology is in EL
 
@@ -2967,8 +3322,8 @@ namespace dllite {
 						ID cQID = ID_FAIL;
 						ID rQID = ID_FAIL;
 
-						ID cdlID = reg->storeConstantTerm("cDL");
-						ID rdlID = reg->storeConstantTerm("rDL");
+						ID cdlID = storePostCheckTerm("cDL");
+						ID rdlID = storePostCheckTerm("rDL");
 
 						if (eatom.predicate==cdlID) {
 							// query is a concept
@@ -2992,94 +3347,123 @@ namespace dllite {
 							if (cQID!=ID_FAIL) {
 								DBGLOG(DBG,"RMG: PC: evaluate "<< RawPrinter::toString(reg,eatID)<<" for a constant "<<RawPrinter::toString(reg,reg->ogatoms.getByID(id).tuple[7]));
 
-								// create a copy of interpretation for input
-								Interpretation::Ptr postcheckInput;
-								postcheckInput.reset(new Interpretation(*modelCandidate));
+								// candidates with the same repaired ABox and the same input of the external atom share the evaluation
+								PostCheckKey key;
+								key.eaIndex = eaIndex;
+								key.removal = removal->getStorage();
+								eatom.updatePredicateInputMask();
+								key.input = modelCandidate->getStorage() & eatom.getPredicateInputMask()->getStorage();
+								key.hash = getPostCheckKeyHash(key);
+
+								InterpretationPtr postcheckOutput;
+								postcheckOutput.reset(new Interpretation(reg));
+
+								bool hit = false;
+								{
+									boost::mutex::scoped_lock lock(postCheckMutex);
+									PostCheckCache::const_iterator cached = postCheckCache.find(key);
+									if (cached != postCheckCache.end()) {
+										postcheckOutput->getStorage() = cached->second->getStorage();
+										hit = true;
+									}
+								}
+								if (hit) {
+									DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidpostcheckhits, "RMG: post check cache hits", 1);
+									DBGLOG(DBG,"RMG: PC: reusing the evaluation of a previous candidate with the same repaired ABox");
+								} else {
+									DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidpostcheckmisses, "RMG: post check cache misses", 1);
+									// create a copy of interpretation for input
+									Interpretation::Ptr postcheckInput;
+									postcheckInput.reset(new Interpretation(*modelCandidate));
 
-								//create a copy of interpretation for output
+									//create a copy of interpretation for output
 
-								ID outputID=reg->ogatoms.getByID(id).tuple[7];
-								OrdinaryAtom relev(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-								relev.tuple.push_back(eatom.inputs[1]);
-								relev.tuple.push_back(newauxIDun);
-								relev.tuple.push_back(reg->ogatoms.getByID(id).tuple[7]);
-								ID relevID = reg->storeOrdinaryGAtom(relev);
+									ID outputID=reg->ogatoms.getByID(id).tuple[7];
+									OrdinaryAtom relev(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+									relev.tuple.push_back(eatom.inputs[1]);
+									relev.tuple.push_back(newauxIDun);
+									relev.tuple.push_back(reg->ogatoms.getByID(id).tuple[7]);
+									ID relevID = storePostCheckAtom(relev);
 
-								DBGLOG(DBG,"RMG: PC: atom for specifying the relevant constants is "<<RawPrinter::toString(reg,relevID));
+									DBGLOG(DBG,"RMG: PC: atom for specifying the relevant constants is "<<RawPrinter::toString(reg,relevID));
 
-								// specify that the new ABox needs to be used and add this ABox as facts w.r.t input atoms
-								OrdinaryAtom usenewab(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
-								usenewab.tuple.push_back(eatom.inputs[1]);
-								ID usenewabID = reg->storeOrdinaryAtom(usenewab);
+									// specify that the new ABox needs to be used and add this ABox as facts w.r.t input atoms
+									OrdinaryAtom usenewab(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+									usenewab.tuple.push_back(eatom.inputs[1]);
+									ID usenewabID = storePostCheckAtom(usenewab);
 
-								DBGLOG(DBG,"RMG: PC: atom that specifies that the new ABox is used: "<<RawPrinter::toString(reg,usenewabID));
-								postcheckInput->setFact(usenewabID.address);
+									DBGLOG(DBG,"RMG: PC: atom that specifies that the new ABox is used: "<<RawPrinter::toString(reg,usenewabID));
+									postcheckInput->setFact(usenewabID.address);
 
-								// add abox assertions to the input predicates
-								DBGLOG(DBG,"RMG: go through the new ABox");
+									// add abox assertions to the input predicates
+									DBGLOG(DBG,"RMG: go through the new ABox");
 
-								newa = newab.begin();
-								newa_end = newab.end();
+									newa = newab.begin();
+									newa_end = newab.end();
 
-								while (newa<newa_end) {
-									ID idadd = ID(*newa);
+									while (newa<newa_end) {
+										ID idadd = ID(*newa);
 
-									DBGLOG(DBG,"RMG: current ABox fact: "<<RawPrinter::toString(reg,idadd));
+										DBGLOG(DBG,"RMG: current ABox fact: "<<RawPrinter::toString(reg,idadd));
 
-									OrdinaryAtom addat=reg->ogatoms.getByID(idadd);
+										OrdinaryAtom addat=reg->ogatoms.getByID(idadd);
 
-									int size = addat.tuple.size();
-									DBGLOG(DBG,"RMG: size of the atom is "<<size);
+										int size = addat.tuple.size();
+										DBGLOG(DBG,"RMG: size of the atom is "<<size);
 
-									OrdinaryAtom abfact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+										OrdinaryAtom abfact(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
 
-									if (size==3) {
-										//create a concept
-										DBGLOG(DBG,"RMG: tuple size is 3, concept assertion");
-										abfact.tuple.push_back(eatom.inputs[1]);
-										abfact.tuple.push_back(addat.tuple[1]);
-										abfact.tuple.push_back(addat.tuple[2]);
+										if (size==3) {
+											//create a concept
+											DBGLOG(DBG,"RMG: tuple size is 3, concept assertion");
+											abfact.tuple.push_back(eatom.inputs[1]);
+											abfact.tuple.push_back(addat.tuple[1]);
+											abfact.tuple.push_back(addat.tuple[2]);
 
-										ID abfactID = reg->storeOrdinaryAtom(abfact);
-										DBGLOG(DBG,"RMG: created atom is: "<<RawPrinter::toString(reg,abfactID));
+											ID abfactID = storePostCheckAtom(abfact);
+											DBGLOG(DBG,"RMG: created atom is: "<<RawPrinter::toString(reg,abfactID));
 
-										postcheckInput->setFact(abfactID.address);
+											postcheckInput->setFact(abfactID.address);
 
+										}
+										else if (size==4) {
+											//create a role
+											DBGLOG(DBG,"RMG: tuple size is 4, role assertion");
+
+											abfact.tuple.push_back(eatom.inputs[3]);
+											abfact.tuple.push_back(addat.tuple[1]);
+											abfact.tuple.push_back(addat.tuple[2]);
+											abfact.tuple.push_back(addat.tuple[3]);
+
+											ID abfactID = storePostCheckAtom(abfact);
+											DBGLOG(DBG,"RMG: created atom is: "<<RawPrinter::toString(reg,abfactID));
+											postcheckInput->setFact(abfactID.address);
+											DBGLOG(DBG,"RMG: added fact to interpretation");
+										}
+										else assert(false&&"ABox assertion is neither unary nor binary");
+
+										newa++;
 									}
-									else if (size==4) {
-										//create a role
-										DBGLOG(DBG,"RMG: tuple size is 4, role assertion");
-
-										abfact.tuple.push_back(eatom.inputs[3]);
-										abfact.tuple.push_back(addat.tuple[1]);
-										abfact.tuple.push_back(addat.tuple[2]);
-										abfact.tuple.push_back(addat.tuple[3]);
-
-										ID abfactID = reg->storeOrdinaryAtom(abfact);
-										DBGLOG(DBG,"RMG: created atom is: "<<RawPrinter::toString(reg,abfactID));
-										postcheckInput->setFact(abfactID.address);
-										DBGLOG(DBG,"RMG: added fact to interpretation");
-									}
-									else assert(false&&"ABox assertion is neither unary nor binary");
 
-									newa++;
-								}
+									DBGLOG(DBG,"RMG: PC: interpretation for input is created "<<*postcheckInput);
 
-								DBGLOG(DBG,"RMG: PC: interpretation for input is created "<<*postcheckInput);
+									// evaluate current atom under the extended interpretation and analyze
+									// the output values w.r.t. the current model candidate
 
-								// evaluate current atom under the extended interpretation and analyze
-								// the output values w.r.t. the current model candidate
+									IntegrateExternalAnswerIntoInterpretationCB cb(postcheckOutput);
 
-								InterpretationPtr postcheckOutput;
-								postcheckOutput.reset(new Interpretation(reg));
-								IntegrateExternalAnswerIntoInterpretationCB cb(postcheckOutput);
+									// prepare a vector for storing the external atoms that need to be evaluated
+									std::vector<ID> evat;
+									evat.push_back(factory.innerEatoms[eaIndex]);
 
-								// prepare a vector for storing the external atoms that need to be evaluated
-								std::vector<ID> evat;
-								evat.push_back(factory.innerEatoms[eaIndex]);
+									// proceed with the actual evaluation
+									evaluateExternalAtoms(factory.ctx, evat, postcheckInput, cb);
 
-								// proceed with the actual evaluation
-								evaluateExternalAtoms(factory.ctx, evat, postcheckInput, cb);
+									// the cache is dropped as a whole when it becomes too large
+									boost::mutex::scoped_lock lock(postCheckMutex);
+									if (postCheckCache.size() >= MaxPostCheckCacheSize) postCheckCache.clear();
+									postCheckCache[key] = InterpretationPtr(new Interpretation(*postcheckOutput));
+								}
 
 								// eliminate from the output interpretation irrelevant atoms
 								bm::bvector<>::enumerator enout = postcheckOutput->getStorage().first();
@@ -3107,6 +3491,7 @@ namespace dllite {
 
 								if (evalsucc==false) {
 									DBGLOG(DBG,"RMG: PC: evaluation showed that the model is not a repair answer set");
+									if (idforcheck != ID_FAIL) learnPostCheckNogood(getEvaluationNogood(modelCandidate, eatom, idforcheck));
 									return false;
 								}
 
@@ -3134,7 +3519,18 @@ namespace dllite {
 								inputfact.tuple.push_back(reg->ogatoms.getByID(id).tuple[7]);
 								inputfact.tuple.push_back(reg->ogatoms.getByID(id).tuple[8]);
 
-								if ((std::find(newab.begin(), newab.end(), reg->ogatoms.getIDByStorage(abfact)) != newab.end())||(modelCandidate->getFact(reg->ogatoms.getIDByStorage(inputfact))))
+								ID abfactID = reg->ogatoms.getIDByStorage(abfact);
+								ID inputfactID = reg->ogatoms.getIDByStorage(inputfact);
+
+								// removal atom of the assertion (if it is in the Abox)
+								ID barID = ID_FAIL;
+								if (abfactID != ID_FAIL && ab->getFact(abfactID.address)) {
+									OrdinaryAtom bar = abfact;
+									bar.tuple[0] = reg->getAuxiliaryConstantSymbol('o', ID(0, 1));
+									barID = reg->ogatoms.getIDByStorage(bar);
+								}
+
+								if ((abfactID != ID_FAIL && newabox->getFact(abfactID.address))||(modelCandidate->getFact(inputfactID)))
 								{
 
 									OrdinaryAtom repl(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG | ID::PROPERTY_AUX);
@@ -3150,6 +3546,19 @@ namespace dllite {
 
 									if (!modelCandidate->getFact(reg->ogatoms.getIDByStorage(repl))) {
 										DBGLOG(DBG,"RMG: PC: evaluation showed that the model is not a repair answer set");
+
+										// the pair is in the role by the kept assertion resp. by the input, but the replacement atom is false
+										ID replID = reg->ogatoms.getIDByStorage(repl);
+										if (replID != ID_FAIL) {
+											Nogood ng;
+											ng.insert(NogoodContainer::createLiteral(replID.address, false));
+											if (abfactID != ID_FAIL && newabox->getFact(abfactID.address)) {
+												if (barID != ID_FAIL) ng.insert(NogoodContainer::createLiteral(barID.address, false));
+											} else {
+												ng.insert(NogoodContainer::createLiteral(inputfactID.address, true));
+											}
+											learnPostCheckNogood(ng);
+										}
 										return false;
 									}
 								}
@@ -3169,6 +3578,16 @@ namespace dllite {
 
 									if (!modelCandidate->getFact(reg->ogatoms.getIDByStorage(repl))) {
 										DBGLOG(DBG,"RMG: PC: evaluation showed that the model is not a repair answer set");
+
+										// the pair is neither in the repaired Abox nor in the input, but the negative replacement atom is false
+										ID replID = reg->ogatoms.getIDByStorage(repl);
+										if (replID != ID_FAIL) {
+											Nogood ng;
+											ng.insert(NogoodContainer::createLiteral(replID.address, false));
+											if (barID != ID_FAIL) ng.insert(NogoodContainer::createLiteral(barID.address, true));
+											if (inputfactID != ID_FAIL) ng.insert(NogoodContainer::createLiteral(inputfactID.address, false));
+											learnPostCheckNogood(ng);
+										}
 										return false;
 									}
 
@@ -3214,8 +3633,8 @@ namespace dllite {
 				ID cQID = ID_FAIL;
 				ID rQID = ID_FAIL;
 
-				ID cdlID = reg->storeConstantTerm("cDL");
-				ID rdlID = reg->storeConstantTerm("rDL");
+				ID cdlID = storePostCheckTerm("cDL");
+				ID rdlID = storePostCheckTerm("rDL");
 
 				if (eatom.predicate==cdlID) {
 					// query is a concept
@@ -3232,7 +3651,7 @@ namespace dllite {
 				// create an atom that specifies that the new ontology should be used for the external atom
 				OrdinaryAtom usenewab(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
 				usenewab.tuple.push_back(eatom.inputs[1]);
-				ID usenewabID = reg->storeOrdinaryAtom(usenewab);
+				ID usenewabID = storePostCheckAtom(usenewab);
 
 				// add the fact to the input interpretation that specifies the usage of the new ABox for the given external atom
 				DBGLOG(DBG,"RMG: FLP: atom that specifies that the new ABox is used: "<<RawPrinter::toString(reg,usenewabID));
@@ -3263,7 +3682,7 @@ namespace dllite {
 						abfact.tuple.push_back(addat.tuple[1]);
 						abfact.tuple.push_back(addat.tuple[2]);
 
-						ID abfactID = reg->storeOrdinaryAtom(abfact);
+						ID abfactID = storePostCheckAtom(abfact);
 						DBGLOG(DBG,"RMG: FLP: created atom is: "<<RawPrinter::toString(reg,abfactID));
 
 						flpCheckInput->setFact(abfactID.address);
@@ -3278,7 +3697,7 @@ namespace dllite {
 						abfact.tuple.push_back(addat.tuple[2]);
 						abfact.tuple.push_back(addat.tuple[3]);
 
-						ID abfactID = reg->storeOrdinaryAtom(abfact);
+						ID abfactID = storePostCheckAtom(abfact);
 						DBGLOG(DBG,"RMG: FLP: created atom is: "<<RawPrinter::toString(reg,abfactID));
 						flpCheckInput->setFact(abfactID.address);
 						DBGLOG(DBG,"RMG: FLP: added fact to interpretation");
@@ -3297,6 +3716,7 @@ namespace dllite {
 			// FLP check based on unfounded sets
 			if (factory.ctx.config.getOption("UFSCheck")) {
 				DBGLOG(DBG, "RMG: UFS Check");
+				boost::mutex::scoped_lock lock(postCheckMutex);
 				std::vector<IDAddress> ufs = ufscm->getUnfoundedSet(modelCandidate, std::set<ID>(), factory.ctx.config.getOption("ExternalLearning") ? learnedEANogoods : SimpleNogoodContainerPtr());
 
 				if (ufs.size() > 0) {
@@ -3304,7 +3724,13 @@ namespace dllite {
 					if (factory.ctx.config.getOption("UFSLearning")) {
 						DBGLOG(DBG, "Learn from UFS");
 						Nogood ufsng = ufscm->getLastUFSNogood();
-						solver->addNogood(ufsng);
+						if (!!pipeline) {
+							// the solver is busy with the next candidate, the solver thread adds the nogood later
+							boost::mutex::scoped_lock plock(pipeline->mutex);
+							pipeline->nogoods.push_back(ufsng);
+						} else {
+							solver->addNogood(ufsng);
+						}
 					}
 					return false;
 				} else {
@@ -3818,8 +4244,97 @@ namespace dllite {
 		return grounder->getGroundProgram();
 	}
 
+	void RepairModelGenerator::computeAboxConflicts() {
+
+		DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid, "RMG: Abox conflicts");
+		DLLitePlugin::CachedOntologyPtr ontology = theDLLitePlugin.prepareOntology(factory.ctx, reg->storeConstantTerm(factory.ctx.getPluginData<DLLitePlugin>().repairOntology));
+		NativeReasonerPtr reasoner = ontology->getNativeReasoner(factory.ctx);
+
+		// removal atoms (bar_aux_o) of the ground program by their Abox assertions
+		InterpretationConstPtr programAtoms = annotatedGroundProgram.getProgramMask();
+		for (IDAddress bar = 0; bar < factory.guardOfBar.size(); ++bar) {
+			if (factory.guardOfBar[bar] != ALL_ONES && programAtoms->getFact(bar)) barOfGuard[factory.guardOfBar[bar]] = bar;
+		}
+
+		// the Abox assertions (aux_o facts), each as a separate update
+		std::vector<IDAddress> guards;
+		std::vector<NativeReasoner::Update> assertions;
+		bm::bvector<> abox = postprocessedInput->getStorage() & factory.guardMask.mask()->getStorage();
+		bm::bvector<>::enumerator en = abox.first();
+		bm::bvector<>::enumerator en_end = abox.end();
+		while (en < en_end) {
+			const OrdinaryAtom& guard = reg->ogatoms.getByAddress(*en);
+			guards.push_back(*en);
+			assertions.push_back(NativeReasoner::Update());
+			if (guard.tuple.size() == 3) assertions.back().addConceptAssertion(guard.tuple[1], guard.tuple[2]);
+			else assertions.back().addRoleAssertion(guard.tuple[1], guard.tuple[2], guard.tuple[3]);
+			en++;
+		}
+
+		std::vector<std::pair<unsigned, unsigned> > conflicts;
+		reasoner->getConflicts(assertions, conflicts);
+		DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidaboxconflicts, "RMG: Abox conflicts", conflicts.size());
+
+		typedef std::pair<unsigned, unsigned> Conflict;
+		BOOST_FOREACH (const Conflict& c, conflicts) {
+			aboxConflicts.push_back(GuardPair(guards[c.first], guards[c.second]));
+			if (!factory.ctx.getPluginData<DLLitePlugin>().aboxconflicts) continue;
+
+			boost::unordered_map<IDAddress, IDAddress>::const_iterator bar1 = barOfGuard.find(guards[c.first]);
+			boost::unordered_map<IDAddress, IDAddress>::const_iterator bar2 = barOfGuard.find(guards[c.second]);
+			bool removable1 = (bar1 != barOfGuard.end());
+			bool removable2 = (bar2 != barOfGuard.end());
+			if (c.first != c.second && removable1 && removable2) {
+				conflictingBars[bar1->second].push_back(bar2->second);
+				conflictingBars[bar2->second].push_back(bar1->second);
+			} else if (removable1 != removable2 || (c.first == c.second && removable1)) {
+				// the other assertion cannot be removed (or there is none), thus this one must be removed
+				Nogood ng;
+				ng.insert(NogoodContainer::createLiteral(removable1 ? bar1->second : bar2->second, false));
+				DBGLOG(DBG, "RMG: Abox assertion " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(removable1 ? guards[c.first] : guards[c.second])) << " must be removed");
+				solver->addNogood(ng);
+			} else {
+				DBGLOG(WARNING, "RMG: conflict between Abox assertions " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(guards[c.first])) << " and " << RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(guards[c.second])) << ", which cannot be removed");
+			}
+		}
+		DBGLOG(DBG, "RMG: " << conflictingBars.size() << " removal atoms are involved in Abox conflicts");
+	}
+
 	void RepairModelGenerator::propagate(InterpretationConstPtr partialInterpretation, InterpretationConstPtr factWasSet, InterpretationConstPtr changed) {
 
+		if (conflictingBars.empty()) return;
+		DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid, "RMG: Abox conflict propagation");
+
+		// an assertion is kept if its removal atom is assigned false (without factWasSet the assignment is complete);
+		// a clash can only be completed by atoms which were assigned since the last call
+		std::vector<IDAddress> assigned;
+		if (!!changed) {
+			bm::bvector<>::enumerator en = changed->getStorage().first();
+			bm::bvector<>::enumerator en_end = changed->getStorage().end();
+			while (en < en_end) {
+				if (conflictingBars.count(*en) > 0) assigned.push_back(*en);
+				en++;
+			}
+		} else {
+			typedef std::pair<IDAddress, std::vector<IDAddress> > BarPair;
+			BOOST_FOREACH (const BarPair& bp, conflictingBars) assigned.push_back(bp.first);
+		}
+
+		BOOST_FOREACH (IDAddress bar1, assigned) {
+			if ((!!factWasSet && !factWasSet->getFact(bar1)) || partialInterpretation->getFact(bar1)) continue;
+			BOOST_FOREACH (IDAddress bar2, conflictingBars[bar1]) {
+				if ((!!factWasSet && !factWasSet->getFact(bar2)) || partialInterpretation->getFact(bar2)) continue;
+
+				// both assertions are kept: at least one of them must be removed
+				if (!propagatedConflicts.insert(std::make_pair(std::min(bar1, bar2), std::max(bar1, bar2))).second) continue;
+				Nogood ng;
+				ng.insert(NogoodContainer::createLiteral(bar1, false));
+				ng.insert(NogoodContainer::createLiteral(bar2, false));
+				DBGLOG(DBG, "RMG: propagating Abox conflict " << ng.getStringRepresentation(reg));
+				DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidpropagatedconflicts, "RMG: propagated Abox conflicts", 1);
+				solver->addNogood(ng);
+			}
+		}
 	}
 
 }
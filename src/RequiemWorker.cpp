@@ -0,0 +1,200 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file RequiemWorker.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Persistent Requiem processes for query rewriting in EL mode.
+ *
+ * Each worker runs "java -jar requiem-cli.jar --server ontology" and exchanges
+ * one query per line on stdin for the rewritings on stdout, which are terminated
+ * by an empty line.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "RequiemWorker.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/PluginInterface.h"
+
+#include <set>
+#include <utility>
+#include "boost/foreach.hpp"
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+
+	// ============================== Class RequiemWorker ==============================
+
+	RequiemWorker::RequiemWorker(const std::string& jarPath, const std::string& ontologyPath) : pid(-1), toWorker(0), fromWorker(0) {
+
+#ifdef WIN32
+		throw PluginError("Requiem is not supported under Windows");
+#else
+		DBGLOG(DBG, "Starting Requiem worker for ontology " << ontologyPath);
+
+		int toChild[2], fromChild[2];
+		if (pipe(toChild) != 0) throw PluginError("Could not create pipe to Requiem");
+		if (pipe(fromChild) != 0) {
+			close(toChild[0]);
+			close(toChild[1]);
+			throw PluginError("Could not create pipe from Requiem");
+		}
+
+		// other workers must not inherit our ends of the pipes, otherwise they would keep this worker alive
+		fcntl(toChild[1], F_SETFD, FD_CLOEXEC);
+		fcntl(fromChild[0], F_SETFD, FD_CLOEXEC);
+
+		pid = fork();
+		if (pid == 0) {
+			// child: connect stdin and stdout to the pipes and start Requiem
+			dup2(toChild[0], STDIN_FILENO);
+			dup2(fromChild[1], STDOUT_FILENO);
+			close(toChild[0]);
+			close(toChild[1]);
+			close(fromChild[0]);
+			close(fromChild[1]);
+			execlp("java", "java", "-Xmx1000M", "-jar", jarPath.c_str(), "--server", ontologyPath.c_str(), (char*)0);
+			_exit(127);
+		}
+
+		close(toChild[0]);
+		close(fromChild[1]);
+		if (pid < 0) {
+			close(toChild[1]);
+			close(fromChild[0]);
+			throw PluginError("Could not start Requiem");
+		}
+		toWorker = fdopen(toChild[1], "w");
+		fromWorker = fdopen(fromChild[0], "r");
+#endif
+	}
+
+	RequiemWorker::~RequiemWorker() {
+
+#ifndef WIN32
+		// closing stdin makes the worker terminate
+		if (toWorker) fclose(toWorker);
+		if (fromWorker) fclose(fromWorker);
+		if (pid > 0) waitpid(pid, 0, 0);
+#endif
+	}
+
+	void RequiemWorker::send(const std::string& query) {
+
+		DBGLOG(DBG, "Sending query to Requiem worker: " << query);
+		if (fputs(query.c_str(), toWorker) == EOF || fputc('\n', toWorker) == EOF || fflush(toWorker) != 0) {
+			throw PluginError("Could not send query to Requiem");
+		}
+	}
+
+	void RequiemWorker::receive(std::vector<std::string>& rewritings) {
+
+		char buff[512];
+		std::string line;
+		while (fgets(buff, sizeof(buff), fromWorker) != NULL) {
+			line += buff;
+
+			// lines might be longer than the buffer
+			if (line[line.length() - 1] != '\n') continue;
+
+			line.erase(line.length() - 1);
+			if (line == "") return;	// end of the rewritings
+			rewritings.push_back(line);
+			line = "";
+		}
+		throw PluginError("Requiem worker terminated unexpectedly");
+	}
+
+	// ============================== Class RequiemWorkerPool ==============================
+
+	RequiemWorkerPool::RequiemWorkerPool(const std::string& jarPath, const std::string& ontologyPath, unsigned maxWorkers) : jarPath(jarPath), ontologyPath(ontologyPath), maxWorkers(maxWorkers > 0 ? maxWorkers : 1) {
+	}
+
+	void RequiemWorkerPool::prefetch(const std::vector<std::string>& queries) {
+
+		// collect the queries which were not rewritten yet
+		std::vector<std::string> pending;
+		std::set<std::string> seen;
+		BOOST_FOREACH (std::string query, queries) {
+			if (rewritings.find(query) == rewritings.end() && seen.insert(query).second) pending.push_back(query);
+		}
+		if (pending.size() == 0) return;
+
+		// start workers as needed (they load the ontology in parallel)
+		while (workers.size() < maxWorkers && workers.size() < pending.size()) {
+			workers.push_back(RequiemWorkerPtr(new RequiemWorker(jarPath, ontologyPath)));
+		}
+		DBGLOG(DBG, "Rewriting " << pending.size() << " queries using " << workers.size() << " Requiem workers");
+
+		// in each round every worker gets one query, then the results are collected
+		unsigned next = 0;
+		while (next < pending.size()) {
+			std::vector<std::pair<RequiemWorkerPtr, std::string> > busy;
+			BOOST_FOREACH (RequiemWorkerPtr worker, workers) {
+				if (next >= pending.size()) break;
+				worker->send(pending[next]);
+				busy.push_back(std::pair<RequiemWorkerPtr, std::string>(worker, pending[next]));
+				next++;
+			}
+			for (unsigned i = 0; i < busy.size(); ++i) {
+				std::vector<std::string>& result = rewritings[busy[i].second];
+				busy[i].first->receive(result);
+				DBGLOG(DBG, "Got " << result.size() << " rewritings for query " << busy[i].second);
+			}
+		}
+	}
+
+	const std::vector<std::string>& RequiemWorkerPool::getRewritings(const std::string& query) {
+
+		if (rewritings.find(query) == rewritings.end()) {
+			std::vector<std::string> queries;
+			queries.push_back(query);
+			prefetch(queries);
+		}
+		return rewritings[query];
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
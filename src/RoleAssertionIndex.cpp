@@ -0,0 +1,143 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file RoleAssertionIndex.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Hashed index of the role assertions of an Abox.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "RoleAssertionIndex.h"
+
+#include "boost/foreach.hpp"
+#include <algorithm>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+
+	RoleAssertionIndex::RoleAssertionIndex() : assertionCount(0), sorted(true) {
+	}
+
+	void RoleAssertionIndex::add(ID role, ID subject, ID object) {
+		assert(role.isConstantTerm() && subject.isConstantTerm() && object.isConstantTerm() && "role assertions must consist of constants");
+		roles[role.address][subject.address].push_back(object.address);
+		roleObjects[role.address].set_bit(object.address);
+		assertionCount++;
+		sorted = false;
+	}
+
+	void RoleAssertionIndex::finalize() {
+
+		if (sorted) return;
+		assertionCount = 0;
+		for (boost::unordered_map<IDAddress, Adjacency>::iterator rit = roles.begin(); rit != roles.end(); ++rit) {
+			for (Adjacency::iterator sit = rit->second.begin(); sit != rit->second.end(); ++sit) {
+				Objects& objects = sit->second;
+				std::sort(objects.begin(), objects.end());
+				objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+				assertionCount += objects.size();
+			}
+		}
+		sorted = true;
+	}
+
+	void RoleAssertionIndex::clear() {
+		roles.clear();
+		roleObjects.clear();
+		assertionCount = 0;
+		sorted = true;
+	}
+
+	const std::vector<IDAddress>* RoleAssertionIndex::getObjects(ID role, ID subject) const {
+
+		if (!role.isConstantTerm() || !subject.isConstantTerm()) return NULL;
+		boost::unordered_map<IDAddress, Adjacency>::const_iterator rit = roles.find(role.address);
+		if (rit == roles.end()) return NULL;
+		Adjacency::const_iterator sit = rit->second.find(subject.address);
+		if (sit == rit->second.end()) return NULL;
+		return &sit->second;
+	}
+
+	bool RoleAssertionIndex::hasFiller(ID role, IDAddress individual, bool swapped) const {
+
+		if (swapped) {
+			boost::unordered_map<IDAddress, bm::bvector<> >::const_iterator oit = roleObjects.find(role.address);
+			return oit != roleObjects.end() && oit->second.get_bit(individual);
+		}
+		boost::unordered_map<IDAddress, Adjacency>::const_iterator rit = roles.find(role.address);
+		return rit != roles.end() && rit->second.find(individual) != rit->second.end();
+	}
+
+	void RoleAssertionIndex::getPairs(ID role, bool swapped, std::vector<std::pair<IDAddress, IDAddress> >& pairs) const {
+
+		boost::unordered_map<IDAddress, Adjacency>::const_iterator rit = roles.find(role.address);
+		if (rit == roles.end()) return;
+		for (Adjacency::const_iterator sit = rit->second.begin(); sit != rit->second.end(); ++sit) {
+			BOOST_FOREACH (IDAddress object, sit->second) {
+				if (swapped) pairs.push_back(std::make_pair(object, sit->first));
+				else pairs.push_back(std::make_pair(sit->first, object));
+			}
+		}
+	}
+
+	void RoleAssertionIndex::getSubjects(ID role, bool swapped, bm::bvector<>& subjects) const {
+
+		if (swapped) {
+			boost::unordered_map<IDAddress, bm::bvector<> >::const_iterator oit = roleObjects.find(role.address);
+			if (oit != roleObjects.end()) subjects |= oit->second;
+			return;
+		}
+		boost::unordered_map<IDAddress, Adjacency>::const_iterator rit = roles.find(role.address);
+		if (rit == roles.end()) return;
+		for (Adjacency::const_iterator sit = rit->second.begin(); sit != rit->second.end(); ++sit) {
+			subjects.set_bit(sit->first);
+		}
+	}
+
+	bool RoleAssertionIndex::contains(ID role, ID subject, ID object) const {
+
+		if (!object.isConstantTerm()) return false;
+		const Objects* objects = getObjects(role, subject);
+		if (objects == NULL) return false;
+		if (sorted) return std::binary_search(objects->begin(), objects->end(), object.address);
+		return std::find(objects->begin(), objects->end(), object.address) != objects->end();
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
@@ -0,0 +1,321 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005, 2006, 2007 Roman Schindlauer
+ * Copyright (C) 2006, 2007, 2008, 2009, 2010, 2011 Thomas Krennwallner
+ * Copyright (C) 2009, 2010, 2011 Peter Schüller
+ * Copyright (C) 2011, 2012, 2013, 2014 Christoph Redl
+ * Copyright (C) 2014 Daria Stepanova
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+
+/**
+ * @file SupportSetCache.cpp
+ * @author Daria Stepanova <dasha@kr.tuwien.ac.at>
+ * @author Christoph Redl <redl@kr.tuwien.ac.at>
+ *
+ * @brief Persistent cache of the support families learned for DL-atoms.
+ *
+ * The cache file of an ontology is a text file which starts with a header line,
+ * followed by one record per support family:
+ *   family <key> <incomplete> <number of support sets>
+ *   <number of literals> <literal> ... (one line per support set)
+ * where a literal is <type> <naf> <sign> <kind> <arity> <term> ...
+ * Strings are written as <length>:<characters>, such that they may contain blanks.
+ * Records are only appended, thus several runs can share a cache file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+#include "SupportSetCache.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Printer.h"
+#include "dlvhex2/ExternalLearningHelper.h"
+
+#include <set>
+#include <fstream>
+#include <sstream>
+
+#include "boost/foreach.hpp"
+#include "boost/filesystem.hpp"
+#include <boost/lexical_cast.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace dllite {
+
+	namespace {
+
+		const std::string cacheHeader = "dlliteplugin-supportsets 1";
+
+		struct Malformed {};
+
+		void writeString(std::ostream& out, const std::string& str) {
+			out << str.length() << ":" << str;
+		}
+
+		std::string readString(std::istream& in) {
+			std::size_t len;
+			char colon;
+			if (!(in >> len) || !in.get(colon) || colon != ':') throw Malformed();
+			std::string str(len, ' ');
+			if (len > 0 && !in.read(&str[0], len)) throw Malformed();
+			return str;
+		}
+
+		unsigned readUInt(std::istream& in) {
+			unsigned value;
+			if (!(in >> value)) throw Malformed();
+			return value;
+		}
+
+		// checks if an atom is the replacement atom of the DL-atom with the given output and sign
+		bool isOutputAtom(const PluginAtom::Query& query, ID atomID, const Tuple& output, bool sign) {
+			ID outID = ExternalLearningHelper::getOutputAtom(query, output, sign);
+			return outID.address == atomID.address && outID.isOrdinaryGroundAtom() == atomID.isOrdinaryGroundAtom();
+		}
+	}
+
+	SupportSetCache::SupportSetCache(RegistryPtr reg, const std::string& filename, ID guardPredicateID) : reg(reg), filename(filename), guardPredicateID(guardPredicateID) {
+		read();
+	}
+
+	std::string SupportSetCache::getKey(RegistryPtr reg, const PluginAtom::Query& query, const std::string& options) {
+
+		const ExternalAtom& eatom = reg->eatoms.getByID(query.eatomID);
+
+		std::stringstream key;
+		key << RawPrinter::toString(reg, eatom.predicate) << "[" << RawPrinter::toString(reg, query.input[5]) << "]";
+		for (unsigned i = 1; i <= 4; ++i) key << " " << RawPrinter::toString(reg, query.input[i]);
+		key << " " << options;
+
+		// the support sets depend on the input atoms only via their input predicate and the concept resp. role
+		std::set<std::string> signature;
+		bm::bvector<>::enumerator en = eatom.getPredicateInputMask()->getStorage().first();
+		bm::bvector<>::enumerator en_end = eatom.getPredicateInputMask()->getStorage().end();
+		while (en < en_end) {
+			const OrdinaryAtom& oatom = reg->ogatoms.getByAddress(*en);
+			for (unsigned i = 1; i <= 4; ++i) {
+				if (oatom.tuple[0] == query.input[i] && oatom.tuple.size() > 1) signature.insert(boost::lexical_cast<std::string>(i) + ":" + RawPrinter::toString(reg, oatom.tuple[1]));
+			}
+			en++;
+		}
+		BOOST_FOREACH (const std::string& s, signature) key << " " << s;
+		return key.str();
+	}
+
+	std::string SupportSetCache::encodeTerm(ID term) const {
+		if (term.isIntegerTerm()) return "i" + boost::lexical_cast<std::string>(term.address);
+		if (term.isVariableTerm()) return "v" + reg->terms.getByID(term).symbol;
+		return "c" + reg->terms.getByID(term).symbol;
+	}
+
+	ID SupportSetCache::decodeTerm(const std::string& term) const {
+		if (term.empty()) throw Malformed();
+		switch (term[0]) {
+		case 'i':
+			return ID::termFromInteger(boost::lexical_cast<unsigned>(term.substr(1)));
+		case 'v':
+			return reg->storeVariableTerm(term.substr(1));
+		case 'c':
+			return reg->storeConstantTerm(term.substr(1));
+		default:
+			throw Malformed();
+		}
+	}
+
+	void SupportSetCache::read() {
+
+		std::ifstream file(filename.c_str());
+		if (!file) return;
+
+		std::string header;
+		if (!std::getline(file, header) || header != cacheHeader) {
+			DBGLOG(DBG, "Support set cache " << filename << " has an unknown format, ignoring it");
+			return;
+		}
+
+		try {
+			std::string tag;
+			while (file >> tag) {
+				if (tag != "family") throw Malformed();
+				std::string key = readString(file);
+				Family family;
+				family.incomplete = (readUInt(file) != 0);
+				unsigned setCount = readUInt(file);
+				for (unsigned s = 0; s < setCount; ++s) {
+					SupportSet supportSet;
+					unsigned literalCount = readUInt(file);
+					for (unsigned l = 0; l < literalCount; ++l) {
+						Literal lit;
+						unsigned type = readUInt(file);
+						if (type > Literal::ordinary) throw Malformed();
+						lit.type = (Literal::Type)type;
+						lit.naf = (readUInt(file) != 0);
+						lit.sign = (readUInt(file) != 0);
+						lit.kind = readUInt(file);
+						unsigned arity = readUInt(file);
+						for (unsigned t = 0; t < arity; ++t) lit.terms.push_back(readString(file));
+						supportSet.push_back(lit);
+					}
+					family.supportSets.push_back(supportSet);
+				}
+				families[key] = family;
+			}
+		} catch (const Malformed&) {
+			DBGLOG(DBG, "Support set cache " << filename << " ends with an incomplete record, ignoring it");
+		}
+		DBGLOG(DBG, "Read " << families.size() << " support families from " << filename);
+	}
+
+	void SupportSetCache::append(const std::string& key, const Family& family) const {
+
+		try {
+			boost::filesystem::path dir = boost::filesystem::path(filename).parent_path();
+			if (!dir.empty()) boost::filesystem::create_directories(dir);
+		} catch (const boost::filesystem::filesystem_error& e) {
+			LOG(WARNING, "Could not create cache directory for support sets: " << e.what());
+			return;
+		}
+
+		// write the record to a buffer first, such that it is appended at once
+		std::stringstream record;
+		record << "family ";
+		writeString(record, key);
+		record << " " << (family.incomplete ? 1 : 0) << " " << family.supportSets.size() << std::endl;
+		BOOST_FOREACH (const SupportSet& supportSet, family.supportSets) {
+			record << supportSet.size();
+			BOOST_FOREACH (const Literal& lit, supportSet) {
+				record << " " << lit.type << " " << (lit.naf ? 1 : 0) << " " << (lit.sign ? 1 : 0) << " " << lit.kind << " " << lit.terms.size();
+				BOOST_FOREACH (const std::string& term, lit.terms) {
+					record << " ";
+					writeString(record, term);
+				}
+			}
+			record << std::endl;
+		}
+
+		bool newFile = !boost::filesystem::exists(filename);
+		std::ofstream file(filename.c_str(), std::ios::out | std::ios::app);
+		if (!file) {
+			LOG(WARNING, "Could not write support set cache " << filename);
+			return;
+		}
+		if (newFile) file << cacheHeader << std::endl;
+		file << record.str();
+	}
+
+	bool SupportSetCache::lookup(const std::string& key, const PluginAtom::Query& query, SimpleNogoodContainerPtr supportSets, bool& incomplete) const {
+
+		std::map<std::string, Family>::const_iterator it = families.find(key);
+		if (it == families.end()) return false;
+		DBGLOG(DBG, "Restoring " << it->second.supportSets.size() << " support sets from cache for " << key);
+
+		try {
+			std::vector<Nogood> restored;
+			BOOST_FOREACH (const SupportSet& supportSet, it->second.supportSets) {
+				Nogood ng;
+				BOOST_FOREACH (const Literal& lit, supportSet) {
+					Tuple terms;
+					BOOST_FOREACH (const std::string& term, lit.terms) terms.push_back(decodeTerm(term));
+
+					ID atomID;
+					if (lit.type == Literal::output) {
+						atomID = ExternalLearningHelper::getOutputAtom(query, terms, lit.sign);
+					} else {
+						OrdinaryAtom oatom(lit.kind);
+						if (lit.type == Literal::guard) oatom.tuple.push_back(guardPredicateID);
+						oatom.tuple.insert(oatom.tuple.end(), terms.begin(), terms.end());
+						atomID = reg->storeOrdinaryAtom(oatom);
+					}
+					ng.insert(NogoodContainer::createLiteral(atomID.address, !lit.naf, atomID.isOrdinaryGroundAtom()));
+				}
+				restored.push_back(ng);
+			}
+			BOOST_FOREACH (const Nogood& ng, restored) supportSets->addNogood(ng);
+		} catch (const Malformed&) {
+			return false;
+		} catch (const boost::bad_lexical_cast&) {
+			return false;
+		}
+		incomplete = it->second.incomplete;
+		return true;
+	}
+
+	void SupportSetCache::store(const std::string& key, const PluginAtom::Query& query, SimpleNogoodContainerPtr supportSets, bool incomplete) {
+
+		const ExternalAtom& eatom = reg->eatoms.getByID(query.eatomID);
+
+		Family family;
+		family.incomplete = incomplete;
+		for (int i = 0; i < supportSets->getNogoodCount(); ++i) {
+			SupportSet supportSet;
+			BOOST_FOREACH (ID id, supportSets->getNogood(i)) {
+				const OrdinaryAtom& oatom = reg->lookupOrdinaryAtom(id);
+				ID atomID = (id.isOrdinaryGroundAtom() ? reg->ogatoms.getIDByAddress(id.address) : reg->onatoms.getIDByAddress(id.address));
+
+				Literal lit;
+				lit.naf = id.isNaf();
+				lit.sign = false;
+				lit.kind = oatom.kind;
+				if (oatom.tuple[0] == guardPredicateID) {
+					lit.type = Literal::guard;
+					for (unsigned t = 1; t < oatom.tuple.size(); ++t) lit.terms.push_back(encodeTerm(oatom.tuple[t]));
+				} else if (oatom.tuple[0].isAuxiliary()) {
+					// must be the replacement atom of this DL-atom; it is restored from its output terms
+					if (oatom.tuple.size() < eatom.tuple.size() + 1) return;
+					Tuple output(oatom.tuple.end() - eatom.tuple.size(), oatom.tuple.end());
+					lit.type = Literal::output;
+					if (isOutputAtom(query, atomID, output, false)) lit.sign = false;
+					else if (isOutputAtom(query, atomID, output, true)) lit.sign = true;
+					else {
+						DBGLOG(DBG, "Support family of " << key << " contains an auxiliary atom which cannot be cached");
+						return;
+					}
+					BOOST_FOREACH (ID term, output) lit.terms.push_back(encodeTerm(term));
+				} else {
+					lit.type = Literal::ordinary;
+					BOOST_FOREACH (ID term, oatom.tuple) {
+						if (term.isAuxiliary()) {
+							DBGLOG(DBG, "Support family of " << key << " contains an auxiliary term which cannot be cached");
+							return;
+						}
+						lit.terms.push_back(encodeTerm(term));
+					}
+				}
+				supportSet.push_back(lit);
+			}
+			family.supportSets.push_back(supportSet);
+		}
+
+		families[key] = family;
+		append(key, family);
+		DBGLOG(DBG, "Stored " << family.supportSets.size() << " support sets in cache for " << key);
+	}
+
+}
+
+DLVHEX_NAMESPACE_END
+
+/* vim: set noet sw=2 ts=2 tw=80: */
+
+// Local Variables:
+// mode: C++
+// End:
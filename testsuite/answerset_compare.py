@@ -1 +0,0 @@
-../dlvhex-common/testsuite/answerset_compare.py
\ No newline at end of file
@@ -0,0 +1,53 @@
+#!/usr/bin/env python
+#
+# compares two files of answer sets (one per line, as printed by dlvhex) regardless of the order of the answer sets
+# and of the atoms within them; exits with 0 iff they are equal
+#
+
+import sys
+
+def atoms(line):
+	# splits {a,p("x,y",b),c} at the commas outside of quotes and parentheses
+	body = line.strip()[1:-1]
+	result = []
+	depth = 0
+	quoted = False
+	current = ''
+	for c in body:
+		if c == '"':
+			quoted = not quoted
+		elif not quoted and c == '(':
+			depth += 1
+		elif not quoted and c == ')':
+			depth -= 1
+		elif not quoted and depth == 0 and c == ',':
+			result.append(current.strip())
+			current = ''
+			continue
+		current += c
+	if current.strip() != '':
+		result.append(current.strip())
+	return frozenset(result)
+
+def answersets(filename):
+	result = []
+	for line in open(filename):
+		if line.strip().startswith('{'):
+			result.append(atoms(line))
+	return sorted(result, key=lambda s: sorted(s))
+
+if len(sys.argv) != 3:
+	sys.stderr.write('usage: answerset_compare.py ANSWERSETS EXPECTED\n')
+	sys.exit(2)
+
+found = answersets(sys.argv[1])
+expected = answersets(sys.argv[2])
+if found == expected:
+	sys.exit(0)
+for s in found:
+	if s not in expected:
+		sys.stdout.write('unexpected answer set: {' + ','.join(sorted(s)) + '}\n')
+for s in expected:
+	if s not in found:
+		sys.stdout.write('missing answer set: {' + ','.join(sorted(s)) + '}\n')
+sys.exit(1)
@@ -1 +0,0 @@
-../dlvhex-common/testsuite/run-dlvhex-tests.sh
\ No newline at end of file
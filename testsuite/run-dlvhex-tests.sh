@@ -0,0 +1,38 @@
+#!/bin/bash
+#
+# runs the tests listed in $TESTDIR, one per line:
+#   HEXPROGRAM ANSWERSETS [ADDITIONAL DLVHEX PARAMETERS]
+# where HEXPROGRAM and ANSWERSETS are relative to $EXAMPLESDIR, from which dlvhex is called
+# (such that the programs can refer to their ontologies by relative paths); lines starting with # are ignored
+#
+
+if [ -z "$DLVHEX" ] || [ -z "$EXAMPLESDIR" ] || [ -z "$TESTDIR" ]; then
+	echo "DLVHEX, EXAMPLESDIR and TESTDIR must be set" >&2
+	exit 1
+fi
+
+COMPARE="${PYTHON:-python} $(cd "$(dirname "$0")" && pwd)/answerset_compare.py"
+TMPFILE=$(mktemp "${TMPDIR:-/tmp}/dlvhex-tests.XXXXXX")
+trap 'rm -f "$TMPFILE"' EXIT
+
+ntests=0
+failed=0
+while read HEXPROGRAM ANSWERSETS ADDPARM; do
+	case "$HEXPROGRAM" in
+		""|\#*) continue ;;
+	esac
+	ntests=$((ntests + 1))
+
+	if ! (cd "$EXAMPLESDIR" && $DLVHEX $ADDPARM "$HEXPROGRAM") > "$TMPFILE"; then
+		echo "FAIL: $DLVHEX $ADDPARM $HEXPROGRAM (dlvhex failed)"
+		failed=$((failed + 1))
+	elif $COMPARE "$TMPFILE" "$EXAMPLESDIR/$ANSWERSETS"; then
+		echo "PASS: $HEXPROGRAM $ADDPARM"
+	else
+		echo "FAIL: $DLVHEX $ADDPARM $HEXPROGRAM (answer sets differ from $ANSWERSETS)"
+		failed=$((failed + 1))
+	fi
+done < "$TESTDIR"
+
+echo "========== $ntests tests, $failed failed =========="
+[ $failed -eq 0 ]